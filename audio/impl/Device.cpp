@@ -498,11 +498,14 @@ Return<void> Device::debug(const hidl_handle& fd, const hidl_vec<hidl_string>& o
         const int fd0 = fd->data[0];
         bool dumpMem = false;
         bool unreachableMemory = false;
+        bool glitches = false;
         for (const auto& option : options) {
             if (option == "-m") {
                 dumpMem = true;
             } else if (option == "--unreachable") {
                 unreachableMemory = true;
+            } else if (option == "--glitches") {
+                glitches = true;
             }
         }
 
@@ -517,8 +520,12 @@ Return<void> Device::debug(const hidl_handle& fd, const hidl_vec<hidl_string>& o
             std::string s = GetUnreachableMemoryString(true /* contents */, 100 /* limit */);
             write(fd0, s.c_str(), s.size());
         }
+        if (glitches) {
+            mGlitchJournal.dump(fd0);
+        }
 
         analyzeStatus("dump", mDevice->dump(mDevice, fd0));
+        dumpParamCache(fd0);
     }
     return Void();
 }
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "GlitchJournalHAL"
+
+#include "core/default/GlitchJournal.h"
+
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <android-base/stringprintf.h>
+
+namespace android {
+namespace hardware {
+namespace audio {
+namespace CPP_VERSION {
+namespace implementation {
+
+using ::android::base::StringAppendF;
+
+static uint64_t packInfo(const GlitchJournal::Event& event) {
+    return static_cast<uint64_t>(event.type) << 40 | static_cast<uint64_t>(event.isInput) << 32 |
+           static_cast<uint32_t>(event.streamId);
+}
+
+static void unpackInfo(uint64_t info, GlitchJournal::Event* event) {
+    event->type = static_cast<GlitchJournal::Type>(info >> 40);
+    event->isInput = (info >> 32) & 1;
+    event->streamId = static_cast<int32_t>(info & 0xffffffff);
+}
+
+GlitchJournal::GlitchJournal() : mNext(0), mSlots() {}
+
+void GlitchJournal::record(const Event& event) {
+    uint64_t index = mNext.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = mSlots[index % kSize];
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.info.store(packInfo(event), std::memory_order_relaxed);
+    slot.timeNs.store(event.timeNs, std::memory_order_relaxed);
+    slot.expectedNs.store(event.expectedNs, std::memory_order_relaxed);
+    slot.actualNs.store(event.actualNs, std::memory_order_relaxed);
+    slot.frames.store(event.frames, std::memory_order_relaxed);
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+void GlitchJournal::dump(int fd) const {
+    uint64_t next = mNext.load(std::memory_order_acquire);
+    std::string buf = ::android::base::StringPrintf("\nGlitches: %" PRIu64 " recorded\n", next);
+    for (uint64_t index = next > kSize ? next - kSize : 0; index < next; index++) {
+        const Slot& slot = mSlots[index % kSize];
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq != 2 * index + 2) {
+            continue;
+        }
+        Event event;
+        unpackInfo(slot.info.load(std::memory_order_relaxed), &event);
+        event.timeNs = slot.timeNs.load(std::memory_order_relaxed);
+        event.expectedNs = slot.expectedNs.load(std::memory_order_relaxed);
+        event.actualNs = slot.actualNs.load(std::memory_order_relaxed);
+        event.frames = slot.frames.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq) {
+            continue;
+        }
+        StringAppendF(&buf,
+                      "  %" PRId64 ".%06" PRId64 " %s%d %s: expected %" PRId64
+                      " us, took %" PRId64 " us, %u frames\n",
+                      event.timeNs / 1000000000, event.timeNs / 1000 % 1000000,
+                      event.isInput ? "In" : "Out", event.streamId,
+                      event.type == Type::GAP ? "gap" : "error", event.expectedNs / 1000,
+                      event.actualNs / 1000, event.frames);
+    }
+    write(fd, buf.c_str(), buf.size());
+}
+
+}  // namespace implementation
+}  // namespace CPP_VERSION
+}  // namespace audio
+}  // namespace hardware
+}  // namespace android
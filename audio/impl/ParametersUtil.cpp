@@ -17,8 +17,13 @@
 #include "core/default/ParametersUtil.h"
 #include "core/default/Util.h"
 
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+
 #include <system/audio.h>
 
+#include <android-base/stringprintf.h>
 #include <util/CoreUtils.h>
 
 namespace android {
@@ -27,6 +32,26 @@ namespace audio {
 namespace CORE_TYPES_CPP_VERSION {
 namespace implementation {
 
+using ::android::base::StringPrintf;
+
+// Keys that act on the HAL rather than set a value on it, or whose value
+// the HAL may change behind our back. These always go through.
+static const char* const kUncachedKeys[] = {
+        AudioParameter::keyRouting,       AudioParameter::keyInputSource,
+        AudioParameter::keyStreamConnect, AudioParameter::keyStreamDisconnect,
+        AudioParameter::keySamplingRate,  AudioParameter::keyFormat,
+        AudioParameter::keyChannels,      AudioParameter::keyStreamHwAvSync,
+        AudioParameter::keyReconfigA2dp,  "A2dpSuspended",
+        AUDIO_PARAMETER_KEY_HFP_ENABLE,
+};
+
+static bool isCachedKey(const String8& key) {
+    for (const char* uncached : kUncachedKeys) {
+        if (!strcmp(key.string(), uncached)) return false;
+    }
+    return true;
+}
+
 /** Converts a status_t in Result according to the rules of AudioParameter::get*
  * Note: Static method and not private method to avoid leaking status_t dependency
  */
@@ -148,7 +173,7 @@ Result ParametersUtil::setParametersImpl(const hidl_vec<ParameterValue>& context
     for (size_t i = 0; i < parameters.size(); ++i) {
         params.add(String8(parameters[i].key.c_str()), String8(parameters[i].value.c_str()));
     }
-    return setParams(params);
+    return context.size() == 0 ? setParams(params) : setParamsUncached(params);
 }
 
 Result ParametersUtil::setParam(const char* name, const DeviceAddress& address) {
@@ -159,12 +184,63 @@ Result ParametersUtil::setParam(const char* name, const DeviceAddress& address)
     }
     AudioParameter params{String8(halDeviceAddress)};
     params.addInt(String8(name), halDeviceType);
-    return setParams(params);
+    return setParamsUncached(params);
 }
 
 Result ParametersUtil::setParams(const AudioParameter& param) {
-    int halStatus = halSetParameters(param.toString().string());
-    return util::analyzeStatus(halStatus);
+    std::lock_guard<std::mutex> lock(mParamCacheLock);
+    AudioParameter changed;
+    String8 key, value;
+    for (size_t i = 0; i < param.size(); ++i) {
+        if (param.getAt(i, key, value) != OK) continue;
+        if (isCachedKey(key)) {
+            auto it = mParamCache.find(key.string());
+            if (it != mParamCache.end() && it->second == value.string()) {
+                ++mParamsElided;
+                continue;
+            }
+        }
+        changed.add(key, value);
+    }
+    if (changed.size() == 0) {
+        ++mParamSetsElided;
+        return Result::OK;
+    }
+
+    mParamsSent += changed.size();
+    Result retval = util::analyzeStatus(halSetParameters(changed.toString().string()));
+    // A failed set may have been applied in part, so forget its keys.
+    for (size_t i = 0; i < changed.size(); ++i) {
+        if (changed.getAt(i, key, value) != OK || !isCachedKey(key)) continue;
+        if (retval == Result::OK) {
+            mParamCache[key.string()] = value.string();
+        } else {
+            mParamCache.erase(key.string());
+        }
+    }
+    return retval;
+}
+
+Result ParametersUtil::setParamsUncached(const AudioParameter& param) {
+    std::lock_guard<std::mutex> lock(mParamCacheLock);
+    String8 key, value;
+    for (size_t i = 0; i < param.size(); ++i) {
+        if (param.getAt(i, key, value) == OK) mParamCache.erase(key.string());
+    }
+    mParamsSent += param.size();
+    return util::analyzeStatus(halSetParameters(param.toString().string()));
+}
+
+void ParametersUtil::dumpParamCache(int fd) {
+    std::lock_guard<std::mutex> lock(mParamCacheLock);
+    std::string dump = StringPrintf(
+            "Parameter cache: %zu keys, %" PRIu64 " sent, %" PRIu64 " elided, %" PRIu64
+            " sets skipped\n",
+            mParamCache.size(), mParamsSent, mParamsElided, mParamSetsElided);
+    for (const auto& entry : mParamCache) {
+        dump += StringPrintf("  %s=%s\n", entry.first.c_str(), entry.second.c_str());
+    }
+    write(fd, dump.c_str(), dump.size());
 }
 
 }  // namespace implementation
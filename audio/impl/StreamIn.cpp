@@ -51,7 +51,8 @@ class ReadThread : public Thread {
    public:
     // ReadThread's lifespan never exceeds StreamIn's lifespan.
     ReadThread(std::atomic<bool>* stop, audio_stream_in_t* stream, StreamIn::CommandMQ* commandMQ,
-               StreamIn::DataMQ* dataMQ, StreamIn::StatusMQ* statusMQ, EventFlag* efGroup)
+               StreamIn::DataMQ* dataMQ, StreamIn::StatusMQ* statusMQ, EventFlag* efGroup,
+               StreamStats* stats)
         : Thread(false /*canCallJava*/),
           mStop(stop),
           mStream(stream),
@@ -59,11 +60,7 @@ class ReadThread : public Thread {
           mDataMQ(dataMQ),
           mStatusMQ(statusMQ),
           mEfGroup(efGroup),
-          mBuffer(nullptr) {}
-    bool init() {
-        mBuffer.reset(new (std::nothrow) uint8_t[mDataMQ->getQuantumCount()]);
-        return mBuffer != nullptr;
-    }
+          mStats(stats) {}
     virtual ~ReadThread() {}
 
    private:
@@ -73,7 +70,7 @@ class ReadThread : public Thread {
     StreamIn::DataMQ* mDataMQ;
     StreamIn::StatusMQ* mStatusMQ;
     EventFlag* mEfGroup;
-    std::unique_ptr<uint8_t[]> mBuffer;
+    StreamStats* mStats;
     IStreamIn::ReadParameters mParameters;
     IStreamIn::ReadStatus mStatus;
 
@@ -83,7 +80,10 @@ class ReadThread : public Thread {
     void doRead();
 };
 
+// The HAL captures straight into the data MQ's memory. A read that wraps
+// around the end of the queue takes a second read.
 void ReadThread::doRead() {
+    mStats->onWake(StreamStats::nowNs());
     size_t availableToWrite = mDataMQ->availableToWrite();
     size_t requestedToRead = mParameters.params.read;
     if (requestedToRead > availableToWrite) {
@@ -93,16 +93,35 @@ void ReadThread::doRead() {
             (int32_t)requestedToRead, (int32_t)availableToWrite);
         requestedToRead = availableToWrite;
     }
-    ssize_t readResult = mStream->read(mStream, &mBuffer[0], requestedToRead);
     mStatus.retval = Result::OK;
-    if (readResult >= 0) {
-        mStatus.reply.read = readResult;
-        if (!mDataMQ->write(&mBuffer[0], readResult)) {
-            ALOGW("data message queue write failed");
+    mStatus.reply.read = 0;
+    StreamIn::DataMQ::MemTransaction tx;
+    if (!mDataMQ->beginWrite(requestedToRead, &tx)) {
+        ALOGW("data message queue write failed");
+        return;
+    }
+    for (const auto& region : {tx.getFirstRegion(), tx.getSecondRegion()}) {
+        if (region.getLength() == 0) {
+            break;
         }
-    } else {
-        mStatus.retval = Stream::analyzeStatus("read", readResult);
+        const int64_t startNs = StreamStats::nowNs();
+        ssize_t readResult = mStream->read(mStream, region.getAddress(), region.getLength());
+        mStats->onTransfer(startNs, StreamStats::nowNs(), region.getLength(), readResult);
+        if (readResult < 0) {
+            if (mStatus.reply.read == 0) {
+                mStatus.retval = Stream::analyzeStatus("read", readResult);
+            }
+            break;
+        }
+        mStatus.reply.read += readResult;
+        if (static_cast<size_t>(readResult) < region.getLength()) {
+            break;
+        }
+    }
+    if (!mDataMQ->commitWrite(mStatus.reply.read)) {
+        ALOGW("data message queue write failed");
     }
+    mStats->onResult(mStatus.retval, mStatus.reply.read);
 }
 
 void ReadThread::doGetCapturePosition() {
@@ -153,7 +172,8 @@ StreamIn::StreamIn(const sp<Device>& device, audio_stream_in_t* stream)
       mStreamCommon(new Stream(true /*isInput*/, &stream->common)),
       mStreamMmap(new StreamMmap<audio_stream_in_t>(stream)),
       mEfGroup(nullptr),
-      mStopReadThread(false) {}
+      mStopReadThread(false),
+      mStats(true /*isInput*/, device->glitchJournal()) {}
 
 StreamIn::~StreamIn() {
     ATRACE_CALL();
@@ -258,6 +278,7 @@ Return<Result> StreamIn::removeEffect(uint64_t effectId) {
 }
 
 Return<Result> StreamIn::standby() {
+    mStats.onIdle();
     return mStreamCommon->standby();
 }
 
@@ -420,12 +441,8 @@ Return<void> StreamIn::prepareForReading(uint32_t frameSize, uint32_t framesCoun
     // Create and launch the thread.
     auto tempReadThread =
             sp<ReadThread>::make(&mStopReadThread, mStream, tempCommandMQ.get(), tempDataMQ.get(),
-                                 tempStatusMQ.get(), tempElfGroup.get());
-    if (!tempReadThread->init()) {
-        ALOGW("failed to start reader thread: %s", strerror(-status));
-        sendError(Result::INVALID_ARGUMENTS);
-        return Void();
-    }
+                                 tempStatusMQ.get(), tempElfGroup.get(), &mStats);
+    mStats.setBuffer(frameSize, framesCount, mStream->common.get_sample_rate(&mStream->common));
     status = tempReadThread->run("reader", PRIORITY_URGENT_AUDIO);
     if (status != OK) {
         ALOGW("failed to start reader thread: %s", strerror(-status));
@@ -480,7 +497,11 @@ Return<void> StreamIn::getCapturePosition(getCapturePosition_cb _hidl_cb) {
 }
 
 Return<void> StreamIn::debug(const hidl_handle& fd, const hidl_vec<hidl_string>& options) {
-    return mStreamCommon->debug(fd, options);
+    mStreamCommon->debug(fd, options);
+    if (fd.getNativeHandle() != nullptr && fd->numFds == 1) {
+        mStats.dump(fd->data[0]);
+    }
+    return Void();
 }
 
 #if MAJOR_VERSION >= 4
@@ -54,7 +54,7 @@ class WriteThread : public Thread {
     // WriteThread's lifespan never exceeds StreamOut's lifespan.
     WriteThread(std::atomic<bool>* stop, audio_stream_out_t* stream,
                 StreamOut::CommandMQ* commandMQ, StreamOut::DataMQ* dataMQ,
-                StreamOut::StatusMQ* statusMQ, EventFlag* efGroup)
+                StreamOut::StatusMQ* statusMQ, EventFlag* efGroup, StreamStats* stats)
         : Thread(false /*canCallJava*/),
           mStop(stop),
           mStream(stream),
@@ -62,11 +62,7 @@ class WriteThread : public Thread {
           mDataMQ(dataMQ),
           mStatusMQ(statusMQ),
           mEfGroup(efGroup),
-          mBuffer(nullptr) {}
-    bool init() {
-        mBuffer.reset(new (std::nothrow) uint8_t[mDataMQ->getQuantumCount()]);
-        return mBuffer != nullptr;
-    }
+          mStats(stats) {}
     virtual ~WriteThread() {}
 
    private:
@@ -76,7 +72,7 @@ class WriteThread : public Thread {
     StreamOut::DataMQ* mDataMQ;
     StreamOut::StatusMQ* mStatusMQ;
     EventFlag* mEfGroup;
-    std::unique_ptr<uint8_t[]> mBuffer;
+    StreamStats* mStats;
     IStreamOut::WriteStatus mStatus;
 
     bool threadLoop() override;
@@ -86,18 +82,39 @@ class WriteThread : public Thread {
     void doWrite();
 };
 
+// The HAL writes straight from the data MQ's memory. Data that wrapped
+// around the end of the queue takes a second write.
 void WriteThread::doWrite() {
+    mStats->onWake(StreamStats::nowNs());
     const size_t availToRead = mDataMQ->availableToRead();
     mStatus.retval = Result::OK;
     mStatus.reply.written = 0;
-    if (mDataMQ->read(&mBuffer[0], availToRead)) {
-        ssize_t writeResult = mStream->write(mStream, &mBuffer[0], availToRead);
-        if (writeResult >= 0) {
-            mStatus.reply.written = writeResult;
-        } else {
-            mStatus.retval = Stream::analyzeStatus("write", writeResult);
+    StreamOut::DataMQ::MemTransaction tx;
+    if (!mDataMQ->beginRead(availToRead, &tx)) {
+        return;
+    }
+    for (const auto& region : {tx.getFirstRegion(), tx.getSecondRegion()}) {
+        if (region.getLength() == 0) {
+            break;
+        }
+        const int64_t startNs = StreamStats::nowNs();
+        ssize_t writeResult = mStream->write(mStream, region.getAddress(), region.getLength());
+        mStats->onTransfer(startNs, StreamStats::nowNs(), region.getLength(), writeResult);
+        if (writeResult < 0) {
+            if (mStatus.reply.written == 0) {
+                mStatus.retval = Stream::analyzeStatus("write", writeResult);
+            }
+            break;
+        }
+        mStatus.reply.written += writeResult;
+        if (static_cast<size_t>(writeResult) < region.getLength()) {
+            break;
         }
     }
+    // Whatever the HAL did not take is dropped, as with a copy: the client
+    // learns it from the written count and sends it again.
+    mDataMQ->commitRead(availToRead);
+    mStats->onResult(mStatus.retval, mStatus.reply.written);
 }
 
 void WriteThread::doGetPresentationPosition() {
@@ -156,7 +173,8 @@ StreamOut::StreamOut(const sp<Device>& device, audio_stream_out_t* stream)
       mStreamCommon(new Stream(false /*isInput*/, &stream->common)),
       mStreamMmap(new StreamMmap<audio_stream_out_t>(stream)),
       mEfGroup(nullptr),
-      mStopWriteThread(false) {}
+      mStopWriteThread(false),
+      mStats(false /*isInput*/, device->glitchJournal()) {}
 
 StreamOut::~StreamOut() {
     ATRACE_CALL();
@@ -265,6 +283,7 @@ Return<Result> StreamOut::removeEffect(uint64_t effectId) {
 }
 
 Return<Result> StreamOut::standby() {
+    mStats.onIdle();
     return mStreamCommon->standby();
 }
 
@@ -406,12 +425,8 @@ Return<void> StreamOut::prepareForWriting(uint32_t frameSize, uint32_t framesCou
     // Create and launch the thread.
     auto tempWriteThread =
             sp<WriteThread>::make(&mStopWriteThread, mStream, tempCommandMQ.get(), tempDataMQ.get(),
-                                  tempStatusMQ.get(), tempElfGroup.get());
-    if (!tempWriteThread->init()) {
-        ALOGW("failed to start writer thread: %s", strerror(-status));
-        sendError(Result::INVALID_ARGUMENTS);
-        return Void();
-    }
+                                  tempStatusMQ.get(), tempElfGroup.get(), &mStats);
+    mStats.setBuffer(frameSize, framesCount, mStream->common.get_sample_rate(&mStream->common));
     status = tempWriteThread->run("writer", PRIORITY_URGENT_AUDIO);
     if (status != OK) {
         ALOGW("failed to start writer thread: %s", strerror(-status));
@@ -512,6 +527,7 @@ Return<void> StreamOut::supportsPauseAndResume(supportsPauseAndResume_cb _hidl_c
 }
 
 Return<Result> StreamOut::pause() {
+    mStats.onIdle();
     return mStream->pause != NULL
                    ? Stream::analyzeStatus("pause", mStream->pause(mStream), {ENOSYS} /*ignore*/)
                    : Result::NOT_SUPPORTED;
@@ -537,6 +553,7 @@ Return<Result> StreamOut::drain(AudioDrain type) {
 }
 
 Return<Result> StreamOut::flush() {
+    mStats.onIdle();
     return mStream->flush != NULL
                    ? Stream::analyzeStatus("flush", mStream->flush(mStream), {ENOSYS} /*ignore*/)
                    : Result::NOT_SUPPORTED;
@@ -589,7 +606,11 @@ Return<void> StreamOut::getMmapPosition(getMmapPosition_cb _hidl_cb) {
 }
 
 Return<void> StreamOut::debug(const hidl_handle& fd, const hidl_vec<hidl_string>& options) {
-    return mStreamCommon->debug(fd, options);
+    mStreamCommon->debug(fd, options);
+    if (fd.getNativeHandle() != nullptr && fd->numFds == 1) {
+        mStats.dump(fd->data[0]);
+    }
+    return Void();
 }
 
 #if MAJOR_VERSION >= 4
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "StreamStatsHAL"
+#define ATRACE_TAG ATRACE_TAG_AUDIO
+
+#include "core/default/StreamStats.h"
+
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <android-base/stringprintf.h>
+#include <utils/Trace.h>
+
+namespace android {
+namespace hardware {
+namespace audio {
+namespace CPP_VERSION {
+namespace implementation {
+
+using ::android::base::StringAppendF;
+using ::android::base::StringPrintf;
+
+static std::atomic<int32_t> sNextStreamId{1};
+
+StreamStats::StreamStats(bool isInput, GlitchJournal* glitchJournal)
+    : mIsInput(isInput),
+      mId(sNextStreamId.fetch_add(1, std::memory_order_relaxed)),
+      mGlitchJournal(glitchJournal),
+      mTraceHalUs(StringPrintf("%s%d.halUs", isInput ? "AudioIn" : "AudioOut", mId)),
+      mTraceWakeUs(StringPrintf("%s%d.wakeUs", isInput ? "AudioIn" : "AudioOut", mId)),
+      mTraceShort(StringPrintf("%s%d.short", isInput ? "AudioIn" : "AudioOut", mId)),
+      mFrameSize(1),
+      mBufferNs(0),
+      mIdle(true),
+      mLastWakeNs(0),
+      mWakeNs(0),
+      mIntervalNs(0),
+      mTransfers(0),
+      mBytes(0),
+      mShortTransfers(0),
+      mFailedTransfers(0),
+      mErrors() {}
+
+// static
+int64_t StreamStats::nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void StreamStats::Histogram::record(int64_t ns) {
+    int64_t us = ns / 1000;
+    int bucket = 0;
+    while (bucket < kHistogramBuckets - 1 && us >= (kHistogramBaseUs << bucket)) bucket++;
+    add(&counts[bucket], 1);
+}
+
+std::string StreamStats::Histogram::toString() const {
+    std::string buf;
+    for (int i = 0; i < kHistogramBuckets; i++) {
+        uint64_t count = counts[i].load(std::memory_order_relaxed);
+        if (i < kHistogramBuckets - 1) {
+            StringAppendF(&buf, " <%" PRId64 "us:%" PRIu64, kHistogramBaseUs << i, count);
+        } else {
+            StringAppendF(&buf, " >=%" PRId64 "us:%" PRIu64, kHistogramBaseUs << (i - 1), count);
+        }
+    }
+    return buf;
+}
+
+void StreamStats::setBuffer(size_t frameSize, size_t frameCount, uint32_t sampleRate) {
+    mFrameSize = frameSize > 0 ? frameSize : 1;
+    mBufferNs = sampleRate > 0 ? frameCount * 1000000000LL / sampleRate : 0;
+}
+
+void StreamStats::onWake(int64_t nowNs) {
+    mWakeNs = nowNs;
+    mIntervalNs = 0;
+    if (mIdle.exchange(false, std::memory_order_relaxed)) {
+        mLastWakeNs = 0;
+    }
+    if (mLastWakeNs != 0) {
+        mIntervalNs = nowNs - mLastWakeNs;
+        mWakeInterval.record(mIntervalNs);
+        ATRACE_INT64(mTraceWakeUs.c_str(), mIntervalNs / 1000);
+    }
+    mLastWakeNs = nowNs;
+}
+
+void StreamStats::onTransfer(int64_t startNs, int64_t endNs, size_t requested, ssize_t result) {
+    mHalCall.record(endNs - startNs);
+    ATRACE_INT64(mTraceHalUs.c_str(), (endNs - startNs) / 1000);
+    add(&mTransfers, 1);
+    if (result < 0) {
+        add(&mFailedTransfers, 1);
+        return;
+    }
+    add(&mBytes, result);
+    if (static_cast<size_t>(result) < requested) {
+        add(&mShortTransfers, 1);
+        ATRACE_INT64(mTraceShort.c_str(), mShortTransfers.load(std::memory_order_relaxed));
+    }
+}
+
+void StreamStats::onResult(Result retval, uint64_t bytes) {
+    size_t index = static_cast<size_t>(retval);
+    if (retval != Result::OK) {
+        if (index < kResultCount) {
+            add(&mErrors[index], 1);
+        }
+        recordGlitch(GlitchJournal::Type::ERROR, bytes);
+    } else if (mBufferNs > 0 && mIntervalNs > mBufferNs) {
+        recordGlitch(GlitchJournal::Type::GAP, bytes);
+    }
+}
+
+void StreamStats::recordGlitch(GlitchJournal::Type type, uint64_t bytes) {
+    if (mGlitchJournal == nullptr) {
+        return;
+    }
+    mGlitchJournal->record({.type = type,
+                            .isInput = mIsInput,
+                            .streamId = mId,
+                            .timeNs = mWakeNs,
+                            .expectedNs = mBufferNs,
+                            .actualNs = mIntervalNs,
+                            .frames = static_cast<uint32_t>(bytes / mFrameSize)});
+}
+
+void StreamStats::dump(int fd) const {
+    std::string buf = StringPrintf(
+            "\n%s stream %d:\n"
+            "  %ss: %" PRIu64 ", %" PRIu64 " bytes, %" PRIu64 " short, %" PRIu64 " failed\n",
+            mIsInput ? "Input" : "Output", mId, mIsInput ? "Read" : "Write",
+            mTransfers.load(std::memory_order_relaxed), mBytes.load(std::memory_order_relaxed),
+            mShortTransfers.load(std::memory_order_relaxed),
+            mFailedTransfers.load(std::memory_order_relaxed));
+    buf += "  HAL call:" + mHalCall.toString() + "\n";
+    buf += "  Wake interval:" + mWakeInterval.toString() + "\n";
+    buf += "  Errors:";
+    for (size_t i = 1; i < kResultCount; i++) {
+        StringAppendF(&buf, " %s:%" PRIu64, toString(static_cast<Result>(i)).c_str(),
+                      mErrors[i].load(std::memory_order_relaxed));
+    }
+    buf += "\n";
+    write(fd, buf.c_str(), buf.size());
+}
+
+}  // namespace implementation
+}  // namespace CPP_VERSION
+}  // namespace audio
+}  // namespace hardware
+}  // namespace android
@@ -19,6 +19,7 @@
 
 #include PATH(android/hardware/audio/FILE_VERSION/IDevice.h)
 
+#include "GlitchJournal.h"
 #include "ParametersUtil.h"
 
 #include <memory>
@@ -170,6 +171,7 @@ struct Device : public IDevice, public ParametersUtil {
     void closeInputStream(audio_stream_in_t* stream);
     void closeOutputStream(audio_stream_out_t* stream);
     audio_hw_device_t* device() const { return mDevice; }
+    GlitchJournal* glitchJournal() { return &mGlitchJournal; }
 
     uint32_t version() const { return mDevice->common.version; }
 
@@ -177,6 +179,8 @@ struct Device : public IDevice, public ParametersUtil {
     bool mIsClosed;
     audio_hw_device_t* mDevice;
     int mOpenedStreamsCount = 0;
+    // Shared by every stream opened on the device
+    GlitchJournal mGlitchJournal;
 
     virtual ~Device();
 
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ANDROID_HARDWARE_AUDIO_GLITCHJOURNAL_H
+#define ANDROID_HARDWARE_AUDIO_GLITCHJOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace android {
+namespace hardware {
+namespace audio {
+namespace CPP_VERSION {
+namespace implementation {
+
+// The last glitches of all the streams of a device, with when they
+// happened, so they can be lined up with other traces.
+//
+// The data threads of the streams record into a fixed ring without locks;
+// a slot is claimed with an atomic index and published through a sequence
+// number, and a dump skips the slots being written or overwritten while
+// it reads them.
+class GlitchJournal {
+  public:
+    enum class Type : uint32_t {
+        // The client took longer than the whole buffer between transfers
+        GAP,
+        // The HAL failed a transfer
+        ERROR,
+    };
+
+    struct Event {
+        Type type;
+        bool isInput;
+        int32_t streamId;
+        // CLOCK_MONOTONIC
+        int64_t timeNs;
+        int64_t expectedNs;
+        int64_t actualNs;
+        uint32_t frames;
+    };
+
+    GlitchJournal();
+
+    void record(const Event& event);
+    void dump(int fd) const;
+
+  private:
+    static constexpr size_t kSize = 256;
+
+    struct Slot {
+        // 2 * index + 1 while the event of that index is being written,
+        // 2 * index + 2 once it is complete
+        std::atomic<uint64_t> seq;
+        std::atomic<uint64_t> info;  // type, direction and stream id
+        std::atomic<int64_t> timeNs;
+        std::atomic<int64_t> expectedNs;
+        std::atomic<int64_t> actualNs;
+        std::atomic<uint32_t> frames;
+    };
+
+    std::atomic<uint64_t> mNext;
+    Slot mSlots[kSize];
+};
+
+}  // namespace implementation
+}  // namespace CPP_VERSION
+}  // namespace audio
+}  // namespace hardware
+}  // namespace android
+
+#endif  // ANDROID_HARDWARE_AUDIO_GLITCHJOURNAL_H
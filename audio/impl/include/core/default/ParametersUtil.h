@@ -22,8 +22,13 @@
 #include PATH(android/hardware/audio/CORE_TYPES_FILE_VERSION/types.h)
 // clang-format on
 
+#include <stdint.h>
+
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 
 #include <hidl/HidlSupport.h>
 #include <media/AudioParameter.h>
@@ -56,12 +61,28 @@ class ParametersUtil {
                              const hidl_vec<ParameterValue>& parameters);
     Result setParams(const AudioParameter& param);
     Result setParam(const char* name, const DeviceAddress& address);
+    void dumpParamCache(int fd);
 
    protected:
     virtual ~ParametersUtil() {}
 
     virtual char* halGetParameters(const char* keys) = 0;
     virtual int halSetParameters(const char* keysAndValues) = 0;
+
+   private:
+    // Sets that carry context (a device address, or context pairs) bypass
+    // the cache and make it forget the keys they set.
+    Result setParamsUncached(const AudioParameter& param);
+
+    // The last value successfully set for each key, so that sets that
+    // would not change anything need not go through the HAL's parser.
+    // Held across the HAL call, so the cache follows the order the HAL
+    // saw the sets in.
+    std::mutex mParamCacheLock;
+    std::map<std::string, std::string> mParamCache;
+    uint64_t mParamsSent = 0;
+    uint64_t mParamsElided = 0;
+    uint64_t mParamSetsElided = 0;
 };
 
 }  // namespace implementation
@@ -23,6 +23,7 @@
 
 #include "Device.h"
 #include "Stream.h"
+#include "StreamStats.h"
 
 #include <atomic>
 #include <memory>
@@ -148,6 +149,8 @@ struct StreamIn : public IStreamIn {
     std::unique_ptr<StatusMQ> mStatusMQ;
     EventFlag* mEfGroup;
     std::atomic<bool> mStopReadThread;
+    // Updated by the data thread
+    StreamStats mStats;
     sp<Thread> mReadThread;
 
     virtual ~StreamIn();
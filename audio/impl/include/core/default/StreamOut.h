@@ -21,6 +21,7 @@
 
 #include "Device.h"
 #include "Stream.h"
+#include "StreamStats.h"
 
 #include <atomic>
 #include <memory>
@@ -178,6 +179,8 @@ struct StreamOut : public IStreamOut {
     std::unique_ptr<StatusMQ> mStatusMQ;
     EventFlag* mEfGroup;
     std::atomic<bool> mStopWriteThread;
+    // Updated by the data thread
+    StreamStats mStats;
     sp<Thread> mWriteThread;
 
     virtual ~StreamOut();
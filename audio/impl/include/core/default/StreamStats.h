@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ANDROID_HARDWARE_AUDIO_STREAMSTATS_H
+#define ANDROID_HARDWARE_AUDIO_STREAMSTATS_H
+
+// clang-format off
+#include PATH(android/hardware/audio/CORE_TYPES_FILE_VERSION/types.h)
+// clang-format on
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <string>
+
+#include "GlitchJournal.h"
+
+namespace android {
+namespace hardware {
+namespace audio {
+namespace CPP_VERSION {
+namespace implementation {
+
+using namespace ::android::hardware::audio::CORE_TYPES_CPP_VERSION;
+
+// Statistics of the data thread of a stream: how long the HAL's read or
+// write calls take, how far apart the thread is woken for data, short
+// transfers and failed ones. Only the data thread updates them, with
+// relaxed atomics, so it never waits on a dump; a dump may see one count
+// a transfer ahead of another.
+//
+// Gaps between transfers longer than the whole buffer and failed
+// transfers also go to the device's glitch journal.
+class StreamStats {
+  public:
+    StreamStats(bool isInput, GlitchJournal* glitchJournal);
+
+    // Called before the data thread starts.
+    void setBuffer(size_t frameSize, size_t frameCount, uint32_t sampleRate);
+    // Called when the stream stops moving data, so the gap until it starts
+    // again is not taken for a glitch.
+    void onIdle() { mIdle.store(true, std::memory_order_relaxed); }
+
+    // Called by the data thread when it is woken for a transfer.
+    void onWake(int64_t nowNs);
+    // Called by the data thread after each read or write call of the HAL.
+    void onTransfer(int64_t startNs, int64_t endNs, size_t requested, ssize_t result);
+    // Called by the data thread with the outcome of every transfer command.
+    void onResult(Result retval, uint64_t bytes);
+
+    int32_t id() const { return mId; }
+    void dump(int fd) const;
+
+    static int64_t nowNs();
+
+  private:
+    // Bucket i holds durations below kHistogramBaseUs << i, the last one
+    // everything longer.
+    static constexpr int kHistogramBuckets = 10;
+    static constexpr int64_t kHistogramBaseUs = 250;
+    // Result values up to NOT_SUPPORTED
+    static constexpr size_t kResultCount = 5;
+
+    struct Histogram {
+        std::atomic<uint64_t> counts[kHistogramBuckets] = {};
+
+        void record(int64_t ns);
+        std::string toString() const;
+    };
+
+    // There is a single writer, so a plain load and store does instead of
+    // a locked add.
+    static void add(std::atomic<uint64_t>* counter, uint64_t value) {
+        counter->store(counter->load(std::memory_order_relaxed) + value,
+                       std::memory_order_relaxed);
+    }
+
+    void recordGlitch(GlitchJournal::Type type, uint64_t bytes);
+
+    const bool mIsInput;
+    const int32_t mId;
+    GlitchJournal* const mGlitchJournal;
+    // Counter names for systrace
+    const std::string mTraceHalUs;
+    const std::string mTraceWakeUs;
+    const std::string mTraceShort;
+
+    size_t mFrameSize;
+    int64_t mBufferNs;
+    std::atomic<bool> mIdle;
+
+    // Only touched by the data thread
+    int64_t mLastWakeNs;
+    int64_t mWakeNs;
+    int64_t mIntervalNs;
+
+    Histogram mHalCall;
+    Histogram mWakeInterval;
+    std::atomic<uint64_t> mTransfers;
+    std::atomic<uint64_t> mBytes;
+    std::atomic<uint64_t> mShortTransfers;
+    std::atomic<uint64_t> mFailedTransfers;
+    std::atomic<uint64_t> mErrors[kResultCount];
+};
+
+}  // namespace implementation
+}  // namespace CPP_VERSION
+}  // namespace audio
+}  // namespace hardware
+}  // namespace android
+
+#endif  // ANDROID_HARDWARE_AUDIO_STREAMSTATS_H
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "libqti-perfd-client"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <log/log.h>
+
+#include "PerfLockClient.h"
+#include "PerfLockRequest.h"
+
+#define NSINSEC 1000000000LL
+#define NSINMS 1000000LL
+
+// Expiry granularity of timed locks
+static constexpr int64_t kTickNs = 10 * NSINMS;
+// How long to wait before connecting again while the HAL is not there
+static constexpr int64_t kRetryNs = 1 * NSINSEC;
+
+static int64_t NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSINSEC + ts.tv_nsec;
+}
+
+PerfLockClient::PerfLockClient(std::string socket_path)
+    : mSocketPath(std::move(socket_path)),
+      mWheel(PerfLockTable::kCapacity, kTickNs, NowNs()),
+      mExit(false),
+      mEventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      mSocketFd(-1),
+      mSent() {
+    if (mEventFd < 0)
+        ALOGE("%s: unable to create event fd (%d)", __func__, errno);
+}
+
+PerfLockClient::~PerfLockClient() {
+    std::unique_lock<std::mutex> lk(mLock);
+    mExit = true;
+    lk.unlock();
+
+    if (mThread) {
+        Wake();
+        mThread->join();
+    }
+    Disconnect();
+    if (mEventFd >= 0)
+        close(mEventFd);
+}
+
+int PerfLockClient::Acquire(int handle, int durationMs, const int *args, int count) {
+    int levels[PERF_LOCK_RESOURCE_COUNT] = {};
+    for (int i = 0; i + 1 < count; i += 2) {
+        PerfLockResource resource;
+        int level;
+        if (DecodePerfLockRequest(args[i], args[i + 1], &resource, &level))
+            levels[resource] = std::max(levels[resource], level);
+    }
+
+    std::lock_guard<std::mutex> lk(mLock);
+    // Acquiring with a held handle replaces its lock.
+    int slot = mTable.Find(handle);
+    if (slot >= 0) {
+        mTable.Replace(slot, levels);
+    } else {
+        handle = mTable.Add(levels);
+        if (handle < 0) {
+            ALOGE("%s: too many locks held", __func__);
+            return -1;
+        }
+        slot = mTable.Find(handle);
+    }
+    if (durationMs > 0)
+        mWheel.Schedule(slot, NowNs() + durationMs * NSINMS);
+    else
+        mWheel.Cancel(slot);
+    StartThreadLocked();
+    Wake();
+    return handle;
+}
+
+int PerfLockClient::Release(int handle) {
+    std::lock_guard<std::mutex> lk(mLock);
+    int slot = mTable.Find(handle);
+    if (slot < 0)
+        return -1;
+    mTable.Remove(slot);
+    mWheel.Cancel(slot);
+    Wake();
+    return 0;
+}
+
+// should be called while locked
+void PerfLockClient::StartThreadLocked() {
+    if (mThread)
+        return;
+    mThread = std::make_unique<std::thread>(&PerfLockClient::Routine, this);
+}
+
+void PerfLockClient::Wake() {
+    uint64_t val = 1;
+    if (mEventFd >= 0 && write(mEventFd, &val, sizeof(val)) != sizeof(val))
+        ALOGW("%s: unable to write to event fd (%d)", __func__, errno);
+}
+
+bool PerfLockClient::Connect() {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ALOGE("%s: unable to create socket (%d)", __func__, errno);
+        return false;
+    }
+
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", mSocketPath.c_str());
+    if (connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+        ALOGE("%s: power HAL not available at %s (%d)", __func__, mSocketPath.c_str(), errno);
+        close(fd);
+        return false;
+    }
+    mSocketFd = fd;
+    return true;
+}
+
+// A new connection starts with nothing held.
+void PerfLockClient::Disconnect() {
+    if (mSocketFd >= 0)
+        close(mSocketFd);
+    mSocketFd = -1;
+    std::fill(std::begin(mSent), std::end(mSent), 0);
+}
+
+bool PerfLockClient::Send(const int levels[PERF_LOCK_RESOURCE_COUNT]) {
+    for (int r = 0; r < PERF_LOCK_RESOURCE_COUNT; r++) {
+        if (levels[r] == mSent[r])
+            continue;
+        PerfLockLevel message = {static_cast<uint32_t>(r), levels[r]};
+        if (send(mSocketFd, &message, sizeof(message), MSG_NOSIGNAL) != sizeof(message)) {
+            ALOGE("%s: failed to send %s level %d (%d)", __func__, kPerfLockResourceNames[r],
+                  levels[r], errno);
+            return false;
+        }
+        mSent[r] = levels[r];
+    }
+    return true;
+}
+
+void PerfLockClient::Routine() {
+    int levels[PERF_LOCK_RESOURCE_COUNT];
+    int64_t retryNs = 0;
+
+    std::unique_lock<std::mutex> lk(mLock);
+    while (!mExit) {
+        mWheel.Advance(NowNs(), [&](size_t slot) { mTable.Remove(slot); });
+        bool held = false;
+        for (int r = 0; r < PERF_LOCK_RESOURCE_COUNT; r++) {
+            levels[r] = mTable.Level(static_cast<PerfLockResource>(r));
+            held = held || levels[r] > 0;
+        }
+        int64_t next = mWheel.NextWakeNs();
+        lk.unlock();
+
+        // Talk to the HAL unlocked: a slow HAL must not hold up the caller.
+        // Nothing held needs no connection, the HAL's floors are down then.
+        if (mSocketFd < 0 && held && NowNs() >= retryNs && !Connect())
+            retryNs = NowNs() + kRetryNs;
+        if (mSocketFd >= 0 && !Send(levels)) {
+            Disconnect();
+            retryNs = NowNs() + kRetryNs;
+        }
+        if (mSocketFd < 0 && held)
+            next = std::min(next, retryNs);
+
+        struct pollfd pfd[2] = {
+            {mEventFd, POLLIN, 0},
+            {mSocketFd, POLLIN, 0},
+        };
+        int timeoutMs = -1;
+        if (next != INT64_MAX)
+            timeoutMs = std::max<int64_t>(0, (next - NowNs() + NSINMS - 1) / NSINMS);
+        int ret = poll(pfd, 2, timeoutMs);
+        if (ret < 0 && errno != EINTR)
+            ALOGE("%s: error in poll (%d)", __func__, errno);
+        if (ret > 0 && pfd[0].revents) {
+            uint64_t val;
+            if (read(mEventFd, &val, sizeof(val)) != sizeof(val))
+                ALOGW("%s: unable to read event fd (%d)", __func__, errno);
+        }
+        if (ret > 0 && pfd[1].revents) {
+            // The HAL never writes, so this is the connection closing, and
+            // the HAL dropped our levels with it. Connect again at once.
+            ALOGW("%s: power HAL connection closed", __func__);
+            Disconnect();
+            retryNs = 0;
+        }
+
+        lk.lock();
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PERFLOCKCLIENT_H
+#define PERFLOCKCLIENT_H
+
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "PerfLockHints.h"
+#include "PerfLockTable.h"
+#include "TimerWheel.h"
+
+// Holds the perf locks of this process and keeps the power HAL's floors at
+// the highest level any of them wants, see PerfLockHints.h.
+//
+// Callers only update the table: the levels are sent from the client's own
+// thread, which also expires timed locks. It watches the connection, and
+// once the HAL goes away it connects again and resends the levels held.
+class PerfLockClient {
+  public:
+    explicit PerfLockClient(std::string socket_path);
+    ~PerfLockClient();
+
+    // Returns the handle of the lock, or -1.
+    int Acquire(int handle, int durationMs, const int *args, int count);
+    int Release(int handle);
+
+  private:
+    // should be called while locked
+    void StartThreadLocked();
+    void Wake();
+    bool Connect();
+    void Disconnect();
+    // Sends the levels that differ from the ones sent, false on error.
+    bool Send(const int levels[PERF_LOCK_RESOURCE_COUNT]);
+    void Routine();
+
+    const std::string mSocketPath;
+    PerfLockTable mTable;
+    TimerWheel mWheel;
+    bool mExit;
+    std::unique_ptr<std::thread> mThread;
+    int mEventFd;
+    std::mutex mLock;
+
+    // Owned by the thread
+    int mSocketFd;
+    int mSent[PERF_LOCK_RESOURCE_COUNT];
+};
+
+#endif //PERFLOCKCLIENT_H
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "libqti-perfd-client"
+
+#include <algorithm>
+
+#include <log/log.h>
+
+#include "PerfLockRequest.h"
+
+// Opcodes of the QTI perf lock v3 resource format:
+// 0x40000000 | major << 22 | minor << 14 | cluster << 8 | core
+#define OPCODE_MAJOR(op) (((op) >> 22) & 0xff)
+#define OPCODE_MINOR(op) (((op) >> 14) & 0xff)
+#define OPCODE_CLUSTER(op) (((op) >> 8) & 0xf)
+
+enum {
+    MAJOR_CPUFREQ = 2,
+    MAJOR_SCHED = 3,
+    MAJOR_CPUBW_HWMON = 6,
+    MAJOR_GPU = 10,
+};
+
+enum {
+    CPUFREQ_MIN_FREQ = 0,
+    CPUFREQ_MAX_FREQ = 1,
+};
+
+enum {
+    SCHED_BOOST = 0,
+};
+
+enum {
+    CPUBW_HWMON_MIN_FREQ = 0,
+};
+
+enum {
+    GPU_POWER_LEVEL = 0,
+    GPU_MIN_POWER_LEVEL = 1,
+    GPU_MAX_POWER_LEVEL = 2,
+    GPU_MIN_FREQ = 3,
+};
+
+// Floor each level of a resource gives, in the unit the requests are
+// converted to; a request gets the lowest level covering it. Keep in
+// sync with the PERF_LOCK_* actions of powerhint.json.
+static const int64_t kLevelFloors[PERF_LOCK_RESOURCE_COUNT][kPerfLockLevelCount] = {
+    {1209600, 1459200, INT64_MAX},  // kHz
+    {1132800, 1420800, INT64_MAX},  // kHz
+    {1, 2, 3},                      // sched boost strength
+    {4577, 6500, INT64_MAX},        // MB/s
+    {342, 520, INT64_MAX},          // MHz
+};
+
+// Adreno 630 power levels, highest first, in MHz
+static const int kGpuPowerLevelMhz[] = {710, 675, 596, 520, 414, 342, 257};
+
+static int LevelFor(PerfLockResource resource, int64_t request) {
+    if (request <= 0)
+        return 0;
+    for (int level = 0; level < kPerfLockLevelCount; level++) {
+        if (request <= kLevelFloors[resource][level])
+            return level + 1;
+    }
+    return kPerfLockLevelCount;
+}
+
+bool DecodePerfLockRequest(uint32_t opcode, int32_t value, PerfLockResource *resource,
+                           int *level) {
+    if ((opcode & 0xc0000000) != 0x40000000) {
+        ALOGV("%s: legacy opcode 0x%x not supported", __func__, opcode);
+        return false;
+    }
+
+    switch (OPCODE_MAJOR(opcode)) {
+        case MAJOR_CPUFREQ:
+            if (OPCODE_MINOR(opcode) != CPUFREQ_MIN_FREQ)
+                break;
+            // Cluster 0 is the big one in the QTI numbering
+            *resource = OPCODE_CLUSTER(opcode) == 0 ? PERF_LOCK_CPU_BIG_MIN
+                                                    : PERF_LOCK_CPU_LITTLE_MIN;
+            *level = LevelFor(*resource, static_cast<int64_t>(value) * 1000);
+            return true;
+        case MAJOR_SCHED:
+            if (OPCODE_MINOR(opcode) != SCHED_BOOST)
+                break;
+            // 1 is full throttle, 2 conservative and 3 restrained
+            *resource = PERF_LOCK_SCHED_BOOST;
+            *level = value > 0 ? kPerfLockLevelCount - std::min(value, 3) + 1 : 0;
+            return true;
+        case MAJOR_CPUBW_HWMON:
+            if (OPCODE_MINOR(opcode) != CPUBW_HWMON_MIN_FREQ)
+                break;
+            *resource = PERF_LOCK_CPUBW_MIN;
+            *level = LevelFor(*resource, value);
+            return true;
+        case MAJOR_GPU: {
+            int mhz;
+            if (OPCODE_MINOR(opcode) == GPU_MIN_FREQ) {
+                mhz = value;
+            } else if (OPCODE_MINOR(opcode) == GPU_POWER_LEVEL ||
+                       OPCODE_MINOR(opcode) == GPU_MIN_POWER_LEVEL) {
+                int count = sizeof(kGpuPowerLevelMhz) / sizeof(kGpuPowerLevelMhz[0]);
+                if (value < 0 || value >= count)
+                    return false;
+                mhz = kGpuPowerLevelMhz[value];
+            } else {
+                break;
+            }
+            *resource = PERF_LOCK_GPU_MIN;
+            *level = LevelFor(*resource, mhz);
+            return true;
+        }
+        default:
+            break;
+    }
+
+    // Caps and tunables are left to the power HAL's own policy.
+    ALOGV("%s: opcode 0x%x not supported", __func__, opcode);
+    return false;
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PERFLOCKREQUEST_H
+#define PERFLOCKREQUEST_H
+
+#include <stdint.h>
+
+#include "PerfLockHints.h"
+
+// Decodes one opcode and value pair of a perf_lock_acq() request into the
+// resource it raises the floor of and the level covering the value.
+// Returns false for requests this device has no floor for.
+bool DecodePerfLockRequest(uint32_t opcode, int32_t value, PerfLockResource *resource,
+                           int *level);
+
+#endif //PERFLOCKREQUEST_H
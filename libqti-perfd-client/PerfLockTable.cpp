@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "PerfLockTable.h"
+
+// Generations wrap before the handle would turn negative; 0 is skipped so
+// handles stay above 0.
+static constexpr uint32_t kGenerationMask = (1u << (31 - PerfLockTable::kSlotBits)) - 1;
+
+PerfLockTable::PerfLockTable() : mLocks(), mHeld() {
+    mFree.reserve(kCapacity);
+    // Hand out the low slots first
+    for (size_t slot = kCapacity; slot > 0; slot--)
+        mFree.push_back(slot - 1);
+}
+
+void PerfLockTable::Count(const int levels[PERF_LOCK_RESOURCE_COUNT], int delta) {
+    for (int r = 0; r < PERF_LOCK_RESOURCE_COUNT; r++) {
+        if (levels[r] > 0)
+            mHeld[r][levels[r] - 1] += delta;
+    }
+}
+
+int PerfLockTable::Add(const int levels[PERF_LOCK_RESOURCE_COUNT]) {
+    if (mFree.empty())
+        return -1;
+
+    uint32_t slot = mFree.back();
+    mFree.pop_back();
+    Lock &lock = mLocks[slot];
+    lock.generation = (lock.generation + 1) & kGenerationMask;
+    if (!lock.generation)
+        lock.generation = 1;
+    lock.held = true;
+    memcpy(lock.levels, levels, sizeof(lock.levels));
+    Count(lock.levels, 1);
+    return static_cast<int>(lock.generation << kSlotBits | slot);
+}
+
+int PerfLockTable::Find(int handle) const {
+    if (handle <= 0)
+        return -1;
+    uint32_t slot = handle & (kCapacity - 1);
+    const Lock &lock = mLocks[slot];
+    if (!lock.held || lock.generation != static_cast<uint32_t>(handle) >> kSlotBits)
+        return -1;
+    return slot;
+}
+
+void PerfLockTable::Replace(size_t slot, const int levels[PERF_LOCK_RESOURCE_COUNT]) {
+    Lock &lock = mLocks[slot];
+    Count(lock.levels, -1);
+    memcpy(lock.levels, levels, sizeof(lock.levels));
+    Count(lock.levels, 1);
+}
+
+void PerfLockTable::Remove(size_t slot) {
+    Lock &lock = mLocks[slot];
+    if (!lock.held)
+        return;
+    Count(lock.levels, -1);
+    lock.held = false;
+    mFree.push_back(slot);
+}
+
+int PerfLockTable::Level(PerfLockResource resource) const {
+    for (int level = kPerfLockLevelCount; level > 0; level--) {
+        if (mHeld[resource][level - 1])
+            return level;
+    }
+    return 0;
+}
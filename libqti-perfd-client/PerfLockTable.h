@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PERFLOCKTABLE_H
+#define PERFLOCKTABLE_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "PerfLockHints.h"
+
+// The perf locks a process holds, by handle. A handle is a slot and the
+// generation of the slot when the lock was taken, so the handle of a
+// released lock never matches the lock that reuses its slot.
+//
+// How many locks hold each resource at each level is counted, which keeps
+// the level a resource is held at up to date in O(levels) as locks come
+// and go.
+//
+// Not thread safe, the owner locks around it.
+class PerfLockTable {
+  public:
+    static constexpr int kSlotBits = 8;
+    static constexpr size_t kCapacity = 1 << kSlotBits;
+
+    PerfLockTable();
+
+    // Returns the handle of the new lock, or -1 when the table is full.
+    int Add(const int levels[PERF_LOCK_RESOURCE_COUNT]);
+    // Returns the slot of a held lock, or -1.
+    int Find(int handle) const;
+    void Replace(size_t slot, const int levels[PERF_LOCK_RESOURCE_COUNT]);
+    void Remove(size_t slot);
+
+    // The highest level any lock holds the resource at, 0 if none does.
+    int Level(PerfLockResource resource) const;
+    size_t Size() const { return kCapacity - mFree.size(); }
+
+  private:
+    struct Lock {
+        uint32_t generation;
+        bool held;
+        int levels[PERF_LOCK_RESOURCE_COUNT];
+    };
+
+    void Count(const int levels[PERF_LOCK_RESOURCE_COUNT], int delta);
+
+    Lock mLocks[kCapacity];
+    std::vector<uint32_t> mFree;
+    // Locks holding each resource at each level, level 1 first
+    uint32_t mHeld[PERF_LOCK_RESOURCE_COUNT][kPerfLockLevelCount];
+};
+
+#endif //PERFLOCKTABLE_H
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(size_t capacity, int64_t tickNs, int64_t nowNs)
+    : mTickNs(tickNs),
+      mTick(nowNs / tickNs),
+      mPending(0),
+      mTimers(capacity, Timer{0, -1, -1, -1}),
+      mBuckets(kLevels * kSlots, -1) {}
+
+// Puts a timer in the list of the lowest level that reaches its expiry.
+// Timers further out than the top level are parked at its far end and
+// put back once they come down.
+void TimerWheel::Insert(size_t id) {
+    Timer &timer = mTimers[id];
+    int64_t tick = std::max(timer.expiryTick, mTick);
+    int64_t delta = tick - mTick;
+
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (int64_t(1) << (kSlotBits * (level + 1))))
+        level++;
+    int64_t span = int64_t(1) << (kSlotBits * kLevels);
+    if (delta >= span)
+        tick = mTick + span - 1;
+
+    int32_t bucket = level * kSlots + ((tick >> (kSlotBits * level)) & kSlotMask);
+    timer.bucket = bucket;
+    timer.prev = -1;
+    timer.next = mBuckets[bucket];
+    if (timer.next >= 0)
+        mTimers[timer.next].prev = id;
+    mBuckets[bucket] = id;
+    mPending++;
+}
+
+void TimerWheel::Unlink(size_t id) {
+    Timer &timer = mTimers[id];
+    if (timer.prev >= 0)
+        mTimers[timer.prev].next = timer.next;
+    else
+        mBuckets[timer.bucket] = timer.next;
+    if (timer.next >= 0)
+        mTimers[timer.next].prev = timer.prev;
+    timer.prev = timer.next = timer.bucket = -1;
+    mPending--;
+}
+
+void TimerWheel::Schedule(size_t id, int64_t expiryNs) {
+    if (mTimers[id].bucket >= 0)
+        Unlink(id);
+    mTimers[id].expiryTick = (expiryNs + mTickNs - 1) / mTickNs;
+    Insert(id);
+}
+
+void TimerWheel::Cancel(size_t id) {
+    if (mTimers[id].bucket >= 0)
+        Unlink(id);
+}
+
+// Moves the timers of the level's current slot down.
+void TimerWheel::Cascade(int level) {
+    int32_t bucket = level * kSlots + ((mTick >> (kSlotBits * level)) & kSlotMask);
+    while (mBuckets[bucket] >= 0) {
+        size_t id = mBuckets[bucket];
+        Unlink(id);
+        Insert(id);
+    }
+}
+
+void TimerWheel::Advance(int64_t nowNs, const std::function<void(size_t id)> &expired) {
+    int64_t target = nowNs / mTickNs;
+    if (!mPending) {
+        mTick = std::max(mTick, target + 1);
+        return;
+    }
+
+    for (; mTick <= target; mTick++) {
+        // Top down, so timers can fall through more than one level
+        if (!(mTick & kSlotMask)) {
+            for (int level = kLevels - 1; level >= 1; level--) {
+                if (!(mTick & ((int64_t(1) << (kSlotBits * level)) - 1)))
+                    Cascade(level);
+            }
+        }
+
+        // One at a time: the callback may cancel timers in the same slot
+        int32_t bucket = mTick & kSlotMask;
+        while (mBuckets[bucket] >= 0) {
+            size_t id = mBuckets[bucket];
+            Unlink(id);
+            if (mTimers[id].expiryTick <= mTick)
+                expired(id);
+            else
+                Insert(id);
+        }
+    }
+}
+
+int64_t TimerWheel::NextWakeNs() const {
+    if (!mPending)
+        return INT64_MAX;
+    // Timers of the current block sit in level 0, unless the block has yet
+    // to start; the others come down at the end of it.
+    for (int level = 1; level < kLevels; level++) {
+        if (mTick & ((int64_t(1) << (kSlotBits * level)) - 1))
+            break;
+        if (mBuckets[level * kSlots + ((mTick >> (kSlotBits * level)) & kSlotMask)] >= 0)
+            return mTick * mTickNs;
+    }
+    int64_t end = mTick | kSlotMask;
+    for (int64_t tick = mTick; tick <= end; tick++) {
+        if (mBuckets[tick & kSlotMask] >= 0)
+            return tick * mTickNs;
+    }
+    return (end + 1) * mTickNs;
+}
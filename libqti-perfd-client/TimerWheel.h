@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+// Hierarchical timer wheel for a fixed set of timers, named by their index
+// below the capacity. Scheduling and cancelling are O(1); a timer is moved
+// down a level at most once per level before it fires. Expiry is rounded
+// up to the next tick, so timers never fire early.
+//
+// Not thread safe, the owner locks around it.
+class TimerWheel {
+  public:
+    TimerWheel(size_t capacity, int64_t tickNs, int64_t nowNs);
+
+    // Replaces the timer's previous expiry, if any.
+    void Schedule(size_t id, int64_t expiryNs);
+    void Cancel(size_t id);
+    // Runs every tick up to |nowNs| and calls |expired| for each timer due.
+    // The callback may schedule or cancel timers.
+    void Advance(int64_t nowNs, const std::function<void(size_t id)> &expired);
+
+    bool Empty() const { return mPending == 0; }
+    // When Advance() next has work to do, INT64_MAX if no timer is pending.
+    int64_t NextWakeNs() const;
+
+  private:
+    static constexpr int kLevels = 3;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr int64_t kSlotMask = kSlots - 1;
+
+    struct Timer {
+        int64_t expiryTick;
+        int32_t prev;
+        int32_t next;
+        // Index of the list holding the timer, -1 if not scheduled
+        int32_t bucket;
+    };
+
+    void Insert(size_t id);
+    void Unlink(size_t id);
+    void Cascade(int level);
+
+    const int64_t mTickNs;
+    // The next tick Advance() has to run
+    int64_t mTick;
+    size_t mPending;
+    std::vector<Timer> mTimers;
+    // kLevels * kSlots list heads, -1 when empty
+    std::vector<int32_t> mBuckets;
+};
+
+#endif //TIMERWHEEL_H
@@ -1,24 +1,46 @@
 #define LOG_TAG "libqti-perfd-client"
 
-#include <stdint.h>
+#include <string>
+
 #include <log/log.h>
 
+#include "PerfLockClient.h"
+
+static PerfLockClient &Client() {
+    // Never destroyed, its thread may outlive static destructors
+    static PerfLockClient *client =
+            new PerfLockClient(std::string("/dev/socket/") + kPerfLockSocket);
+    return *client;
+}
+
 extern "C" void perf_get_feedback() {}
-extern "C" void perf_hint() {}
+
+extern "C" int perf_hint(int hint, const char * /* pkg */, int duration, int /* type */) {
+    ALOGV("perf_hint: hint: 0x%x, duration: %d not supported", hint, duration);
+    return -1;
+}
+
 extern "C" int perf_lock_acq(int handle, int duration, int arg3[], int arg4) {
-    ALOGI("perf_lock_acq: handle: %d, duration: %d, arg3[0]: %d, arg4: %d",
-            handle, duration, arg3[0], arg4);
-    if (handle > 0)
-        return handle;
+    if (!arg3 || arg4 <= 0) {
+        ALOGE("perf_lock_acq: no resources");
+        return -1;
+    }
+    int ret = Client().Acquire(handle, duration, arg3, arg4);
+    ALOGV("perf_lock_acq: handle: %d -> %d, duration: %d, args: %d", handle, ret, duration,
+          arg4);
+    return ret;
+}
 
-    return 233;
+extern "C" int perf_lock_cmd(int /* cmd */) {
+    return 0;
 }
-extern "C" void perf_lock_cmd() {}
+
 extern "C" int perf_lock_rel(int handle) {
-    ALOGI("perf_lock_rel: handle: %d", handle);
-    if (handle > 0)
-        return handle;
+    ALOGV("perf_lock_rel: handle: %d", handle);
+    return Client().Release(handle);
+}
 
-    return 233;
+extern "C" int perf_lock_use_profile(int handle, int profile) {
+    ALOGV("perf_lock_use_profile: handle: %d, profile: %d not supported", handle, profile);
+    return -1;
 }
-extern "C" void perf_lock_use_profile() {}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PERFLOCKHINTS_H
+#define PERFLOCKHINTS_H
+
+#include <stdint.h>
+
+// Resources perf_lock_acq() can raise the floor of. The client keeps a
+// connection to the power HAL's kPerfLockSocket and sends a PerfLockLevel
+// whenever the highest level its locks want for a resource changes: 1 to
+// kPerfLockLevelCount, or 0 to drop the floor. The HAL holds each resource
+// at the highest level any connection wants by applying the
+// PERF_LOCK_<name>_<level> hint of powerhint.json, and forgets the levels
+// of a connection once it closes.
+enum PerfLockResource {
+    PERF_LOCK_CPU_BIG_MIN = 0,
+    PERF_LOCK_CPU_LITTLE_MIN,
+    PERF_LOCK_SCHED_BOOST,
+    PERF_LOCK_CPUBW_MIN,
+    PERF_LOCK_GPU_MIN,
+
+    // Don't add any lines after this line
+    PERF_LOCK_RESOURCE_COUNT
+};
+
+constexpr int kPerfLockLevelCount = 3;
+
+constexpr const char *kPerfLockResourceNames[PERF_LOCK_RESOURCE_COUNT] = {
+    "CPU_BIG_MIN", "CPU_LITTLE_MIN", "SCHED_BOOST", "CPUBW_MIN", "GPU_MIN",
+};
+
+// Socket init creates for the power HAL under /dev/socket, SOCK_SEQPACKET
+// with one PerfLockLevel per packet.
+constexpr char kPerfLockSocket[] = "vendor_powerhal_perflock";
+
+struct PerfLockLevel {
+    uint32_t resource;
+    int32_t level;
+};
+
+#endif //PERFLOCKHINTS_H
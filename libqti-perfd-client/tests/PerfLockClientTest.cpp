@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <poll.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android-base/file.h>
+#include <android-base/unique_fd.h>
+#include <gtest/gtest.h>
+
+#include "PerfLockClient.h"
+
+namespace {
+
+using android::base::unique_fd;
+
+constexpr int kCpuMinFreq = 0x40800000;
+constexpr int kGpuMinFreq = 0x4280c000;
+constexpr int kTimeoutMs = 3000;
+
+// The power HAL's end of the perf lock socket.
+class FakeHal {
+  public:
+    FakeHal() : mPath(std::string(mDir.path) + "/perflock") { Listen(); }
+
+    const std::string &Path() const { return mPath; }
+
+    void Listen() {
+        unlink(mPath.c_str());
+        mListenFd.reset(socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+        struct sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", mPath.c_str());
+        ASSERT_EQ(0, bind(mListenFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)));
+        ASSERT_EQ(0, listen(mListenFd, 4));
+    }
+
+    // Drops the client and stops listening, as a dying HAL does.
+    void Die() {
+        mClientFd.reset();
+        mListenFd.reset();
+        unlink(mPath.c_str());
+    }
+
+    // Waits for the next level sent, accepting the client first if needed.
+    bool Receive(PerfLockLevel *message, int timeoutMs = kTimeoutMs) {
+        if (mClientFd < 0) {
+            if (!Wait(mListenFd, timeoutMs))
+                return false;
+            mClientFd.reset(accept4(mListenFd, nullptr, nullptr, SOCK_CLOEXEC));
+        }
+        return Wait(mClientFd, timeoutMs) &&
+               recv(mClientFd, message, sizeof(*message), 0) == sizeof(*message);
+    }
+
+    std::pair<uint32_t, int32_t> Next() {
+        PerfLockLevel message = {PERF_LOCK_RESOURCE_COUNT, -1};
+        EXPECT_TRUE(Receive(&message));
+        return {message.resource, message.level};
+    }
+
+    bool Idle(int ms) {
+        struct pollfd pfd = {mClientFd, POLLIN, 0};
+        return poll(&pfd, 1, ms) == 0;
+    }
+
+  private:
+    static bool Wait(int fd, int timeoutMs) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        return poll(&pfd, 1, timeoutMs) == 1;
+    }
+
+    TemporaryDir mDir;
+    const std::string mPath;
+    unique_fd mListenFd;
+    unique_fd mClientFd;
+};
+
+std::pair<uint32_t, int32_t> Level(PerfLockResource resource, int32_t level) {
+    return {resource, level};
+}
+
+TEST(PerfLockClientTest, SendsHighestLevelHeld) {
+    FakeHal hal;
+    PerfLockClient client(hal.Path());
+
+    int low[] = {kCpuMinFreq, 1200};
+    int high[] = {kCpuMinFreq, 2800, kGpuMinFreq, 500};
+    int first = client.Acquire(0, 0, low, 2);
+    ASSERT_GT(first, 0);
+    EXPECT_EQ(Level(PERF_LOCK_CPU_BIG_MIN, 1), hal.Next());
+
+    int second = client.Acquire(0, 0, high, 4);
+    ASSERT_GT(second, 0);
+    EXPECT_EQ(Level(PERF_LOCK_CPU_BIG_MIN, 3), hal.Next());
+    EXPECT_EQ(Level(PERF_LOCK_GPU_MIN, 2), hal.Next());
+
+    ASSERT_EQ(0, client.Release(second));
+    EXPECT_EQ(Level(PERF_LOCK_CPU_BIG_MIN, 1), hal.Next());
+    EXPECT_EQ(Level(PERF_LOCK_GPU_MIN, 0), hal.Next());
+
+    ASSERT_EQ(0, client.Release(first));
+    EXPECT_EQ(Level(PERF_LOCK_CPU_BIG_MIN, 0), hal.Next());
+    EXPECT_EQ(-1, client.Release(first));
+    EXPECT_TRUE(hal.Idle(100));
+}
+
+TEST(PerfLockClientTest, TimedLockExpires) {
+    FakeHal hal;
+    PerfLockClient client(hal.Path());
+
+    int args[] = {kCpuMinFreq, 1200};
+    ASSERT_GT(client.Acquire(0, 50, args, 2), 0);
+    EXPECT_EQ(Level(PERF_LOCK_CPU_BIG_MIN, 1), hal.Next());
+    EXPECT_EQ(Level(PERF_LOCK_CPU_BIG_MIN, 0), hal.Next());
+}
+
+TEST(PerfLockClientTest, ResendsAfterHalRestart) {
+    FakeHal hal;
+    PerfLockClient client(hal.Path());
+
+    int args[] = {kCpuMinFreq, 1400};
+    ASSERT_GT(client.Acquire(0, 0, args, 2), 0);
+    EXPECT_EQ(Level(PERF_LOCK_CPU_BIG_MIN, 2), hal.Next());
+
+    // The client connects again once the HAL is back, and the new HAL
+    // learns the level without the lock changing.
+    hal.Die();
+    usleep(100000);
+    hal.Listen();
+    EXPECT_EQ(Level(PERF_LOCK_CPU_BIG_MIN, 2), hal.Next());
+}
+
+// Threads take, replace and drop locks, some of them timed, while the client
+// thread expires them and sends the levels. No untimed lock may go missing,
+// and once everything is released the HAL must hold nothing.
+TEST(PerfLockClientTest, ConcurrentLocks) {
+    FakeHal hal;
+    PerfLockClient client(hal.Path());
+    std::atomic<int> errors(0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&, t] {
+            int args[] = {kCpuMinFreq, 1200 + 400 * (t % 4), kGpuMinFreq, 300 + 100 * (t % 3)};
+            for (int i = 0; i < 2000; i++) {
+                int durationMs = i % 3 ? 1 + i % 7 : 0;
+                int handle = client.Acquire(0, durationMs, args, 4);
+                if (handle <= 0) {
+                    errors++;
+                    continue;
+                }
+                if (i % 2 && client.Acquire(handle, 0, args, 2) != handle) {
+                    // Only a timed lock may expire before it is replaced
+                    if (durationMs == 0)
+                        errors++;
+                    continue;
+                }
+                if (client.Release(handle) != 0 && (durationMs == 0 || i % 2))
+                    errors++;
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    EXPECT_EQ(0, errors);
+
+    std::map<uint32_t, int32_t> last;
+    PerfLockLevel message;
+    while (hal.Receive(&message, 500))
+        last[message.resource] = message.level;
+    EXPECT_FALSE(last.empty());
+    for (const auto &resource : last)
+        EXPECT_EQ(0, resource.second) << kPerfLockResourceNames[resource.first];
+}
+
+}  // namespace
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "PerfLockRequest.h"
+
+namespace {
+
+// 0x40000000 | major << 22 | minor << 14 | cluster << 8 | core
+constexpr uint32_t Opcode(uint32_t major, uint32_t minor, uint32_t cluster = 0) {
+    return 0x40000000 | major << 22 | minor << 14 | cluster << 8;
+}
+
+constexpr uint32_t kCpuMinFreq = Opcode(2, 0);
+constexpr uint32_t kCpuMinFreqLittle = Opcode(2, 0, 1);
+constexpr uint32_t kCpuMaxFreq = Opcode(2, 1);
+constexpr uint32_t kSchedBoost = Opcode(3, 0);
+constexpr uint32_t kCpuBwMinFreq = Opcode(6, 0);
+constexpr uint32_t kGpuPowerLevel = Opcode(10, 0);
+constexpr uint32_t kGpuMinFreq = Opcode(10, 3);
+
+struct Decoded {
+    bool ok;
+    PerfLockResource resource;
+    int level;
+};
+
+Decoded Decode(uint32_t opcode, int32_t value) {
+    Decoded d = {false, PERF_LOCK_RESOURCE_COUNT, -1};
+    d.ok = DecodePerfLockRequest(opcode, value, &d.resource, &d.level);
+    return d;
+}
+
+TEST(PerfLockRequestTest, CpuMinFreqPerCluster) {
+    // Values in MHz, levels from the floors in kHz
+    Decoded d = Decode(kCpuMinFreq, 1200);
+    ASSERT_TRUE(d.ok);
+    EXPECT_EQ(PERF_LOCK_CPU_BIG_MIN, d.resource);
+    EXPECT_EQ(1, d.level);
+    EXPECT_EQ(2, Decode(kCpuMinFreq, 1400).level);
+    EXPECT_EQ(3, Decode(kCpuMinFreq, 2800).level);
+    EXPECT_EQ(0, Decode(kCpuMinFreq, 0).level);
+
+    d = Decode(kCpuMinFreqLittle, 1400);
+    ASSERT_TRUE(d.ok);
+    EXPECT_EQ(PERF_LOCK_CPU_LITTLE_MIN, d.resource);
+    EXPECT_EQ(2, d.level);
+}
+
+TEST(PerfLockRequestTest, SchedBoostStrength) {
+    // 1 is the strongest boost
+    EXPECT_EQ(3, Decode(kSchedBoost, 1).level);
+    EXPECT_EQ(1, Decode(kSchedBoost, 3).level);
+    EXPECT_EQ(0, Decode(kSchedBoost, 0).level);
+    EXPECT_EQ(PERF_LOCK_SCHED_BOOST, Decode(kSchedBoost, 1).resource);
+}
+
+TEST(PerfLockRequestTest, CpuBwMinFreq) {
+    Decoded d = Decode(kCpuBwMinFreq, 4577);
+    ASSERT_TRUE(d.ok);
+    EXPECT_EQ(PERF_LOCK_CPUBW_MIN, d.resource);
+    EXPECT_EQ(1, d.level);
+    EXPECT_EQ(3, Decode(kCpuBwMinFreq, 7000).level);
+}
+
+TEST(PerfLockRequestTest, GpuFreqAndPowerLevel) {
+    Decoded d = Decode(kGpuMinFreq, 500);
+    ASSERT_TRUE(d.ok);
+    EXPECT_EQ(PERF_LOCK_GPU_MIN, d.resource);
+    EXPECT_EQ(2, d.level);
+
+    // Power level 0 is the fastest, 710 MHz
+    EXPECT_EQ(3, Decode(kGpuPowerLevel, 0).level);
+    EXPECT_EQ(1, Decode(kGpuPowerLevel, 6).level);
+    EXPECT_FALSE(Decode(kGpuPowerLevel, 7).ok);
+    EXPECT_FALSE(Decode(kGpuPowerLevel, -1).ok);
+}
+
+TEST(PerfLockRequestTest, UnsupportedRequests) {
+    EXPECT_FALSE(Decode(kCpuMaxFreq, 1000).ok);
+    EXPECT_FALSE(Decode(Opcode(9, 0), 1).ok);
+    // Legacy v1 opcodes
+    EXPECT_FALSE(Decode(0x1c00, 0).ok);
+}
+
+}  // namespace
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "PerfLockTable.h"
+
+namespace {
+
+using Levels = std::vector<int>;
+
+TEST(PerfLockTableTest, StaleHandlesDoNotMatch) {
+    PerfLockTable table;
+    int levels[PERF_LOCK_RESOURCE_COUNT] = {1};
+
+    int first = table.Add(levels);
+    ASSERT_GT(first, 0);
+    table.Remove(table.Find(first));
+    // The slot is reused, the handle is not
+    int second = table.Add(levels);
+    ASSERT_GT(second, 0);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(-1, table.Find(first));
+    EXPECT_GE(table.Find(second), 0);
+}
+
+TEST(PerfLockTableTest, FullTable) {
+    PerfLockTable table;
+    int levels[PERF_LOCK_RESOURCE_COUNT] = {};
+
+    for (size_t i = 0; i < PerfLockTable::kCapacity; i++)
+        ASSERT_GT(table.Add(levels), 0);
+    EXPECT_EQ(PerfLockTable::kCapacity, table.Size());
+    EXPECT_EQ(-1, table.Add(levels));
+}
+
+// Random adds, replaces and removes against a map of the levels each held
+// handle wants.
+TEST(PerfLockTableTest, MatchesReferenceModel) {
+    std::mt19937_64 rng(1);
+    PerfLockTable table;
+    std::map<int, Levels> model;
+
+    for (int i = 0; i < 100000; i++) {
+        int levels[PERF_LOCK_RESOURCE_COUNT];
+        for (auto &level : levels)
+            level = rng() % (kPerfLockLevelCount + 1);
+
+        int op = rng() % 3;
+        if (op == 0 && model.size() < PerfLockTable::kCapacity) {
+            int handle = table.Add(levels);
+            ASSERT_GT(handle, 0);
+            ASSERT_EQ(0u, model.count(handle)) << "handle " << handle << " handed out twice";
+            model[handle] = Levels(std::begin(levels), std::end(levels));
+        } else if (!model.empty()) {
+            auto it = model.begin();
+            std::advance(it, rng() % model.size());
+            int slot = table.Find(it->first);
+            ASSERT_GE(slot, 0);
+            if (op == 1) {
+                table.Replace(slot, levels);
+                it->second = Levels(std::begin(levels), std::end(levels));
+            } else {
+                table.Remove(slot);
+                ASSERT_EQ(-1, table.Find(it->first));
+                model.erase(it);
+            }
+        }
+
+        ASSERT_EQ(model.size(), table.Size());
+        for (int r = 0; r < PERF_LOCK_RESOURCE_COUNT; r++) {
+            int expected = 0;
+            for (const auto &lock : model)
+                expected = std::max(expected, lock.second[r]);
+            ASSERT_EQ(expected, table.Level(static_cast<PerfLockResource>(r)))
+                    << "resource " << r << " at step " << i;
+        }
+    }
+}
+
+}  // namespace
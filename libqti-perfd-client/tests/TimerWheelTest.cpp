@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include "TimerWheel.h"
+
+namespace {
+
+constexpr size_t kTimers = 256;
+constexpr int64_t kTickNs = 10;
+
+TEST(TimerWheelTest, FiresOnTheTickAfterExpiry) {
+    TimerWheel wheel(kTimers, kTickNs, 0);
+    std::set<size_t> fired;
+    auto collect = [&](size_t id) { fired.insert(id); };
+
+    wheel.Schedule(1, 25);
+    wheel.Schedule(2, 30);
+    EXPECT_EQ(30, wheel.NextWakeNs());
+    wheel.Advance(29, collect);
+    EXPECT_TRUE(fired.empty());
+    wheel.Advance(30, collect);
+    EXPECT_EQ(std::set<size_t>({1, 2}), fired);
+    EXPECT_TRUE(wheel.Empty());
+    EXPECT_EQ(INT64_MAX, wheel.NextWakeNs());
+}
+
+TEST(TimerWheelTest, ScheduleReplacesAndCancelRemoves) {
+    TimerWheel wheel(kTimers, kTickNs, 0);
+    std::set<size_t> fired;
+    auto collect = [&](size_t id) { fired.insert(id); };
+
+    wheel.Schedule(1, 100);
+    wheel.Schedule(1, 1000000);
+    wheel.Schedule(2, 100);
+    wheel.Cancel(2);
+    wheel.Advance(100, collect);
+    EXPECT_TRUE(fired.empty());
+    EXPECT_FALSE(wheel.Empty());
+    // Far timers cascade down the levels before they fire
+    wheel.Advance(999999, collect);
+    EXPECT_TRUE(fired.empty());
+    wheel.Advance(1000000, collect);
+    EXPECT_EQ(std::set<size_t>({1}), fired);
+}
+
+// Random schedules, cancels and advances against a map of expiry ticks.
+TEST(TimerWheelTest, MatchesReferenceModel) {
+    std::mt19937_64 rng(1);
+    int64_t now = 12345;
+    TimerWheel wheel(kTimers, kTickNs, now);
+    // id -> tick it fires on
+    std::map<size_t, int64_t> model;
+    // The last tick Advance() ran; a timer never fires on a tick before it
+    int64_t lastTick = now / kTickNs - 1;
+    size_t fired = 0;
+
+    for (int i = 0; i < 200000; i++) {
+        int op = rng() % 10;
+        size_t id = rng() % kTimers;
+        if (op < 4) {
+            // Mostly near timers, some far enough for the upper levels
+            int64_t delay = rng() % 4 == 0 ? rng() % 40000000 : rng() % 5000;
+            wheel.Schedule(id, now + delay);
+            model[id] = std::max((now + delay + kTickNs - 1) / kTickNs, lastTick + 1);
+        } else if (op < 5) {
+            wheel.Cancel(id);
+            model.erase(id);
+        } else {
+            int64_t next = wheel.NextWakeNs();
+            if (rng() % 3 == 0 && next != INT64_MAX)
+                now = std::max(next, now);
+            else
+                now += rng() % 3000;
+            lastTick = std::max(lastTick, now / kTickNs);
+
+            std::set<size_t> expected;
+            for (const auto &timer : model) {
+                if (timer.second <= lastTick)
+                    expected.insert(timer.first);
+            }
+            std::set<size_t> got;
+            wheel.Advance(now, [&](size_t id) { got.insert(id); });
+            ASSERT_EQ(expected, got) << "at step " << i;
+            for (size_t id : got)
+                model.erase(id);
+            fired += got.size();
+
+            int64_t earliest = INT64_MAX;
+            for (const auto &timer : model)
+                earliest = std::min(earliest, timer.second * kTickNs);
+            ASSERT_LE(wheel.NextWakeNs(), earliest) << "late wake at step " << i;
+        }
+        ASSERT_EQ(model.empty(), wheel.Empty());
+    }
+    EXPECT_GT(fired, 0u);
+}
+
+}  // namespace
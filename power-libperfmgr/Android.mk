@@ -10,7 +10,20 @@ LOCAL_MODULE_RELATIVE_PATH := hw
 LOCAL_SRC_FILES := \
     service.cpp \
     Power.cpp \
+    EnergyModel.cpp \
+    GovernorMonitor.cpp \
+    HintArbiter.cpp \
+    HintJournal.cpp \
+    HintMetrics.cpp \
+    HintSession.cpp \
+    HintTrace.cpp \
     InteractionHandler.cpp \
+    LaunchProfiler.cpp \
+    PerfLockServer.cpp \
+    PowerHintTable.cpp \
+    StatsSampler.cpp \
+    SustainedPerfController.cpp \
+    node-cache.c \
     power-helper.c
 
 LOCAL_SHARED_LIBRARIES := \
@@ -19,6 +32,7 @@ LOCAL_SHARED_LIBRARIES := \
     liblog \
     libutils \
     libcutils \
+    libjsoncpp \
     android.hardware.power@1.0 \
     android.hardware.power@1.1 \
     android.hardware.power@1.2 \
@@ -26,7 +40,8 @@ LOCAL_SHARED_LIBRARIES := \
     libperfmgr
 
 LOCAL_HEADER_LIBRARIES := \
-    libhardware_headers
+    libhardware_headers \
+    libqti-perfd-client_headers
 
 LOCAL_CFLAGS := -Wall -Werror
 
@@ -34,6 +49,11 @@ ifneq ($(TARGET_TAP_TO_WAKE_NODE),)
     LOCAL_CFLAGS += -DTAP_TO_WAKE_NODE=\"$(TARGET_TAP_TO_WAKE_NODE)\"
 endif
 
+# Hint session commands through debug(), see HintSession.h
+ifneq ($(filter eng userdebug,$(TARGET_BUILD_VARIANT)),)
+    LOCAL_CFLAGS += -DPOWERHAL_SESSION_COMMANDS
+endif
+
 include $(BUILD_EXECUTABLE)
 
 include $(call all-makefiles-under,$(LOCAL_PATH))
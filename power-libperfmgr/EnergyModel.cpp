@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//#define LOG_NDEBUG 0
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+#define ATRACE_TAG (ATRACE_TAG_POWER | ATRACE_TAG_HAL)
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include "EnergyModel.h"
+#include "HintMetrics.h"
+
+#define NSINMS 1000000LL
+#define MSINHOUR 3600000.0
+
+// time_in_state counts in clock ticks
+static constexpr uint64_t kMsPerTick = 10;
+// Intervals listed by a dump, newest last
+static constexpr size_t kDumpIntervals = 8;
+
+double PowerCurve::At(uint64_t freq) const {
+    if (points.empty())
+        return 0;
+    if (freq <= points.front().first)
+        return points.front().second;
+    if (freq >= points.back().first)
+        return points.back().second;
+
+    auto hi = std::lower_bound(points.begin(), points.end(), freq,
+                               [](const std::pair<uint64_t, double> &p, uint64_t f) {
+                                   return p.first < f;
+                               });
+    auto lo = hi - 1;
+    double t = static_cast<double>(freq - lo->first) / (hi->first - lo->first);
+    return lo->second + t * (hi->second - lo->second);
+}
+
+// Rough SDM845 figures at full load, per cluster rather than per core.
+EnergyModel::Config EnergyModel::DefaultConfig() {
+    Config config;
+    config.clusters = {
+        {"little", "/sys/devices/system/cpu/cpu0/cpufreq/stats/time_in_state",
+         {{{300000, 40}, {748800, 80}, {1132800, 140}, {1516800, 240}, {1766400, 340}}}},
+        {"big", "/sys/devices/system/cpu/cpu4/cpufreq/stats/time_in_state",
+         {{{825600, 250}, {1286400, 450}, {1804800, 850}, {2323200, 1500}, {2803200, 2400}}}},
+    };
+    config.gpuTransStatPath = "/sys/class/kgsl/kgsl-3d0/devfreq/trans_stat";
+    config.gpuBusyPath = "/sys/class/kgsl/kgsl-3d0/gpubusy";
+    config.gpuCurve = {{{257000000, 300}, {342000000, 400}, {414000000, 520},
+                        {520000000, 700}, {596000000, 900}, {710000000, 1300}}};
+    config.gpuIdleMw = 30;
+    // APSS is left out, the CPU clusters account for it.
+    config.masters = {{"MPSS", 60}, {"ADSP", 15}, {"CDSP", 30}, {"SLPI", 8}};
+    return config;
+}
+
+EnergyModel::EnergyModel(Config config)
+    : mConfig(std::move(config)), mPrimed(false), mCount(0), mTotalMs(0) {
+    for (const auto &cluster : mConfig.clusters)
+        mSubsystems.push_back(cluster.name);
+    mSubsystems.push_back("GPU");
+    for (const auto &master : mConfig.masters)
+        mSubsystems.push_back(master.first);
+    mTotalMwh.assign(mSubsystems.size(), 0);
+}
+
+// "<freq> <ticks>" per line
+static void ReadTimeInState(const std::string &path, std::map<uint64_t, uint64_t> *ms) {
+    std::string content;
+    if (!android::base::ReadFileToString(path, &content))
+        return;
+    for (const auto &line : android::base::Split(content, "\n")) {
+        std::vector<std::string> fields = android::base::Split(line, " ");
+        uint64_t freq, ticks;
+        if (fields.size() == 2 && android::base::ParseUint(fields[0], &freq) &&
+            android::base::ParseUint(fields[1], &ticks))
+            (*ms)[freq] = ticks * kMsPerTick;
+    }
+}
+
+// devfreq lists one row per frequency, "[*]<freq>: <transitions...> <time ms>"
+static void ReadTransStat(const std::string &path, std::map<uint64_t, uint64_t> *ms) {
+    std::string content;
+    if (!android::base::ReadFileToString(path, &content))
+        return;
+    for (const auto &line : android::base::Split(content, "\n")) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+        std::string freqField = android::base::Trim(line.substr(0, colon));
+        if (!freqField.empty() && freqField[0] == '*')
+            freqField.erase(0, 1);
+        std::vector<std::string> fields =
+                android::base::Split(android::base::Trim(line.substr(colon + 1)), " ");
+        uint64_t freq, time;
+        if (android::base::ParseUint(freqField, &freq) &&
+            android::base::ParseUint(fields.back(), &time))
+            (*ms)[freq] = time;
+    }
+}
+
+// kgsl keeps busy and total time of its last sampling window only.
+double EnergyModel::ReadGpuBusy() const {
+    std::string content;
+    if (!android::base::ReadFileToString(mConfig.gpuBusyPath, &content))
+        return 1.0;
+    char *end;
+    double busy = strtod(content.c_str(), &end);
+    double total = strtod(end, nullptr);
+    return total > 0 ? std::clamp(busy / total, 0.0, 1.0) : 0.0;
+}
+
+void EnergyModel::Read(const StatsSnapshot &snapshot, Reading *reading) const {
+    reading->clusterMs.resize(mConfig.clusters.size());
+    for (size_t i = 0; i < mConfig.clusters.size(); i++)
+        ReadTimeInState(mConfig.clusters[i].timeInStatePath, &reading->clusterMs[i]);
+    ReadTransStat(mConfig.gpuTransStatPath, &reading->gpuMs);
+    for (const auto &hint : HintMetrics::Get().GetTimeInStateMs())
+        reading->hintMs[hint.first] = hint.second;
+    reading->stats = snapshot;
+}
+
+static double Energy(const std::map<uint64_t, uint64_t> &prev,
+                     const std::map<uint64_t, uint64_t> &cur, const PowerCurve &curve,
+                     double busy, double idleMw) {
+    double mwh = 0;
+    for (const auto &entry : cur) {
+        auto it = prev.find(entry.first);
+        uint64_t before = it != prev.end() ? it->second : 0;
+        if (entry.second <= before)
+            continue;
+        double mw = idleMw + busy * (curve.At(entry.first) - idleMw);
+        mwh += mw * (entry.second - before) / MSINHOUR;
+    }
+    return mwh;
+}
+
+EnergyModel::Interval EnergyModel::Diff(const Reading &prev, const Reading &cur,
+                                        double gpuBusy) const {
+    Interval interval;
+    interval.durationMs = (cur.stats.timestampNs - prev.stats.timestampNs) / NSINMS;
+
+    for (size_t i = 0; i < mConfig.clusters.size(); i++) {
+        interval.mwh.push_back(Energy(prev.clusterMs[i], cur.clusterMs[i],
+                                      mConfig.clusters[i].curve, 1.0, 0));
+    }
+    interval.mwh.push_back(Energy(prev.gpuMs, cur.gpuMs, mConfig.gpuCurve, gpuBusy,
+                                  mConfig.gpuIdleMw));
+
+    for (const auto &master : mConfig.masters) {
+        double mwh = 0;
+        for (size_t m = 0; m < cur.stats.masterCount; m++) {
+            if (!cur.stats.masterValid || !prev.stats.masterValid ||
+                prev.stats.masterCount != cur.stats.masterCount ||
+                master.first != get_master_label(m))
+                continue;
+            const uint64_t *c = &cur.stats.master[m * MASTER_STATS_COUNT];
+            const uint64_t *p = &prev.stats.master[m * MASTER_STATS_COUNT];
+            int64_t sleepMs = (c[SLEEP_CUMULATIVE_DURATION_MS] -
+                               p[SLEEP_CUMULATIVE_DURATION_MS]) / RPM_CLK;
+            int64_t awakeMs = std::clamp<int64_t>(interval.durationMs - sleepMs, 0,
+                                                  interval.durationMs);
+            mwh = master.second * awakeMs / MSINHOUR;
+        }
+        interval.mwh.push_back(mwh);
+    }
+
+    for (const auto &hint : cur.hintMs) {
+        auto it = prev.hintMs.find(hint.first);
+        int64_t ms = hint.second - (it != prev.hintMs.end() ? it->second : 0);
+        if (ms > 0)
+            interval.hintMs.emplace_back(hint.first, ms);
+    }
+    return interval;
+}
+
+void EnergyModel::OnSample(const StatsSnapshot &snapshot) {
+    ATRACE_CALL();
+
+    Reading cur;
+    Read(snapshot, &cur);
+    if (!mPrimed) {
+        mPrev = std::move(cur);
+        mPrimed = true;
+        return;
+    }
+
+    Interval interval = Diff(mPrev, cur, ReadGpuBusy());
+    mPrev = std::move(cur);
+
+    std::lock_guard<std::mutex> lk(mLock);
+    mTotalMs += interval.durationMs;
+    for (size_t i = 0; i < mSubsystems.size(); i++)
+        mTotalMwh[i] += interval.mwh[i];
+    mHistory[mCount % kHistorySize] = std::move(interval);
+    mCount++;
+}
+
+void EnergyModel::DumpToFd(int fd) const {
+    // Copy out so formatting does not hold up the sampler
+    std::unique_lock<std::mutex> lk(mLock);
+    uint64_t count = mCount;
+    int64_t totalMs = mTotalMs;
+    std::vector<double> totalMwh = mTotalMwh;
+    std::vector<Interval> recent;
+    for (uint64_t i = count > kDumpIntervals ? count - kDumpIntervals : 0; i < count; i++)
+        recent.push_back(mHistory[i % kHistorySize]);
+    lk.unlock();
+
+    std::string buf(android::base::StringPrintf("EnergyModel: %" PRIu64 " intervals, %" PRId64
+                                                " ms\n  Total:",
+                                                count, totalMs));
+    for (size_t i = 0; i < mSubsystems.size(); i++) {
+        android::base::StringAppendF(&buf, " %s %.3f mWh", mSubsystems[i].c_str(),
+                                     totalMwh[i]);
+    }
+    buf += "\n";
+
+    for (const auto &interval : recent) {
+        android::base::StringAppendF(&buf, "  +%" PRId64 " ms:", interval.durationMs);
+        for (size_t i = 0; i < mSubsystems.size(); i++) {
+            android::base::StringAppendF(&buf, " %s %.3f", mSubsystems[i].c_str(),
+                                         interval.mwh[i]);
+        }
+        buf += " mWh";
+        for (const auto &hint : interval.hintMs) {
+            android::base::StringAppendF(&buf, ", %s %" PRId64 " ms", hint.first.c_str(),
+                                         hint.second);
+        }
+        buf += "\n";
+    }
+
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump energy model to fd";
+    }
+}
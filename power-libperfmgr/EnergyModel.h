@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ENERGYMODEL_H
+#define ENERGYMODEL_H
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "StatsSampler.h"
+
+// Power drawn at a frequency, interpolated linearly between the points of
+// a table. Frequencies are in the unit of the stats they are matched with.
+struct PowerCurve {
+    std::vector<std::pair<uint64_t, double>> points;  // (freq, mW), ascending
+
+    double At(uint64_t freq) const;
+};
+
+// Estimates the energy used by each subsystem between two StatsSampler
+// snapshots:
+//  - CPU clusters from the time their policy spent at each frequency,
+//  - the GPU from the time its devfreq spent at each frequency, scaled
+//    between idle and full power by how busy kgsl last saw it,
+//  - every RPMh master listed in the config from the time it was awake.
+// Every interval also records how long each hint was in effect during it,
+// so the cost of a hint can be read off the history.
+struct EnergyModel {
+    struct Cluster {
+        std::string name;
+        std::string timeInStatePath;
+        PowerCurve curve;
+    };
+
+    struct Config {
+        std::vector<Cluster> clusters;
+        std::string gpuTransStatPath;
+        std::string gpuBusyPath;
+        PowerCurve gpuCurve;
+        double gpuIdleMw;
+        // RPMh master label -> mW while awake
+        std::map<std::string, double> masters;
+    };
+
+    explicit EnergyModel(Config config);
+
+    // Called with every snapshot, on the sampler thread.
+    void OnSample(const StatsSnapshot &snapshot);
+    void DumpToFd(int fd) const;
+
+    static Config DefaultConfig();
+
+ private:
+    static constexpr size_t kHistorySize = 32;
+
+    struct Interval {
+        int64_t durationMs;
+        std::vector<double> mwh;  // one per subsystem
+        std::vector<std::pair<std::string, int64_t>> hintMs;
+    };
+
+    // Cumulative readings at the previous sample
+    struct Reading {
+        std::vector<std::map<uint64_t, uint64_t>> clusterMs;
+        std::map<uint64_t, uint64_t> gpuMs;
+        std::map<std::string, int64_t> hintMs;
+        StatsSnapshot stats;
+    };
+
+    void Read(const StatsSnapshot &snapshot, Reading *reading) const;
+    Interval Diff(const Reading &prev, const Reading &cur, double gpuBusy) const;
+    double ReadGpuBusy() const;
+
+    const Config mConfig;
+    std::vector<std::string> mSubsystems;
+
+    // Only touched by the sampler thread
+    bool mPrimed;
+    Reading mPrev;
+
+    // Guards the history and totals below
+    mutable std::mutex mLock;
+    Interval mHistory[kHistorySize];
+    uint64_t mCount;
+    int64_t mTotalMs;
+    std::vector<double> mTotalMwh;
+};
+
+#endif //ENERGYMODEL_H
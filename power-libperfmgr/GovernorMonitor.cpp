@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//#define LOG_NDEBUG 0
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+
+#include <limits.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+#include <utils/Log.h>
+
+#include "GovernorMonitor.h"
+
+#define GOVERNOR_PATH "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor"
+
+// Fallback re-read period, in case a governor change is not reported
+static constexpr int kPollPeriodMs = 10000;
+
+static bool IsSupportedGovernor(const std::string &governor) {
+    // Only support EAS 1.2, legacy EAS
+    return governor == "schedutil" || governor == "sched";
+}
+
+GovernorMonitor::GovernorMonitor(std::vector<int> const & policy_cpus)
+    : mPolicyCpus(policy_cpus),
+      mSupported(false),
+      mRefreshed(false),
+      mInotifyFd(-1),
+      mEventFd(-1) {
+}
+
+GovernorMonitor::~GovernorMonitor() {
+    Exit();
+}
+
+bool GovernorMonitor::Init() {
+    Refresh();
+
+    mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mInotifyFd < 0) {
+        ALOGE("Unable to create inotify fd (%d)", errno);
+        return false;
+    }
+
+    for (int cpu : mPolicyCpus) {
+        std::string path = android::base::StringPrintf(GOVERNOR_PATH, cpu);
+        if (inotify_add_watch(mInotifyFd, path.c_str(), IN_MODIFY) < 0) {
+            ALOGW("Unable to watch %s (%d), relying on polling", path.c_str(), errno);
+        }
+    }
+
+    mEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mEventFd < 0) {
+        ALOGE("Unable to create event fd (%d)", errno);
+        close(mInotifyFd);
+        mInotifyFd = -1;
+        return false;
+    }
+
+    mThread = std::make_unique<std::thread>(&GovernorMonitor::Routine, this);
+
+    return true;
+}
+
+void GovernorMonitor::Exit() {
+    if (!mThread)
+        return;
+
+    uint64_t val = 1;
+    ssize_t ret = write(mEventFd, &val, sizeof(val));
+    if (ret != sizeof(val))
+        ALOGW("Unable to write to event fd (%zd)", ret);
+    mThread->join();
+    mThread.reset();
+
+    close(mEventFd);
+    close(mInotifyFd);
+}
+
+void GovernorMonitor::Refresh() {
+    std::map<int, std::string> read;
+    for (int cpu : mPolicyCpus) {
+        std::string buf;
+        if (android::base::ReadFileToString(android::base::StringPrintf(GOVERNOR_PATH, cpu),
+                                            &buf)) {
+            read[cpu] = android::base::Trim(buf);
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(mLock);
+    // A policy that cannot be read, e.g. while its cpus are offline, keeps
+    // the governor it last had. One that never could does not count.
+    for (auto &entry : read) {
+        mGovernors[entry.first] = std::move(entry.second);
+    }
+    bool supported = !mGovernors.empty();
+    for (const auto &entry : mGovernors) {
+        supported = supported && IsSupportedGovernor(entry.second);
+    }
+
+    if (supported != mSupported.load(std::memory_order_relaxed) || !mRefreshed) {
+        if (supported) {
+            ALOGI("Governor supported by powerHAL, taking hints");
+        } else {
+            LOG(ERROR) << "Governor not supported by powerHAL, skipping";
+        }
+    }
+    mSupported.store(supported, std::memory_order_relaxed);
+    mRefreshed = true;
+}
+
+void GovernorMonitor::Routine() {
+    struct pollfd pfd[2];
+    char events[sizeof(struct inotify_event) + NAME_MAX + 1];
+
+    pfd[0].fd = mEventFd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = mInotifyFd;
+    pfd[1].events = POLLIN;
+
+    while (true) {
+        int ret = poll(pfd, 2, kPollPeriodMs);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            ALOGE("%s: error in poll (%d)", __func__, errno);
+            return;
+        }
+        if (ret > 0 && pfd[0].revents)
+            return;
+        if (ret > 0 && pfd[1].revents) {
+            // Drain pending events, one refresh covers all of them
+            while (read(mInotifyFd, events, sizeof(events)) > 0) {
+            }
+        }
+        Refresh();
+    }
+}
+
+std::map<int, std::string> GovernorMonitor::GetGovernors() const {
+    std::lock_guard<std::mutex> lk(mLock);
+    return mGovernors;
+}
+
+void GovernorMonitor::DumpToFd(int fd) const {
+    std::string buf("Governors:\n");
+    for (const auto &entry : GetGovernors()) {
+        buf += android::base::StringPrintf("  policy%d: %s\n", entry.first,
+                                           entry.second.c_str());
+    }
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump governors to fd";
+    }
+}
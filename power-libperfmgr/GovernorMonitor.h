@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GOVERNORMONITOR_H
+#define GOVERNORMONITOR_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Caches scaling_governor of each cpufreq policy so the hint path does not
+// have to read sysfs. The cache is refreshed by a background thread on
+// inotify events, with a slow periodic re-read as a fallback.
+struct GovernorMonitor {
+    GovernorMonitor(std::vector<int> const & policy_cpus);
+    ~GovernorMonitor();
+    bool Init();
+    void Exit();
+
+    // True if every policy runs a governor the power HAL supports. A policy
+    // that cannot be read counts with the governor it was last read with.
+    bool IsSupported() const { return mSupported.load(std::memory_order_relaxed); }
+    std::map<int, std::string> GetGovernors() const;
+    void DumpToFd(int fd) const;
+
+ private:
+    void Refresh();
+    void Routine();
+
+    const std::vector<int> mPolicyCpus;
+    std::map<int, std::string> mGovernors;
+    std::atomic<bool> mSupported;
+    bool mRefreshed;
+
+    int mInotifyFd;
+    int mEventFd;
+
+    std::unique_ptr<std::thread> mThread;
+    mutable std::mutex mLock;
+};
+
+#endif //GOVERNORMONITOR_H
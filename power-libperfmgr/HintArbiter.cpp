@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//#define LOG_NDEBUG 0
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+#define ATRACE_TAG (ATRACE_TAG_POWER | ATRACE_TAG_HAL)
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <json/reader.h>
+#include <json/value.h>
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include "HintArbiter.h"
+#include "HintMetrics.h"
+
+HintArbiter::HintArbiter(std::shared_ptr<HintManager> const & hint_manager,
+                         std::vector<HintPriority> priorities)
+    : mHintManager(hint_manager),
+      mPriorities(std::move(priorities)),
+      mHintCount(0),
+      mRequestedMask(0),
+      mAppliedMask(0),
+      mFloor(INT_MIN) {
+    std::lock_guard<std::mutex> lk(mLock);
+    for (const auto &p : mPriorities)
+        InternLocked(p.name);
+}
+
+// should be called while locked
+int HintArbiter::InternLocked(const std::string &hint) {
+    int index = Find(hint);
+    if (index >= 0)
+        return index;
+
+    size_t count = mHintCount.load(std::memory_order_relaxed);
+    if (count == kMaxHints) {
+        ALOGE("%s: too many hints, not publishing %s", __func__, hint.c_str());
+        return -1;
+    }
+    mHints[count] = hint;
+    mHintCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+int HintArbiter::Find(const std::string &hint) const {
+    size_t count = mHintCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        if (mHints[i] == hint)
+            return i;
+    }
+    return -1;
+}
+
+// should be called while locked
+uint64_t HintArbiter::MaskOfLocked(const std::set<std::string> &hints) {
+    uint64_t mask = 0;
+    for (const auto &hint : hints) {
+        int index = InternLocked(hint);
+        if (index >= 0)
+            mask |= 1ULL << index;
+    }
+    return mask;
+}
+
+static const HintPriority *FindPriority(const std::vector<HintPriority> &priorities,
+                                        const std::string &hint) {
+    for (const auto &p : priorities) {
+        if (p.name == hint)
+            return &p;
+    }
+    return nullptr;
+}
+
+std::set<std::string> HintArbiter::Resolve(const std::vector<HintPriority> &priorities,
+                                           const std::set<std::string> &requested,
+                                           int *floor) {
+    std::set<std::string> applied;
+    std::set<std::string> consumed;
+
+    // Composites replace their components, highest priority first.
+    std::vector<const HintPriority *> composites;
+    for (const auto &p : priorities) {
+        if (!p.components.empty())
+            composites.push_back(&p);
+    }
+    std::stable_sort(composites.begin(), composites.end(),
+                     [](const HintPriority *a, const HintPriority *b) {
+                         return a->priority > b->priority;
+                     });
+    for (const HintPriority *p : composites) {
+        bool complete = std::all_of(p->components.begin(), p->components.end(),
+                                    [&](const std::string &c) {
+                                        return requested.count(c) && !consumed.count(c);
+                                    });
+        if (complete) {
+            applied.insert(p->name);
+            consumed.insert(p->components.begin(), p->components.end());
+        }
+    }
+
+    std::vector<std::string> candidates;
+    for (const auto &hint : requested) {
+        if (!consumed.count(hint))
+            candidates.push_back(hint);
+    }
+
+    // The highest priority exclusive hint sets the floor for all others.
+    int f = INT_MIN;
+    for (const auto &hint : applied) {
+        const HintPriority *p = FindPriority(priorities, hint);
+        if (p->exclusive)
+            f = std::max(f, p->priority);
+    }
+    for (const auto &hint : candidates) {
+        const HintPriority *p = FindPriority(priorities, hint);
+        if (p && p->exclusive)
+            f = std::max(f, p->priority);
+    }
+
+    for (const auto &hint : candidates) {
+        const HintPriority *p = FindPriority(priorities, hint);
+        if (!p || p->priority >= f)
+            applied.insert(hint);
+    }
+
+    if (floor)
+        *floor = f;
+    return applied;
+}
+
+// libperfmgr ends timed hints by itself; drop their requests to match.
+// Returns true if any request timed out.
+// should be called while locked
+bool HintArbiter::ExpireLocked(Clock::time_point now) {
+    bool expired = false;
+    for (auto it = mExpiries.begin(); it != mExpiries.end();) {
+        if (it->second > now) {
+            ++it;
+            continue;
+        }
+        ALOGV("%s: %s timed out", __func__, it->first.c_str());
+        mRequested.erase(it->first);
+        it = mExpiries.erase(it);
+        expired = true;
+    }
+    return expired;
+}
+
+void HintArbiter::ApplyLocked(Clock::time_point now) {
+    ATRACE_CALL();
+
+    int floor;
+    std::set<std::string> applied = Resolve(mPriorities, mRequested, &floor);
+
+    // Start new hints before ending old ones so shared nodes go straight to
+    // their new value instead of dropping back to default in between.
+    for (const auto &hint : applied) {
+        if (mApplied.count(hint))
+            continue;
+        ALOGV("%s: do hint %s", __func__, hint.c_str());
+        // A hint held back only gets what is left of its timeout
+        auto expiry = mExpiries.find(hint);
+        bool ok = expiry != mExpiries.end()
+                          ? HintMetrics::DoHint(*mHintManager, hint,
+                                                std::chrono::ceil<std::chrono::milliseconds>(
+                                                        expiry->second - now))
+                          : HintMetrics::DoHint(*mHintManager, hint);
+        if (!ok)
+            ALOGE("%s: do hint %s failed", __func__, hint.c_str());
+        if (mListener)
+            mListener(hint, true);
+    }
+    for (const auto &hint : mApplied) {
+        if (applied.count(hint))
+            continue;
+        ALOGV("%s: end hint %s", __func__, hint.c_str());
+        if (!HintMetrics::EndHint(*mHintManager, hint))
+            ALOGE("%s: end hint %s failed", __func__, hint.c_str());
+        if (mListener)
+            mListener(hint, false);
+    }
+
+    mApplied = std::move(applied);
+    mRequestedMask.store(MaskOfLocked(mRequested), std::memory_order_release);
+    mAppliedMask.store(MaskOfLocked(mApplied), std::memory_order_release);
+    mFloor.store(floor, std::memory_order_release);
+}
+
+bool HintArbiter::Request(const std::string &hint, std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> lk(mLock);
+    Clock::time_point now = Clock::now();
+    if (ExpireLocked(now))
+        ApplyLocked(now);
+
+    bool timed = mExpiries.erase(hint);
+    if (timeout.count() > 0)
+        mExpiries[hint] = now + timeout;
+    if (mRequested.insert(hint).second) {
+        ApplyLocked(now);
+        return true;
+    }
+
+    // libperfmgr only knows the timeout the hint was applied with: restart
+    // it, or make the hint last until canceled.
+    if ((timed || timeout.count() > 0) && mApplied.count(hint)) {
+        ALOGV("%s: rearm hint %s", __func__, hint.c_str());
+        if (!HintMetrics::DoHint(*mHintManager, hint, timeout))
+            ALOGE("%s: do hint %s failed", __func__, hint.c_str());
+    }
+    return false;
+}
+
+bool HintArbiter::Cancel(const std::string &hint) {
+    std::lock_guard<std::mutex> lk(mLock);
+    Clock::time_point now = Clock::now();
+    bool expired = ExpireLocked(now);
+
+    bool removed = mRequested.erase(hint);
+    mExpiries.erase(hint);
+    if (removed || expired)
+        ApplyLocked(now);
+    return removed;
+}
+
+bool HintArbiter::IsRequested(const std::string &hint) const {
+    int index = Find(hint);
+    return index >= 0 && (mRequestedMask.load(std::memory_order_acquire) >> index) & 1;
+}
+
+bool HintArbiter::IsSuppressed(const std::string &hint) const {
+    const HintPriority *p = FindPriority(mPriorities, hint);
+    return p && p->priority < mFloor.load(std::memory_order_acquire);
+}
+
+void HintArbiter::DumpToFd(int fd) const {
+    uint64_t requested = mRequestedMask.load(std::memory_order_acquire);
+    uint64_t applied = mAppliedMask.load(std::memory_order_acquire);
+    size_t count = mHintCount.load(std::memory_order_acquire);
+    std::string buf("HintArbiter:\n  Requested:");
+    for (size_t i = 0; i < count; i++) {
+        if ((requested >> i) & 1)
+            buf += " " + mHints[i];
+    }
+    buf += "\n  Applied:";
+    for (size_t i = 0; i < count; i++) {
+        if ((applied >> i) & 1)
+            buf += " " + mHints[i];
+    }
+    buf += "\n";
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump arbiter state to fd";
+    }
+}
+
+std::vector<HintPriority> HintArbiter::ParsePriorities(const std::string &json_doc) {
+    std::vector<HintPriority> priorities;
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errorMessage;
+
+    if (!reader->parse(json_doc.c_str(), json_doc.c_str() + json_doc.size(), &root,
+                       &errorMessage)) {
+        LOG(ERROR) << "Failed to parse JSON config: " << errorMessage;
+        return priorities;
+    }
+
+    Json::Value entries = root["Priorities"];
+    for (Json::Value::ArrayIndex i = 0; i < entries.size(); ++i) {
+        HintPriority p;
+        p.name = entries[i]["PowerHint"].asString();
+        if (p.name.empty()) {
+            LOG(ERROR) << "Failed to read Priority[" << i << "]'s PowerHint";
+            priorities.clear();
+            return priorities;
+        }
+        p.priority = entries[i]["Priority"].asInt();
+        p.exclusive = entries[i]["Exclusive"].asBool();
+        Json::Value components = entries[i]["Components"];
+        for (Json::Value::ArrayIndex j = 0; j < components.size(); ++j) {
+            p.components.push_back(components[j].asString());
+        }
+        priorities.push_back(std::move(p));
+    }
+
+    return priorities;
+}
+
+// Matches the transitions Power used to hand-code: VR and sustained
+// performance combine into VR_SUSTAINED_PERFORMANCE and hold back boosts.
+std::vector<HintPriority> HintArbiter::DefaultPriorities() {
+    return {
+        {"VR_SUSTAINED_PERFORMANCE", 3, true, {"VR_MODE", "SUSTAINED_PERFORMANCE"}},
+        {"SUSTAINED_PERFORMANCE", 2, true, {}},
+        {"VR_MODE", 2, true, {}},
+        {"EXPENSIVE_RENDERING", 1, false, {}},
+        {"AUDIO_STREAMING", 1, false, {}},
+        {"LAUNCH", 1, false, {}},
+        {"INTERACTION", 1, false, {}},
+    };
+}
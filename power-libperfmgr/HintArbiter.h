@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef HINTARBITER_H
+#define HINTARBITER_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <perfmgr/HintManager.h>
+
+using ::android::perfmgr::HintManager;
+
+// One entry of the "Priorities" table in powerhint.json.
+//
+// A hint with a non-empty Components list is a composite: it is applied in
+// place of its components once all of them are requested. An exclusive
+// hint holds back every listed hint of lower priority while it is applied;
+// the held back hints stay requested and are applied once it goes away.
+// Hints that are not listed are never held back and never hold back others.
+struct HintPriority {
+    std::string name;
+    int priority;
+    bool exclusive;
+    std::vector<std::string> components;
+};
+
+struct HintArbiter {
+    // Told about every hint the arbiter starts or ends, under its lock.
+    using Listener = std::function<void(const std::string &hint, bool applied)>;
+
+    HintArbiter(std::shared_ptr<HintManager> const & hint_manager,
+                std::vector<HintPriority> priorities);
+
+    // Must be set before the first request.
+    void SetListener(Listener listener) { mListener = std::move(listener); }
+
+    // Request a hint until it is canceled, or with a timeout overriding the
+    // Duration of its actions. A timed request ends on its own once the
+    // timeout passes, held back or not; requesting the hint again restarts
+    // it. Returns true if the request set changed.
+    bool Request(const std::string &hint,
+                 std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+    bool Cancel(const std::string &hint);
+
+    // Queries and dumps read the state published by the last change and
+    // never wait for a request in progress. Timed out requests are dropped
+    // at the next change.
+    bool IsRequested(const std::string &hint) const;
+    // Whether a new request for the hint would be held back right now.
+    bool IsSuppressed(const std::string &hint) const;
+
+    void DumpToFd(int fd) const;
+
+    // Compute the hints to apply for a set of requested hints.
+    static std::set<std::string> Resolve(const std::vector<HintPriority> &priorities,
+                                         const std::set<std::string> &requested,
+                                         int *floor);
+    static std::vector<HintPriority> ParsePriorities(const std::string &json_doc);
+    static std::vector<HintPriority> DefaultPriorities();
+
+ private:
+    static constexpr size_t kMaxHints = 64;
+
+    using Clock = std::chrono::steady_clock;
+
+    bool ExpireLocked(Clock::time_point now);
+    void ApplyLocked(Clock::time_point now);
+    int InternLocked(const std::string &hint);
+    int Find(const std::string &hint) const;
+    uint64_t MaskOfLocked(const std::set<std::string> &hints);
+
+    std::shared_ptr<HintManager> mHintManager;
+    const std::vector<HintPriority> mPriorities;
+    Listener mListener;
+    std::set<std::string> mRequested;
+    // When each timed request ends
+    std::map<std::string, Clock::time_point> mExpiries;
+    std::set<std::string> mApplied;
+
+    // Published state: every hint seen so far gets a bit. A name is never
+    // changed once mHintCount covers it.
+    std::string mHints[kMaxHints];
+    std::atomic<size_t> mHintCount;
+    std::atomic<uint64_t> mRequestedMask;
+    std::atomic<uint64_t> mAppliedMask;
+    std::atomic<int> mFloor;
+
+    // Serializes changes to the request set
+    mutable std::mutex mLock;
+};
+
+#endif //HINTARBITER_H
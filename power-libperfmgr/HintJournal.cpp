@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+
+#include <inttypes.h>
+#include <time.h>
+
+#include <algorithm>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <utils/Log.h>
+
+#include "HintJournal.h"
+
+#define NSINSEC 1000000000LL
+#define NSINMS 1000000LL
+
+static int64_t NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSINSEC + ts.tv_nsec;
+}
+
+HintJournal::HintJournal() : mClosed(false), mRecorded(0), mReplayed(0) {
+    mEntries.reserve(kMaxEntries);
+}
+
+// Keep only the last entry of each hint, in the order they were last seen.
+void HintJournal::CollapseLocked() {
+    std::vector<Entry> collapsed;
+    for (auto it = mEntries.rbegin(); it != mEntries.rend(); ++it) {
+        bool seen = std::any_of(collapsed.begin(), collapsed.end(),
+                                [&](const Entry &e) { return e.hint == it->hint; });
+        if (!seen)
+            collapsed.push_back(*it);
+    }
+    std::reverse(collapsed.begin(), collapsed.end());
+    mEntries = std::move(collapsed);
+}
+
+bool HintJournal::Record(uint32_t hint, int32_t data) {
+    std::lock_guard<std::mutex> lk(mLock);
+    if (mClosed)
+        return false;
+
+    // There are far fewer distinct hints than entries, so collapsing makes
+    // room unless a client sends values the caller does not filter out.
+    if (mEntries.size() >= kMaxEntries)
+        CollapseLocked();
+    if (mEntries.size() >= kMaxEntries) {
+        ALOGW("%s: journal full, dropping hint %u", __func__, mEntries.front().hint);
+        mEntries.erase(mEntries.begin());
+    }
+    mEntries.push_back({hint, data, NowNs()});
+    mRecorded++;
+    ALOGV("%s: hint %u data %d before ready", __func__, hint, data);
+    return true;
+}
+
+void HintJournal::Close(const std::function<void(const Entry &, int64_t ageMs)> &replay) {
+    std::lock_guard<std::mutex> lk(mLock);
+    if (mClosed)
+        return;
+
+    CollapseLocked();
+    int64_t now = NowNs();
+    for (const auto &e : mEntries) {
+        replay(e, (now - e.timestampNs) / NSINMS);
+    }
+    mReplayed = mEntries.size();
+    ALOGI("Replayed %zu of %" PRIu64 " hints received before ready", mEntries.size(), mRecorded);
+
+    mEntries.clear();
+    mEntries.shrink_to_fit();
+    mClosed = true;
+}
+
+void HintJournal::DumpToFd(int fd) const {
+    std::lock_guard<std::mutex> lk(mLock);
+    std::string buf(android::base::StringPrintf(
+            "HintJournal: %" PRIu64 " recorded before ready, %" PRIu64 " replayed\n",
+            mRecorded, mReplayed));
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump hint journal to fd";
+    }
+}
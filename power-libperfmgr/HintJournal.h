@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef HINTJOURNAL_H
+#define HINTJOURNAL_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Holds hints that arrive before the HAL is ready. Once initialization is
+// done the journal is collapsed to the last entry of each hint, replayed
+// and closed; from then on Record() refuses new entries and the caller
+// handles hints directly.
+struct HintJournal {
+    struct Entry {
+        uint32_t hint;
+        int32_t data;
+        int64_t timestampNs;
+    };
+
+    HintJournal();
+
+    // Returns false once the journal is closed. Holds at most kMaxEntries;
+    // if there are that many distinct hints the oldest entry is dropped.
+    bool Record(uint32_t hint, int32_t data);
+    // Replay runs under the journal lock, so a Record() racing with it waits
+    // and then sees the journal closed. |replay| gets each entry's age.
+    void Close(const std::function<void(const Entry &, int64_t ageMs)> &replay);
+    void DumpToFd(int fd) const;
+
+    static constexpr size_t kMaxEntries = 64;
+
+ private:
+    void CollapseLocked();
+
+    std::vector<Entry> mEntries;
+    bool mClosed;
+    uint64_t mRecorded;
+    uint64_t mReplayed;
+    mutable std::mutex mLock;
+};
+
+#endif //HINTJOURNAL_H
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+
+#include <inttypes.h>
+#include <time.h>
+
+#include <algorithm>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <json/value.h>
+#include <json/writer.h>
+#include <utils/Log.h>
+
+#include "HintMetrics.h"
+
+#define NSINSEC 1000000000LL
+#define NSINUS 1000LL
+#define NSINMS 1000000LL
+
+static int64_t NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSINSEC + ts.tv_nsec;
+}
+
+HintMetrics &HintMetrics::Get() {
+    static HintMetrics metrics;
+    return metrics;
+}
+
+HintMetrics::HintMetrics() : mCount(0) {
+    for (auto &slot : mSlots) {
+        slot.invocations.store(0, std::memory_order_relaxed);
+        slot.suppressed.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < kLatencyBuckets; i++) {
+            slot.doHint[i].store(0, std::memory_order_relaxed);
+            slot.endHint[i].store(0, std::memory_order_relaxed);
+        }
+        slot.activeSinceNs = 0;
+        slot.activeUntilNs = 0;
+        slot.totalNs = 0;
+    }
+}
+
+HintMetrics::Slot *HintMetrics::SlotOf(const std::string &hint) {
+    size_t count = mCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        if (mNames[i] == hint)
+            return &mSlots[i];
+    }
+
+    std::lock_guard<std::mutex> lk(mRegisterLock);
+    count = mCount.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+        if (mNames[i] == hint)
+            return &mSlots[i];
+    }
+    if (count == kMaxHints) {
+        ALOGE("%s: too many hints, not counting %s", __func__, hint.c_str());
+        return nullptr;
+    }
+    mNames[count] = hint;
+    mCount.store(count + 1, std::memory_order_release);
+    return &mSlots[count];
+}
+
+void HintMetrics::RecordLatency(std::atomic<uint64_t> *buckets, int64_t latencyNs) {
+    uint64_t us = std::max<int64_t>(latencyNs / NSINUS, 1);
+    size_t bucket = std::min<size_t>(63 - __builtin_clzll(us), kLatencyBuckets - 1);
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+bool HintMetrics::DoHint(HintManager &hint_manager, const std::string &hint,
+                         std::chrono::milliseconds timeout) {
+    int64_t start = NowNs();
+    bool ok = timeout.count() > 0 ? hint_manager.DoHint(hint, timeout)
+                                  : hint_manager.DoHint(hint);
+    int64_t end = NowNs();
+
+    HintMetrics &metrics = Get();
+    Slot *slot = metrics.SlotOf(hint);
+    if (!slot || !ok)
+        return ok;
+    RecordLatency(slot->doHint, end - start);
+
+    std::lock_guard<std::mutex> lk(metrics.mStateLock);
+    if (slot->activeSinceNs && slot->activeUntilNs <= end) {
+        // The previous timed request ran out on its own
+        slot->totalNs += slot->activeUntilNs - slot->activeSinceNs;
+        slot->activeSinceNs = 0;
+    }
+    if (!slot->activeSinceNs)
+        slot->activeSinceNs = end;
+    slot->activeUntilNs = timeout.count() > 0 ? end + timeout.count() * NSINMS : INT64_MAX;
+    return ok;
+}
+
+bool HintMetrics::EndHint(HintManager &hint_manager, const std::string &hint) {
+    int64_t start = NowNs();
+    bool ok = hint_manager.EndHint(hint);
+    int64_t end = NowNs();
+
+    HintMetrics &metrics = Get();
+    Slot *slot = metrics.SlotOf(hint);
+    if (!slot || !ok)
+        return ok;
+    RecordLatency(slot->endHint, end - start);
+
+    std::lock_guard<std::mutex> lk(metrics.mStateLock);
+    if (slot->activeSinceNs) {
+        slot->totalNs += std::min(end, slot->activeUntilNs) - slot->activeSinceNs;
+        slot->activeSinceNs = 0;
+    }
+    return ok;
+}
+
+void HintMetrics::RecordInvocation(const std::string &hint) {
+    Slot *slot = SlotOf(hint);
+    if (slot)
+        slot->invocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void HintMetrics::RecordSuppressed(const std::string &hint) {
+    Slot *slot = SlotOf(hint);
+    if (slot)
+        slot->suppressed.fetch_add(1, std::memory_order_relaxed);
+}
+
+// should be called while locked
+int64_t HintMetrics::TimeInStateLocked(const Slot &slot, int64_t now) const {
+    int64_t total = slot.totalNs;
+    if (slot.activeSinceNs)
+        total += std::min(now, slot.activeUntilNs) - slot.activeSinceNs;
+    return total;
+}
+
+std::vector<std::pair<std::string, int64_t>> HintMetrics::GetTimeInStateMs() const {
+    size_t count = mCount.load(std::memory_order_acquire);
+    int64_t now = NowNs();
+    std::vector<std::pair<std::string, int64_t>> times;
+
+    std::lock_guard<std::mutex> lk(mStateLock);
+    for (size_t i = 0; i < count; i++)
+        times.emplace_back(mNames[i], TimeInStateLocked(mSlots[i], now) / NSINMS);
+    return times;
+}
+
+// Upper bound in us of the bucket holding the given percentile.
+static uint64_t LatencyPercentileUs(const std::atomic<uint64_t> *buckets, size_t count,
+                                    int percentile) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++)
+        total += buckets[i].load(std::memory_order_relaxed);
+    if (!total)
+        return 0;
+
+    uint64_t rank = (total * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < count; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return 2ULL << i;
+    }
+    return 2ULL << (count - 1);
+}
+
+void HintMetrics::DumpToFd(int fd) const {
+    size_t count = mCount.load(std::memory_order_acquire);
+    int64_t now = NowNs();
+    std::string buf("HintMetrics:\n");
+
+    for (size_t i = 0; i < count; i++) {
+        const Slot &slot = mSlots[i];
+        int64_t timeInState;
+        bool active;
+        {
+            std::lock_guard<std::mutex> lk(mStateLock);
+            timeInState = TimeInStateLocked(slot, now);
+            active = slot.activeSinceNs && slot.activeUntilNs > now;
+        }
+        android::base::StringAppendF(
+                &buf,
+                "  %s: %" PRIu64 " calls, %" PRIu64 " suppressed, "
+                "do p50/p99 <%" PRIu64 "/<%" PRIu64 " us, end p50/p99 <%" PRIu64 "/<%" PRIu64
+                " us, %" PRId64 " ms in state%s\n",
+                mNames[i].c_str(), slot.invocations.load(std::memory_order_relaxed),
+                slot.suppressed.load(std::memory_order_relaxed),
+                LatencyPercentileUs(slot.doHint, kLatencyBuckets, 50),
+                LatencyPercentileUs(slot.doHint, kLatencyBuckets, 99),
+                LatencyPercentileUs(slot.endHint, kLatencyBuckets, 50),
+                LatencyPercentileUs(slot.endHint, kLatencyBuckets, 99),
+                static_cast<int64_t>(timeInState / NSINMS), active ? " (active)" : "");
+    }
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump hint metrics to fd";
+    }
+}
+
+void HintMetrics::DumpJsonToFd(int fd) const {
+    size_t count = mCount.load(std::memory_order_acquire);
+    int64_t now = NowNs();
+    Json::Value root;
+
+    root["latency_bucket_upper_us"] = Json::Value(Json::arrayValue);
+    for (size_t b = 0; b < kLatencyBuckets; b++)
+        root["latency_bucket_upper_us"].append(Json::UInt64(2ULL << b));
+
+    root["hints"] = Json::Value(Json::objectValue);
+    for (size_t i = 0; i < count; i++) {
+        const Slot &slot = mSlots[i];
+        Json::Value hint;
+        hint["invocations"] = Json::UInt64(slot.invocations.load(std::memory_order_relaxed));
+        hint["suppressed"] = Json::UInt64(slot.suppressed.load(std::memory_order_relaxed));
+        hint["do_hint"] = Json::Value(Json::arrayValue);
+        hint["end_hint"] = Json::Value(Json::arrayValue);
+        for (size_t b = 0; b < kLatencyBuckets; b++) {
+            hint["do_hint"].append(Json::UInt64(slot.doHint[b].load(std::memory_order_relaxed)));
+            hint["end_hint"].append(
+                    Json::UInt64(slot.endHint[b].load(std::memory_order_relaxed)));
+        }
+        {
+            std::lock_guard<std::mutex> lk(mStateLock);
+            hint["time_in_state_ms"] = Json::Int64(TimeInStateLocked(slot, now) / NSINMS);
+            hint["active"] = slot.activeSinceNs && slot.activeUntilNs > now;
+        }
+        root["hints"][mNames[i]] = hint;
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::string buf = Json::writeString(builder, root) + "\n";
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump hint metrics to fd";
+    }
+}
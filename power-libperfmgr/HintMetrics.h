@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef HINTMETRICS_H
+#define HINTMETRICS_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <perfmgr/HintManager.h>
+
+using ::android::perfmgr::HintManager;
+
+// Process wide counters per hint name: how often a hint came in and was
+// held back, how long HintManager took to start and end it, and how long
+// it has been in effect in total. Counters are atomics so the hint path
+// never waits on a dump.
+struct HintMetrics {
+    static HintMetrics &Get();
+
+    // Call HintManager and account for it. A zero timeout keeps the
+    // Duration of the hint's actions.
+    static bool DoHint(HintManager &hint_manager, const std::string &hint,
+                       std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+    static bool EndHint(HintManager &hint_manager, const std::string &hint);
+
+    void RecordInvocation(const std::string &hint);
+    void RecordSuppressed(const std::string &hint);
+
+    // Total time each hint seen so far has been in effect, in ms.
+    std::vector<std::pair<std::string, int64_t>> GetTimeInStateMs() const;
+
+    void DumpToFd(int fd) const;
+    void DumpJsonToFd(int fd) const;
+
+ private:
+    static constexpr size_t kMaxHints = 64;
+    // Bucket i holds latencies below 2^(i+1) us; the last one everything else.
+    static constexpr size_t kLatencyBuckets = 16;
+
+    struct Slot {
+        std::atomic<uint64_t> invocations;
+        std::atomic<uint64_t> suppressed;
+        std::atomic<uint64_t> doHint[kLatencyBuckets];
+        std::atomic<uint64_t> endHint[kLatencyBuckets];
+        // CLOCK_MONOTONIC, guarded by mStateLock. activeUntilNs is when a
+        // timed hint runs out by itself.
+        int64_t activeSinceNs;
+        int64_t activeUntilNs;
+        int64_t totalNs;
+    };
+
+    HintMetrics();
+    Slot *SlotOf(const std::string &hint);
+    static void RecordLatency(std::atomic<uint64_t> *buckets, int64_t latencyNs);
+    int64_t TimeInStateLocked(const Slot &slot, int64_t now) const;
+
+    std::string mNames[kMaxHints];
+    Slot mSlots[kMaxHints];
+    std::atomic<size_t> mCount;
+    std::mutex mRegisterLock;
+    mutable std::mutex mStateLock;
+};
+
+#endif //HINTMETRICS_H
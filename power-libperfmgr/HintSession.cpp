@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//#define LOG_NDEBUG 0
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+#define ATRACE_TAG (ATRACE_TAG_POWER | ATRACE_TAG_HAL)
+
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include "HintMetrics.h"
+#include "HintSession.h"
+
+#define NSINSEC 1000000000LL
+#define NSINMS 1000000LL
+
+// Not every libc carries the uclamp fields of sched_attr yet.
+struct session_sched_attr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+    uint32_t sched_util_min;
+    uint32_t sched_util_max;
+};
+
+#define SESSION_SCHED_FLAG_KEEP_ALL 0x18
+#define SESSION_SCHED_FLAG_UTIL_CLAMP_MIN 0x20
+
+static constexpr size_t kMaxSessions = 32;
+static constexpr size_t kMaxThreads = 16;
+// At most one boost change per session per frame at 60Hz
+static constexpr int64_t kMinUpdateIntervalNs = 16 * NSINMS;
+// A session without reports for this many target durations is idle
+static constexpr int64_t kStaleTargetFactor = 20;
+static constexpr int64_t kMinStaleNs = 100 * NSINMS;
+static constexpr int64_t kSessionTimeoutNs = 60 * NSINSEC;
+static constexpr std::chrono::milliseconds kTickPeriod(100);
+
+// Start at a light boost, never go past half of full capacity.
+static constexpr HintSessionManager::Params kParams = {160, 512, 0.5, 0.05, 4.0};
+
+static int64_t NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSINSEC + ts.tv_nsec;
+}
+
+static int SetUclampMin(int32_t tid, int value) {
+    struct session_sched_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.sched_flags = SESSION_SCHED_FLAG_KEEP_ALL | SESSION_SCHED_FLAG_UTIL_CLAMP_MIN;
+    attr.sched_util_min = value;
+    return syscall(__NR_sched_setattr, tid, &attr, 0);
+}
+
+HintSessionManager::HintSessionManager(std::shared_ptr<HintManager> const & hint_manager,
+                                       std::vector<std::string> boost_levels, bool use_uclamp)
+    : mHintManager(hint_manager),
+      mBoostLevels(std::move(boost_levels)),
+      mParams(kParams),
+      mUseUclamp(use_uclamp),
+      mUclamp(false),
+      mNextId(1),
+      mAppliedLevel(-1),
+      mExit(false) {
+}
+
+HintSessionManager::~HintSessionManager() {
+    Exit();
+}
+
+bool HintSessionManager::Init() {
+    std::lock_guard<std::mutex> lk(mLock);
+    if (mThread)
+        return true;
+
+    // Probe on ourselves; kernels without uclamp reject the flag.
+    mUclamp = mUseUclamp && SetUclampMin(0, 0) == 0;
+    ALOGI("Hint sessions boost through %s", mUclamp ? "uclamp.min" : "top-app schedtune");
+
+    mExit = false;
+    mThread = std::make_unique<std::thread>(&HintSessionManager::Routine, this);
+    return true;
+}
+
+void HintSessionManager::Exit() {
+    std::unique_lock<std::mutex> lk(mLock);
+    if (!mThread)
+        return;
+    mExit = true;
+    lk.unlock();
+
+    mCond.notify_all();
+    mThread->join();
+    mThread.reset();
+}
+
+int HintSessionManager::Update(const Params &params, State *state, int64_t actualNs,
+                               int64_t targetNs) {
+    // Positive error means the work ran late and needs more boost.
+    double error = std::clamp(static_cast<double>(actualNs - targetNs) / targetNs, -1.0, 2.0);
+    state->integral = std::clamp(state->integral + error, -params.integralMax,
+                                 params.integralMax);
+    double boost = params.initBoost +
+                   (params.kp * error + params.ki * state->integral) * params.maxBoost;
+    state->boost = std::clamp(static_cast<int>(boost), 0, params.maxBoost);
+    return state->boost;
+}
+
+// should be called while locked
+bool HintSessionManager::ApplyLocked(int64_t id, Session *session, int boost, int64_t now) {
+    bool alive = !mUclamp;
+    if (mUclamp) {
+        for (int32_t tid : session->tids) {
+            if (!SetUclampMin(tid, boost)) {
+                alive = true;
+            } else if (errno != ESRCH) {
+                alive = true;
+                ALOGV("%s: failed to set uclamp.min of %d (%d)", __func__, tid, errno);
+            }
+        }
+    }
+
+    ALOGV("%s: session %" PRId64 " boost %d -> %d", __func__, id, session->appliedBoost, boost);
+    ATRACE_INT(android::base::StringPrintf("session_%" PRId64 "_boost", id).c_str(), boost);
+    session->appliedBoost = boost;
+    session->lastApplyNs = now;
+    session->updates++;
+    return alive;
+}
+
+// should be called while locked
+void HintSessionManager::UpdateLevelLocked() {
+    if (mUclamp || mBoostLevels.empty())
+        return;
+
+    int boost = 0;
+    for (const auto &entry : mSessions)
+        boost = std::max(boost, entry.second.appliedBoost);
+    int count = mBoostLevels.size();
+    int level = boost > 0 ? std::min(count - 1, boost * count / (mParams.maxBoost + 1)) : -1;
+    if (level == mAppliedLevel)
+        return;
+
+    if (level >= 0)
+        HintMetrics::DoHint(*mHintManager, mBoostLevels[level]);
+    if (mAppliedLevel >= 0)
+        HintMetrics::EndHint(*mHintManager, mBoostLevels[mAppliedLevel]);
+    mAppliedLevel = level;
+}
+
+int64_t HintSessionManager::CreateSession(int32_t tgid, std::vector<int32_t> const & tids,
+                                          int64_t targetNs) {
+    if (tgid <= 0 || tids.empty() || tids.size() > kMaxThreads || targetNs <= 0)
+        return -1;
+
+    std::lock_guard<std::mutex> lk(mLock);
+    if (mSessions.size() >= kMaxSessions) {
+        ALOGE("%s: too many sessions, refusing %d", __func__, tgid);
+        return -1;
+    }
+
+    int64_t now = NowNs();
+    int64_t id = mNextId++;
+    Session &session = mSessions[id];
+    session = {tgid, tids, targetNs, {0, mParams.initBoost}, 0, now, 0, 0, 0, 0};
+    if (!ApplyLocked(id, &session, mParams.initBoost, now)) {
+        mSessions.erase(id);
+        return -1;
+    }
+    UpdateLevelLocked();
+    mCond.notify_all();
+
+    ALOGD("Created hint session %" PRId64 " for %d with %zu threads, target %" PRId64 " ns",
+          id, tgid, tids.size(), targetNs);
+    return id;
+}
+
+bool HintSessionManager::UpdateTargetWorkDuration(int64_t id, int64_t targetNs) {
+    if (targetNs <= 0)
+        return false;
+
+    std::lock_guard<std::mutex> lk(mLock);
+    auto it = mSessions.find(id);
+    if (it == mSessions.end())
+        return false;
+    it->second.targetNs = targetNs;
+    return true;
+}
+
+bool HintSessionManager::ReportActualWorkDuration(int64_t id,
+                                                  std::vector<int64_t> const & durationsNs) {
+    ATRACE_CALL();
+
+    std::lock_guard<std::mutex> lk(mLock);
+    auto it = mSessions.find(id);
+    if (it == mSessions.end())
+        return false;
+    Session &session = it->second;
+
+    int boost = session.state.boost;
+    for (int64_t actualNs : durationsNs) {
+        if (actualNs <= 0)
+            continue;
+        boost = Update(mParams, &session.state, actualNs, session.targetNs);
+        session.reports++;
+    }
+
+    int64_t now = NowNs();
+    session.lastReportNs = now;
+    if (boost == session.appliedBoost)
+        return true;
+    // Reports can come in much faster than the scheduler needs to hear
+    // about them; later reports carry the state forward.
+    if (now - session.lastApplyNs < kMinUpdateIntervalNs) {
+        session.skipped++;
+        return true;
+    }
+    if (!ApplyLocked(id, &session, boost, now)) {
+        ALOGD("Hint session %" PRId64 " threads are gone, closing", id);
+        mSessions.erase(it);
+    }
+    UpdateLevelLocked();
+    return true;
+}
+
+bool HintSessionManager::CloseSession(int64_t id) {
+    std::lock_guard<std::mutex> lk(mLock);
+    auto it = mSessions.find(id);
+    if (it == mSessions.end())
+        return false;
+
+    ApplyLocked(id, &it->second, 0, NowNs());
+    mSessions.erase(it);
+    UpdateLevelLocked();
+    ALOGD("Closed hint session %" PRId64, id);
+    return true;
+}
+
+void HintSessionManager::Routine() {
+    std::unique_lock<std::mutex> lk(mLock);
+
+    while (!mExit) {
+        if (mSessions.empty()) {
+            mCond.wait(lk, [&] { return mExit || !mSessions.empty(); });
+            continue;
+        }
+        if (mCond.wait_for(lk, kTickPeriod, [&] { return mExit; }))
+            break;
+
+        int64_t now = NowNs();
+        for (auto it = mSessions.begin(); it != mSessions.end();) {
+            Session &session = it->second;
+            int64_t silentNs = now - session.lastReportNs;
+            bool alive = true;
+
+            if (silentNs > kSessionTimeoutNs) {
+                ALOGD("Hint session %" PRId64 " timed out", it->first);
+                ApplyLocked(it->first, &session, 0, now);
+                alive = false;
+            } else if (session.appliedBoost &&
+                       silentNs > std::max(kStaleTargetFactor * session.targetNs, kMinStaleNs)) {
+                // Idle: drop the boost and keep it dropped. Reports start
+                // over from the initial boost once they come back.
+                session.state = {0, 0};
+                alive = ApplyLocked(it->first, &session, 0, now);
+            } else if (session.state.boost != session.appliedBoost &&
+                       now - session.lastApplyNs >= kMinUpdateIntervalNs) {
+                // The last report was rate limited and nothing came after it
+                alive = ApplyLocked(it->first, &session, session.state.boost, now);
+            }
+
+            if (alive) {
+                ++it;
+            } else {
+                it = mSessions.erase(it);
+            }
+        }
+        UpdateLevelLocked();
+    }
+}
+
+template <typename T>
+static bool ParseArgs(std::vector<std::string> const & args, size_t first, std::vector<T> *out) {
+    for (size_t i = first; i < args.size(); i++) {
+        T value;
+        if (!android::base::ParseInt(args[i], &value))
+            return false;
+        out->push_back(value);
+    }
+    return !out->empty();
+}
+
+bool HintSessionManager::HandleCommand(std::vector<std::string> const & args, int fd) {
+    if (args.size() < 2 || args[0] != "--session")
+        return false;
+
+    const std::string &cmd = args[1];
+    std::vector<int64_t> values;
+    std::string result;
+
+    if (!ParseArgs(args, 2, &values)) {
+        result = "Invalid session command arguments\n";
+    } else if (cmd == "create" && values.size() >= 3) {
+        std::vector<int32_t> tids(values.begin() + 2, values.end());
+        int64_t id = CreateSession(values[0], tids, values[1]);
+        result = android::base::StringPrintf("session %" PRId64 "\n", id);
+    } else if (cmd == "report" && values.size() >= 2) {
+        std::vector<int64_t> durations(values.begin() + 1, values.end());
+        result = ReportActualWorkDuration(values[0], durations) ? "ok\n" : "no such session\n";
+    } else if (cmd == "target" && values.size() == 2) {
+        result = UpdateTargetWorkDuration(values[0], values[1]) ? "ok\n" : "failed\n";
+    } else if (cmd == "close" && values.size() == 1) {
+        result = CloseSession(values[0]) ? "ok\n" : "no such session\n";
+    } else {
+        result = "Usage: --session create <tgid> <target_ns> <tid>...\n"
+                 "       --session report <id> <duration_ns>...\n"
+                 "       --session target <id> <target_ns>\n"
+                 "       --session close <id>\n";
+    }
+
+    if (!android::base::WriteStringToFd(result, fd)) {
+        PLOG(ERROR) << "Failed to write session command result to fd";
+    }
+    return true;
+}
+
+void HintSessionManager::DumpToFd(int fd) const {
+    std::unique_lock<std::mutex> lk(mLock);
+    std::map<int64_t, Session> sessions(mSessions);
+    int level = mAppliedLevel;
+    lk.unlock();
+
+    std::string buf(android::base::StringPrintf("HintSessions: %zu (%s", sessions.size(),
+                                                mUclamp ? "uclamp.min" : "schedtune"));
+    if (!mUclamp)
+        buf += android::base::StringPrintf(", level %d", level);
+    buf += ")\n";
+    for (const auto &entry : sessions) {
+        const Session &s = entry.second;
+        buf += android::base::StringPrintf(
+                "  %" PRId64 ": tgid %d, %zu threads, target %" PRId64 " ns, boost %d, "
+                "%" PRIu64 " reports, %" PRIu64 " updates, %" PRIu64 " rate limited\n",
+                entry.first, s.tgid, s.tids.size(), s.targetNs, s.appliedBoost, s.reports,
+                s.updates, s.skipped);
+    }
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump hint sessions to fd";
+    }
+}
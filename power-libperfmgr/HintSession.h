@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef HINTSESSION_H
+#define HINTSESSION_H
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <perfmgr/HintManager.h>
+
+using ::android::perfmgr::HintManager;
+
+// Per thread group boosting in the spirit of ADPF hint sessions.
+//
+// A client registers the threads doing one unit of work, for example a
+// game's render loop, along with how long that work should take, then
+// reports how long it actually took. A PI controller turns the error into
+// a boost for just those threads through uclamp.min. Kernels without
+// uclamp fall back to a ladder of top-app schedtune boost hints in
+// powerhint.json, sized by the neediest session.
+//
+// IPower 1.3 has no session interface. Eng and userdebug builds let
+// clients reach this through debug() for development, see HandleCommand();
+// user builds have no way in until the HAL gains one.
+struct HintSessionManager {
+    struct Params {
+        int initBoost;
+        int maxBoost;
+        // Boost per unit of relative error, and per unit of accumulated error.
+        double kp;
+        double ki;
+        double integralMax;
+    };
+
+    struct State {
+        double integral;
+        int boost;
+    };
+
+    // Without |use_uclamp|, the schedtune ladder is used even where
+    // uclamp works.
+    HintSessionManager(std::shared_ptr<HintManager> const & hint_manager,
+                       std::vector<std::string> boost_levels, bool use_uclamp = true);
+    ~HintSessionManager();
+    bool Init();
+    void Exit();
+
+    // Returns the new session id, or -1.
+    int64_t CreateSession(int32_t tgid, std::vector<int32_t> const & tids, int64_t targetNs);
+    bool UpdateTargetWorkDuration(int64_t id, int64_t targetNs);
+    bool ReportActualWorkDuration(int64_t id, std::vector<int64_t> const & durationsNs);
+    bool CloseSession(int64_t id);
+
+    // Runs "--session <create|report|target|close> ..." from debug().
+    // Returns false if |args| is not a session command.
+    bool HandleCommand(std::vector<std::string> const & args, int fd);
+    void DumpToFd(int fd) const;
+
+    // One controller step for a reported duration. Returns the new boost.
+    static int Update(const Params &params, State *state, int64_t actualNs, int64_t targetNs);
+
+ private:
+    struct Session {
+        int32_t tgid;
+        std::vector<int32_t> tids;
+        int64_t targetNs;
+        State state;
+        int appliedBoost;
+        int64_t lastReportNs;
+        int64_t lastApplyNs;
+        uint64_t reports;
+        uint64_t updates;
+        uint64_t skipped;
+    };
+
+    bool ApplyLocked(int64_t id, Session *session, int boost, int64_t now);
+    void UpdateLevelLocked();
+    void Routine();
+
+    std::shared_ptr<HintManager> mHintManager;
+    const std::vector<std::string> mBoostLevels;
+    const Params mParams;
+    const bool mUseUclamp;
+    bool mUclamp;
+
+    std::map<int64_t, Session> mSessions;
+    int64_t mNextId;
+    int mAppliedLevel;
+
+    bool mExit;
+    std::unique_ptr<std::thread> mThread;
+    mutable std::mutex mLock;
+    std::condition_variable mCond;
+};
+
+#endif //HINTSESSION_H
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <utils/Log.h>
+
+#include "HintTrace.h"
+
+#define NSINSEC 1000000000LL
+
+static int64_t NowNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * NSINSEC + ts.tv_nsec;
+}
+
+HintTraceRecorder::HintTraceRecorder()
+    : mFd(-1), mOpen(false), mRecords(0), mErrors(0) {}
+
+HintTraceRecorder::~HintTraceRecorder() {
+    mOpen = false;
+    if (mFd >= 0)
+        close(mFd);
+}
+
+// Not thread safe, call before hints come in.
+bool HintTraceRecorder::Open(const std::string &path) {
+    mFd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0640);
+    if (mFd < 0) {
+        ALOGE("%s: failed to open %s (%d)", __func__, path.c_str(), errno);
+        return false;
+    }
+    mPath = path;
+    if (!WriteEntry(kMagic, kVersion, NowNs(CLOCK_REALTIME))) {
+        ALOGE("%s: failed to start session in %s (%d)", __func__, path.c_str(), errno);
+        close(mFd);
+        mFd = -1;
+        return false;
+    }
+    mOpen = true;
+    ALOGI("Recording hints to %s", path.c_str());
+    return true;
+}
+
+// A single O_APPEND write of the whole entry keeps entries from
+// concurrent binder threads from interleaving.
+bool HintTraceRecorder::WriteEntry(uint32_t first, uint32_t second, int64_t timestamp) {
+    uint8_t entry[16];
+    for (int i = 0; i < 4; i++) {
+        entry[i] = first >> (8 * i);
+        entry[4 + i] = second >> (8 * i);
+    }
+    for (int i = 0; i < 8; i++)
+        entry[8 + i] = static_cast<uint64_t>(timestamp) >> (8 * i);
+    return TEMP_FAILURE_RETRY(write(mFd, entry, sizeof(entry))) == sizeof(entry);
+}
+
+void HintTraceRecorder::Record(uint32_t hint, int32_t data) {
+    if (!mOpen.load(std::memory_order_relaxed))
+        return;
+    Record(hint, data, NowNs(CLOCK_MONOTONIC));
+}
+
+void HintTraceRecorder::Record(uint32_t hint, int32_t data, int64_t timestampNs) {
+    if (!mOpen.load(std::memory_order_relaxed))
+        return;
+    if (WriteEntry(hint, static_cast<uint32_t>(data), timestampNs))
+        mRecords.fetch_add(1, std::memory_order_relaxed);
+    else
+        mErrors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void HintTraceRecorder::DumpToFd(int fd) const {
+    std::string buf;
+    if (mOpen) {
+        buf = android::base::StringPrintf(
+                "HintTrace: recording to %s, %" PRIu64 " hints, %" PRIu64 " failed\n",
+                mPath.c_str(), mRecords.load(), mErrors.load());
+    } else {
+        buf = "HintTrace: off\n";
+    }
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump hint trace state to fd";
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef HINTTRACE_H
+#define HINTTRACE_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+// Appends every hint the HAL receives to a binary trace, for replay on a
+// host with tools/powerhint_replay.py. All fields are little endian and
+// every entry is 16 bytes:
+//
+//   session: u32 magic "PHTR", u32 version, i64 CLOCK_REALTIME ns at open
+//   hint:    u32 hint, i32 data, i64 CLOCK_MONOTONIC ns
+//
+// A session entry starts each HAL run, so restarts append to the same
+// file. Hint values are the IPower 1.3 PowerHint ones, plus the pseudo
+// hints below for events the replay needs.
+struct HintTraceRecorder {
+    static constexpr uint32_t kMagic = 0x52544850;  // "PHTR"
+    static constexpr uint32_t kVersion = 1;
+    // The display went idle
+    static constexpr uint32_t kDisplayIdle = 0x80000000;
+    // A perf lock resource changed level: kPerfLock + resource, with the
+    // level as data
+    static constexpr uint32_t kPerfLock = 0x80001000;
+
+    HintTraceRecorder();
+    ~HintTraceRecorder();
+
+    bool Open(const std::string &path);
+    // Safe to call from any thread, and cheap while not recording.
+    void Record(uint32_t hint, int32_t data);
+    void Record(uint32_t hint, int32_t data, int64_t timestampNs);
+    void DumpToFd(int fd) const;
+
+ private:
+    bool WriteEntry(uint32_t first, uint32_t second, int64_t timestamp);
+
+    std::string mPath;
+    int mFd;
+    std::atomic<bool> mOpen;
+    std::atomic<uint64_t> mRecords;
+    std::atomic<uint64_t> mErrors;
+};
+
+#endif //HINTTRACE_H
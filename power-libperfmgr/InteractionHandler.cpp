@@ -20,58 +20,145 @@
 #define ATRACE_TAG (ATRACE_TAG_POWER | ATRACE_TAG_HAL)
 
 #include <fcntl.h>
-#include <poll.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <time.h>
 #include <unistd.h>
+
+#include <algorithm>
+
+#include <android-base/file.h>
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
 #include <utils/Log.h>
 #include <utils/Trace.h>
 
+#include "HintMetrics.h"
 #include "InteractionHandler.h"
+#include "node-cache.h"
 
+#ifndef FB_IDLE_PATH
 #define FB_IDLE_PATH "/sys/class/drm/card0/device/idle_state"
+#endif
 #define MAX_LENGTH 64
 
-#define MSINSEC 1000L
-#define USINMS 1000000L
+#define NSINSEC 1000000000LL
+#define NSINMS 1000000LL
+
+constexpr char kAdaptiveProp[] = "vendor.powerhal.interaction.adaptive";
+constexpr char kPercentileProp[] = "vendor.powerhal.interaction.percentile";
+
+// Samples needed in a bucket before its learned duration is used
+static constexpr size_t kMinSamples = 8;
+// Added on top of the learned percentile
+static constexpr int32_t kAdaptiveMarginMs = 100;
+static constexpr int32_t kAdaptiveMinMs = 200;
+
+// Upper bounds of the requested-duration buckets
+static constexpr int32_t kBucketLimitsMs[] = {0, 500, 1500, 3000};
+
+static int64_t NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSINSEC + ts.tv_nsec;
+}
 
 InteractionHandler::InteractionHandler(std::shared_ptr<HintManager> const & hint_manager)
     : mState(INTERACTION_STATE_UNINITIALIZED),
+      mIdleFd(-1),
+      mEventFd(-1),
+      mTimerFd(-1),
+      mEpollFd(-1),
+      mIdleWatched(false),
       mWaitMs(100),
       mMinDurationMs(1400),
       mMaxDurationMs(5650),
       mDurationMs(0),
+      mAdaptive(android::base::GetBoolProperty(kAdaptiveProp, false)),
+      mPercentile(android::base::GetIntProperty(kPercentileProp, 90, 1, 100)),
+      mBucket(0),
+      mHistory(),
+      mStartNs(0),
+      mIdleCheckNs(0),
+      mDeadlineNs(0),
       mHintManager(hint_manager) {
+    for (auto &learned : mLearnedMs)
+        learned.store(0, std::memory_order_relaxed);
 }
 
 InteractionHandler::~InteractionHandler() {
     Exit();
 }
 
+static bool AddToEpoll(int epoll_fd, int fd, uint32_t events) {
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
 bool InteractionHandler::Init() {
     std::lock_guard<std::mutex> lk(mLock);
 
     if (mState != INTERACTION_STATE_UNINITIALIZED)
         return true;
 
-    mIdleFd = open(FB_IDLE_PATH, O_RDONLY);
+    // Owned by the node cache, IsIdle() reads through the same fd
+    mIdleFd = node_cache_read_fd(FB_IDLE_PATH);
     if (mIdleFd < 0) {
-        ALOGE("Unable to open idle state path (%d)", errno);
+        ALOGE("Unable to open idle state path");
         return false;
     }
 
-    mEventFd = eventfd(0, EFD_NONBLOCK);
+    mEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
     if (mEventFd < 0) {
         ALOGE("Unable to create event fd (%d)", errno);
-        close(mIdleFd);
-        return false;
+        goto err_event;
     }
 
+    mTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (mTimerFd < 0) {
+        ALOGE("Unable to create timer fd (%d)", errno);
+        goto err_timer;
+    }
+
+    mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (mEpollFd < 0) {
+        ALOGE("Unable to create epoll fd (%d)", errno);
+        goto err_epoll;
+    }
+
+    if (!AddToEpoll(mEpollFd, mEventFd, EPOLLIN) ||
+        !AddToEpoll(mEpollFd, mTimerFd, EPOLLIN)) {
+        ALOGE("Unable to add fds to epoll (%d)", errno);
+        goto err_ctl;
+    }
+
+    // Without idle notifications the timer polls the node instead
+    mIdleWatched = AddToEpoll(mEpollFd, mIdleFd, EPOLLPRI | EPOLLERR);
+    if (!mIdleWatched)
+        ALOGW("Unable to watch idle state, polling it (%d)", errno);
+
+    // Consume the current state so only later changes wake the loop
+    IsIdle();
+
     mState = INTERACTION_STATE_IDLE;
     mThread = std::unique_ptr<std::thread>(
         new std::thread(&InteractionHandler::Routine, this));
 
     return true;
+
+err_ctl:
+    close(mEpollFd);
+err_epoll:
+    close(mTimerFd);
+err_timer:
+    close(mEventFd);
+err_event:
+    return false;
 }
 
 void InteractionHandler::Exit() {
@@ -79,20 +166,25 @@ void InteractionHandler::Exit() {
     if (mState == INTERACTION_STATE_UNINITIALIZED)
         return;
 
-    AbortWaitLocked();
+    uint64_t val = 1;
+    ssize_t ret = write(mEventFd, &val, sizeof(val));
+    if (ret != sizeof(val))
+        ALOGW("Unable to write to event fd (%zd)", ret);
+    if (mState == INTERACTION_STATE_INTERACTION)
+        PerfRel();
     mState = INTERACTION_STATE_UNINITIALIZED;
     lk.unlock();
 
-    mCond.notify_all();
     mThread->join();
 
+    close(mEpollFd);
+    close(mTimerFd);
     close(mEventFd);
-    close(mIdleFd);
 }
 
 void InteractionHandler::PerfLock() {
     ALOGV("%s: acquiring perf lock", __func__);
-    if (!mHintManager->DoHint("INTERACTION")) {
+    if (!HintMetrics::DoHint(*mHintManager, "INTERACTION")) {
         ALOGE("%s: do hint INTERACTION failed", __func__);
     }
     ATRACE_INT("interaction_lock", 1);
@@ -100,143 +192,260 @@ void InteractionHandler::PerfLock() {
 
 void InteractionHandler::PerfRel() {
     ALOGV("%s: releasing perf lock", __func__);
-    if (!mHintManager->EndHint("INTERACTION")) {
+    if (!HintMetrics::EndHint(*mHintManager, "INTERACTION")) {
         ALOGE("%s: end hint INTERACTION failed", __func__);
     }
     ATRACE_INT("interaction_lock", 0);
 }
 
-long long InteractionHandler::CalcTimespecDiffMs(struct timespec start,
-                                               struct timespec end) {
-    long long diff_in_us = 0;
-    diff_in_us += (end.tv_sec - start.tv_sec) * MSINSEC;
-    diff_in_us += (end.tv_nsec - start.tv_nsec) / USINMS;
-    return diff_in_us;
+int InteractionHandler::BucketOf(int32_t duration) {
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && duration > kBucketLimitsMs[bucket])
+        bucket++;
+    return bucket;
+}
+
+int32_t InteractionHandler::StaticDuration(int32_t duration) const {
+    int inputDuration = duration + 650;
+    if (inputDuration > mMaxDurationMs)
+        return mMaxDurationMs;
+    else if (inputDuration > mMinDurationMs)
+        return inputDuration;
+    else
+        return mMinDurationMs;
+}
+
+// should be called while locked
+void InteractionHandler::RecordRelease(bool idle) {
+    int bucket = mBucket.load();
+    std::lock_guard<std::mutex> lk(mHistoryLock);
+    BoostHistory &history = mHistory[bucket];
+    int64_t waitedMs = (NowNs() - mIdleCheckNs.load()) / NSINMS;
+
+    history.samples[history.count % kSamplesPerBucket] = {
+            static_cast<int32_t>(std::clamp<int64_t>(waitedMs, 0, mMaxDurationMs)), !idle};
+    history.count++;
+    if (idle)
+        history.idleReleases++;
+    else
+        history.timeoutReleases++;
+
+    if (!mAdaptive || history.count < kMinSamples)
+        return;
+
+    // Censored samples sort above every idle one: their idle time is at
+    // least their value, so they cannot be placed any lower.
+    size_t n = std::min<size_t>(history.count, kSamplesPerBucket);
+    int32_t sorted[kSamplesPerBucket];
+    size_t uncensored = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!history.samples[i].censored)
+            sorted[uncensored++] = history.samples[i].ms;
+    }
+    size_t rank = (n * mPercentile + 99) / 100 - 1;
+
+    int32_t learned;
+    if (rank < uncensored) {
+        std::nth_element(sorted, sorted + rank, sorted + uncensored);
+        learned = std::clamp(sorted[rank] + kAdaptiveMarginMs, kAdaptiveMinMs, mMaxDurationMs);
+    } else {
+        // Too many boosts time out to place the percentile: the bucket is
+        // saturated, so close half the gap to the longest boost each time.
+        int32_t current = std::max(mLearnedMs[bucket].load(std::memory_order_relaxed),
+                                   mDurationMs.load());
+        learned = std::min(current + (mMaxDurationMs - current + 1) / 2, mMaxDurationMs);
+    }
+    mLearnedMs[bucket].store(learned, std::memory_order_relaxed);
+}
+
+void InteractionHandler::DumpToFd(int fd) {
+    std::string buf(android::base::StringPrintf(
+            "InteractionHandler:\n  Adaptive: %s (p%d)\n",
+            mAdaptive ? "true" : "false", mPercentile));
+    std::unique_lock<std::mutex> lk(mHistoryLock);
+    BoostHistory histories[kBucketCount];
+    std::copy(mHistory, mHistory + kBucketCount, histories);
+    lk.unlock();
+
+    for (int i = 0; i < kBucketCount; i++) {
+        const BoostHistory &history = histories[i];
+        int32_t learned = mLearnedMs[i].load(std::memory_order_relaxed);
+        if (i < kBucketCount - 1)
+            android::base::StringAppendF(&buf, "  <=%dms:", kBucketLimitsMs[i]);
+        else
+            android::base::StringAppendF(&buf, "  >%dms:", kBucketLimitsMs[i - 1]);
+        android::base::StringAppendF(&buf,
+                " learned %d ms, %" PRIu64 " idle, %" PRIu64 " timeout releases\n",
+                learned, history.idleReleases, history.timeoutReleases);
+    }
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        ALOGE("%s: failed to dump state to fd", __func__);
+    }
+}
+
+void InteractionHandler::ArmTimer(int64_t when_ns) {
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = when_ns / NSINSEC;
+    spec.it_value.tv_nsec = when_ns % NSINSEC;
+    if (timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0)
+        ALOGE("%s: failed to arm timer (%d)", __func__, errno);
 }
 
 void InteractionHandler::Acquire(int32_t duration) {
     ATRACE_CALL();
 
-    std::lock_guard<std::mutex> lk(mLock);
-    if (mState == INTERACTION_STATE_UNINITIALIZED)
+    enum interaction_state state = mState.load();
+    if (state == INTERACTION_STATE_UNINITIALIZED)
         return;
 
-    int inputDuration = duration + 650;
-    int finalDuration;
-    if (inputDuration > mMaxDurationMs)
-        finalDuration = mMaxDurationMs;
-    else if (inputDuration > mMinDurationMs)
-        finalDuration = inputDuration;
-    else
-        finalDuration = mMinDurationMs;
+    int bucket = BucketOf(duration);
+    int32_t learned = mLearnedMs[bucket].load(std::memory_order_relaxed);
+    int finalDuration = learned > 0 ? learned : StaticDuration(duration);
 
-    struct timespec cur_timespec;
-    clock_gettime(CLOCK_MONOTONIC, &cur_timespec);
-    if (mState != INTERACTION_STATE_IDLE && finalDuration <= mDurationMs) {
-        long long elapsed_time = CalcTimespecDiffMs(mLastTimespec, cur_timespec);
+    int64_t now = NowNs();
+    if (state == INTERACTION_STATE_INTERACTION &&
+        now + finalDuration * NSINMS <= mStartNs.load() + mDurationMs.load() * NSINMS) {
         // don't hint if previous hint's duration covers this hint's duration
-        if (elapsed_time <= (mDurationMs - finalDuration)) {
-            ALOGV("%s: Previous duration (%d) cover this (%d) elapsed: %lld",
-                  __func__, mDurationMs, finalDuration, elapsed_time);
-            return;
-        }
+        ALOGV("%s: Previous duration (%d) cover this (%d)", __func__,
+              mDurationMs.load(), finalDuration);
+        return;
     }
-    mLastTimespec = cur_timespec;
-    mDurationMs = finalDuration;
 
     ALOGV("%s: input: %d final duration: %d", __func__,
           duration, finalDuration);
 
-    if (mState == INTERACTION_STATE_WAITING)
-        AbortWaitLocked();
-    else if (mState == INTERACTION_STATE_IDLE)
-        PerfLock();
+    int64_t idleCheck = now + mWaitMs * NSINMS;
+    mBucket.store(bucket);
+    mStartNs.store(now);
+    mDurationMs.store(finalDuration);
+    mDeadlineNs.store(idleCheck + finalDuration * NSINMS);
+    mIdleCheckNs.store(idleCheck);
+
+    // The stores above are ordered before this load, so a release racing
+    // with us either sees the new idle check time or is seen here.
+    if (mState.load() != INTERACTION_STATE_INTERACTION) {
+        std::lock_guard<std::mutex> lk(mLock);
+        if (mState == INTERACTION_STATE_UNINITIALIZED)
+            return;
+        if (mState == INTERACTION_STATE_IDLE) {
+            PerfLock();
+            mState = INTERACTION_STATE_INTERACTION;
+        }
+    }
 
-    mState = INTERACTION_STATE_INTERACTION;
-    mCond.notify_one();
+    ArmTimer(idleCheck);
 }
 
-void InteractionHandler::Release() {
+void InteractionHandler::TryRelease(bool idle) {
     std::lock_guard<std::mutex> lk(mLock);
-    if (mState == INTERACTION_STATE_WAITING) {
-        ATRACE_CALL();
-        PerfRel();
-        mState = INTERACTION_STATE_IDLE;
-    } else {
-        // clear any wait aborts pending in event fd
-        uint64_t val;
-        ssize_t ret = read(mEventFd, &val, sizeof(val));
+    if (mState != INTERACTION_STATE_INTERACTION)
+        return;
 
-        ALOGW_IF(ret < 0, "%s: failed to clear eventfd (%zd, %d)",
-                 __func__, ret, errno);
+    mState = INTERACTION_STATE_IDLE;
+    if (mIdleCheckNs.load() > NowNs()) {
+        // Acquire() extended the boost while we were deciding; keep it.
+        mState = INTERACTION_STATE_INTERACTION;
+        return;
     }
-}
 
-// should be called while locked
-void InteractionHandler::AbortWaitLocked() {
-    uint64_t val = 1;
-    ssize_t ret = write(mEventFd, &val, sizeof(val));
-    if (ret != sizeof(val))
-        ALOGW("Unable to write to event fd (%zd)", ret);
+    ATRACE_CALL();
+    PerfRel();
+    RecordRelease(idle);
 }
 
-void InteractionHandler::WaitForIdle(int32_t wait_ms, int32_t timeout_ms) {
+int InteractionHandler::ReadIdleState() {
     char data[MAX_LENGTH];
-    ssize_t ret;
-    struct pollfd pfd[2];
 
-    ATRACE_CALL();
+    // Errors are logged by the node cache
+    ssize_t ret = node_cache_read(FB_IDLE_PATH, data, sizeof(data));
+    if (ret == 0)
+        ALOGE("%s: Unexpected EOF!", __func__);
+    if (ret <= 0)
+        return ret < 0 ? ret : 0;
 
-    ALOGV("%s: wait:%d timeout:%d", __func__, wait_ms, timeout_ms);
+    return !strncmp(data, "idle", 4);
+}
 
-    pfd[0].fd = mEventFd;
-    pfd[0].events = POLLIN;
-    pfd[1].fd = mIdleFd;
-    pfd[1].events = POLLPRI | POLLERR;
+bool InteractionHandler::IsIdle() {
+    return ReadIdleState() > 0;
+}
 
-    ret = poll(pfd, 1, wait_ms);
-    if (ret > 0) {
-        ALOGV("%s: wait aborted", __func__);
-        return;
-    } else if (ret < 0) {
-        ALOGE("%s: error in poll while waiting", __func__);
+void InteractionHandler::StopWatchingIdle() {
+    ALOGE("%s: idle state unreadable, polling it from the timer", __func__);
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_DEL, mIdleFd, nullptr) < 0)
+        ALOGE("%s: failed to remove idle fd from epoll (%d)", __func__, errno);
+    mIdleWatched = false;
+}
+
+void InteractionHandler::HandleTimer() {
+    uint64_t expirations;
+    if (read(mTimerFd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+        ALOGW("%s: failed to read timer fd (%d)", __func__, errno);
+
+    if (mState != INTERACTION_STATE_INTERACTION)
         return;
+
+    int64_t now = NowNs();
+    int64_t idleCheck = mIdleCheckNs.load();
+    int64_t deadline = mDeadlineNs.load();
+
+    if (now >= deadline) {
+        ALOGV("%s: timed out waiting for idle", __func__);
+        TryRelease(false);
+    } else if (now < idleCheck) {
+        // Acquire() moved the idle check out after the timer fired
+        ArmTimer(idleCheck);
+    } else if (IsIdle()) {
+        ALOGV("%s: already idle", __func__);
+        TryRelease(true);
+    } else {
+        ArmTimer(mIdleWatched ? deadline : std::min<int64_t>(deadline, now + mWaitMs * NSINMS));
+        // Catch an Acquire() that re-armed the timer just before we did
+        if (mIdleCheckNs.load() != idleCheck)
+            ArmTimer(mIdleCheckNs.load());
     }
+}
 
-    ret = pread(mIdleFd, data, sizeof(data), 0);
-    if (!ret) {
-        ALOGE("%s: Unexpected EOF!", __func__);
+void InteractionHandler::HandleIdle() {
+    // Reading the node also re-arms its notification. A failed read does
+    // not, and the level-triggered EPOLLPRI would wake us again at once.
+    int state = ReadIdleState();
+    if (state < 0) {
+        StopWatchingIdle();
         return;
     }
+    if (!state)
+        return;
 
-    if (!strncmp(data, "idle", 4)) {
-        ALOGV("%s: already idle", __func__);
+    if (mIdleListener)
+        mIdleListener(NowNs());
+
+    if (mState != INTERACTION_STATE_INTERACTION || NowNs() < mIdleCheckNs.load())
         return;
-    }
 
-    ret = poll(pfd, 2, timeout_ms);
-    if (ret < 0)
-        ALOGE("%s: Error on waiting for idle (%zd)", __func__, ret);
-    else if (ret == 0)
-        ALOGV("%s: timed out waiting for idle", __func__);
-    else if (pfd[0].revents)
-        ALOGV("%s: wait for idle aborted", __func__);
-    else if (pfd[1].revents)
-        ALOGV("%s: idle detected", __func__);
+    ALOGV("%s: idle detected", __func__);
+    TryRelease(true);
 }
 
 void InteractionHandler::Routine() {
-    std::unique_lock<std::mutex> lk(mLock, std::defer_lock);
+    struct epoll_event events[3];
 
     while (true) {
-        lk.lock();
-        mCond.wait(lk, [&] { return mState != INTERACTION_STATE_IDLE; });
-        if (mState == INTERACTION_STATE_UNINITIALIZED)
+        int n = epoll_wait(mEpollFd, events, 3, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            ALOGE("%s: error in epoll_wait (%d)", __func__, errno);
             return;
-        mState = INTERACTION_STATE_WAITING;
-        lk.unlock();
+        }
 
-        WaitForIdle(mWaitMs, mDurationMs);
-        Release();
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.fd == mEventFd)
+                return;
+            else if (events[i].data.fd == mTimerFd)
+                HandleTimer();
+            else if (events[i].data.fd == mIdleFd)
+                HandleIdle();
+        }
     }
 }
@@ -17,7 +17,8 @@
 #ifndef INTERACTIONHANDLER_H
 #define INTERACTIONHANDLER_H
 
-#include <condition_variable>
+#include <atomic>
+#include <functional>
 #include <mutex>
 #include <thread>
 
@@ -29,42 +30,99 @@ enum interaction_state {
     INTERACTION_STATE_UNINITIALIZED,
     INTERACTION_STATE_IDLE,
     INTERACTION_STATE_INTERACTION,
-    INTERACTION_STATE_WAITING,
 };
 
+// Holds the INTERACTION hint for a while after each touch. A single epoll
+// loop owns a timerfd for the boost deadline, the display idle_state node
+// and an eventfd used to stop the loop; Acquire() only publishes the new
+// deadline and re-arms the timer.
 struct InteractionHandler {
     InteractionHandler(std::shared_ptr<HintManager> const & hint_manager);
     ~InteractionHandler();
     bool Init();
     void Exit();
     void Acquire(int32_t duration);
+    void DumpToFd(int fd);
+
+    // Told the CLOCK_MONOTONIC time of every display idle transition, on
+    // the handler thread. Must be set before Init().
+    void SetIdleListener(std::function<void(int64_t)> listener) {
+        mIdleListener = std::move(listener);
+    }
 
  private:
-    void Release();
-    void WaitForIdle(int32_t wait_ms, int32_t timeout_ms);
-    void AbortWaitLocked();
+    static constexpr int kBucketCount = 5;
+    static constexpr int kSamplesPerBucket = 32;
+
+    // How long boosts of one requested-duration bucket actually took to
+    // reach display idle, measured from the idle check. A boost that timed
+    // out only tells us idle came later than that: it is censored.
+    struct BoostSample {
+        int32_t ms;
+        bool censored;
+    };
+
+    struct BoostHistory {
+        BoostSample samples[kSamplesPerBucket];
+        size_t count;
+        uint64_t idleReleases;
+        uint64_t timeoutReleases;
+    };
+
+    static int BucketOf(int32_t duration);
+    int32_t StaticDuration(int32_t duration) const;
+    void RecordRelease(bool idle);
+
     void Routine();
+    void HandleTimer();
+    void HandleIdle();
+    int ReadIdleState();
+    bool IsIdle();
+    void StopWatchingIdle();
+    void ArmTimer(int64_t when_ns);
+    void TryRelease(bool idle);
 
     void PerfLock();
     void PerfRel();
 
-    long long CalcTimespecDiffMs(struct timespec start, struct timespec end);
-
-    enum interaction_state mState;
+    std::atomic<enum interaction_state> mState;
 
     int mIdleFd;
     int mEventFd;
+    int mTimerFd;
+    int mEpollFd;
+    // Whether idle_state wakes the loop; if not, the timer polls it every
+    // mWaitMs while boosted. Handler thread only after Init().
+    bool mIdleWatched;
 
     int32_t mWaitMs;
     int32_t mMinDurationMs;
     int32_t mMaxDurationMs;
-    int32_t mDurationMs;
+    std::atomic<int32_t> mDurationMs;
+
+    // Adaptive sizing: history per bucket, guarded by mHistoryLock, and
+    // the duration learned from it, read locklessly by Acquire().
+    bool mAdaptive;
+    int mPercentile;
+    std::atomic<int> mBucket;
+    BoostHistory mHistory[kBucketCount];
+    std::atomic<int32_t> mLearnedMs[kBucketCount];
+
+    // CLOCK_MONOTONIC times of the current boost: when it was last
+    // extended, when to first look at the display idle state, and when to
+    // give up waiting for idle.
+    std::atomic<int64_t> mStartNs;
+    std::atomic<int64_t> mIdleCheckNs;
+    std::atomic<int64_t> mDeadlineNs;
 
-    struct timespec mLastTimespec;
+    std::function<void(int64_t)> mIdleListener;
 
     std::unique_ptr<std::thread> mThread;
+    // Serializes taking and dropping the hint against each other
     std::mutex mLock;
-    std::condition_variable mCond;
+    // Taken under mLock on release, alone by dumps, so a dump never holds
+    // up a touch boost.
+    std::mutex mHistoryLock;
     std::shared_ptr<HintManager> mHintManager;
 };
 
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//#define LOG_NDEBUG 0
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+
+#include <inttypes.h>
+#include <time.h>
+
+#include <algorithm>
+#include <memory>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
+#include <json/reader.h>
+#include <json/value.h>
+#include <utils/Log.h>
+
+#include "LaunchProfiler.h"
+
+#define NSINSEC 1000000000LL
+#define NSINMS 1000000LL
+
+constexpr char kAdaptiveProp[] = "vendor.powerhal.launch.adaptive";
+constexpr char kPercentileProp[] = "vendor.powerhal.launch.percentile";
+
+static constexpr size_t kMinSamples = 8;
+// Display idle this soon after LAUNCH on is the screen before the launch
+// started drawing, not the end of it.
+static constexpr int64_t kIdleGraceNs = 200 * NSINMS;
+// Added on top of the learned percentile
+static constexpr int32_t kMarginMs = 200;
+static constexpr int32_t kMinTimeoutMs = 500;
+static constexpr int32_t kHistogramStepMs = 500;
+
+static const char *const kEndNames[] = {"off", "idle", "timeout"};
+
+static int64_t NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSINSEC + ts.tv_nsec;
+}
+
+LaunchProfiler::LaunchProfiler(std::chrono::milliseconds max_timeout)
+    : mMaxMs(max_timeout.count()),
+      mAdaptive(android::base::GetBoolProperty(kAdaptiveProp, false)),
+      mPercentile(android::base::GetIntProperty(kPercentileProp, 90, 1, 100)),
+      mStartNs(0),
+      mSamples(),
+      mCount(0),
+      mEnds(),
+      mLearnedMs(0) {
+}
+
+// should be called while locked
+void LaunchProfiler::EndLocked(int64_t endNs, EndReason reason) {
+    int32_t usefulMs = std::clamp<int64_t>((endNs - mStartNs) / NSINMS, 0, mMaxMs);
+    mStartNs = 0;
+    mSamples[mCount % kHistorySize] = usefulMs;
+    mCount++;
+    mEnds[reason]++;
+    ALOGV("%s: launch took %d ms (%s)", __func__, usefulMs, kEndNames[reason]);
+
+    if (!mAdaptive || mCount < kMinSamples)
+        return;
+
+    size_t n = std::min<uint64_t>(mCount, kHistorySize);
+    int32_t sorted[kHistorySize];
+    std::copy(mSamples, mSamples + n, sorted);
+    size_t rank = (n * mPercentile + 99) / 100 - 1;
+    std::nth_element(sorted, sorted + rank, sorted + n);
+
+    int32_t learned = std::clamp(sorted[rank] + kMarginMs, std::min(kMinTimeoutMs, mMaxMs),
+                                 mMaxMs);
+    mLearnedMs.store(learned, std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds LaunchProfiler::OnLaunchStart() {
+    int64_t now = NowNs();
+    std::lock_guard<std::mutex> lk(mLock);
+
+    // A launch that got neither signal ran the whole boost.
+    if (mStartNs && now - mStartNs >= mMaxMs * NSINMS)
+        EndLocked(mStartNs + mMaxMs * NSINMS, END_TIMEOUT);
+    if (!mStartNs)
+        mStartNs = now;
+    return GetTimeout();
+}
+
+void LaunchProfiler::OnLaunchEnd() {
+    int64_t now = NowNs();
+    std::lock_guard<std::mutex> lk(mLock);
+    if (mStartNs)
+        EndLocked(now, now - mStartNs >= mMaxMs * NSINMS ? END_TIMEOUT : END_OFF);
+}
+
+void LaunchProfiler::OnDisplayIdle(int64_t nowNs) {
+    std::lock_guard<std::mutex> lk(mLock);
+    if (!mStartNs || nowNs - mStartNs < kIdleGraceNs)
+        return;
+    EndLocked(nowNs, nowNs - mStartNs >= mMaxMs * NSINMS ? END_TIMEOUT : END_IDLE);
+}
+
+std::chrono::milliseconds LaunchProfiler::GetTimeout() const {
+    int32_t learned = mLearnedMs.load(std::memory_order_relaxed);
+    return std::chrono::milliseconds(learned > 0 ? learned : mMaxMs);
+}
+
+void LaunchProfiler::DumpToFd(int fd) const {
+    // Copy out so formatting does not hold up LAUNCH hints
+    std::unique_lock<std::mutex> lk(mLock);
+    int32_t samples[kHistorySize];
+    std::copy(mSamples, mSamples + kHistorySize, samples);
+    uint64_t count = mCount;
+    uint64_t ends[END_COUNT];
+    std::copy(mEnds, mEnds + END_COUNT, ends);
+    lk.unlock();
+
+    std::string buf(android::base::StringPrintf(
+            "LaunchProfiler:\n  Adaptive: %s (p%d), timeout %" PRId64 " ms of %d ms\n"
+            "  Launches: %" PRIu64 " (",
+            mAdaptive ? "true" : "false", mPercentile,
+            static_cast<int64_t>(GetTimeout().count()), mMaxMs, count));
+    for (int i = 0; i < END_COUNT; i++) {
+        android::base::StringAppendF(&buf, "%s%" PRIu64 " %s", i ? ", " : "", ends[i],
+                                     kEndNames[i]);
+    }
+    buf += ")\n";
+
+    size_t n = std::min<uint64_t>(count, kHistorySize);
+    for (int32_t low = 0; low < mMaxMs; low += kHistogramStepMs) {
+        int32_t high = std::min(low + kHistogramStepMs, mMaxMs);
+        size_t hits = std::count_if(samples, samples + n, [&](int32_t s) {
+            return s >= low && (s < high || high == mMaxMs);
+        });
+        android::base::StringAppendF(&buf, "  %5d-%5d ms: %zu\n", low, high, hits);
+    }
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump launch profile to fd";
+    }
+}
+
+std::chrono::milliseconds LaunchProfiler::ParseMaxDuration(const std::string &json_doc,
+                                                           const std::string &hint) {
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errorMessage;
+    int64_t duration = 0;
+
+    if (!reader->parse(json_doc.c_str(), json_doc.c_str() + json_doc.size(), &root,
+                       &errorMessage)) {
+        LOG(ERROR) << "Failed to parse JSON config: " << errorMessage;
+        return std::chrono::milliseconds(0);
+    }
+
+    Json::Value actions = root["Actions"];
+    for (Json::Value::ArrayIndex i = 0; i < actions.size(); ++i) {
+        if (actions[i]["PowerHint"].asString() == hint)
+            duration = std::max<int64_t>(duration, actions[i]["Duration"].asInt64());
+    }
+    return std::chrono::milliseconds(duration);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LAUNCHPROFILER_H
+#define LAUNCHPROFILER_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+// Learns how long LAUNCH boosts stay useful. A launch is over at LAUNCH
+// off or at the first display idle transition after it started, whichever
+// comes first; the boost timeout is a percentile of recent launches,
+// never longer than the timeout powerhint.json gives LAUNCH.
+struct LaunchProfiler {
+    LaunchProfiler(std::chrono::milliseconds max_timeout);
+
+    // LAUNCH on. Returns the timeout to boost for.
+    std::chrono::milliseconds OnLaunchStart();
+    // LAUNCH off.
+    void OnLaunchEnd();
+    void OnDisplayIdle(int64_t nowNs);
+
+    std::chrono::milliseconds GetTimeout() const;
+    void DumpToFd(int fd) const;
+
+    // Longest Duration of the hint's actions in a powerhint.json document.
+    static std::chrono::milliseconds ParseMaxDuration(const std::string &json_doc,
+                                                      const std::string &hint);
+
+ private:
+    static constexpr size_t kHistorySize = 64;
+
+    enum EndReason { END_OFF, END_IDLE, END_TIMEOUT, END_COUNT };
+
+    void EndLocked(int64_t endNs, EndReason reason);
+
+    const int32_t mMaxMs;
+    const bool mAdaptive;
+    const int mPercentile;
+
+    // CLOCK_MONOTONIC start of the launch in progress, or 0
+    int64_t mStartNs;
+    int32_t mSamples[kHistorySize];
+    uint64_t mCount;
+    uint64_t mEnds[END_COUNT];
+    std::atomic<int32_t> mLearnedMs;
+    mutable std::mutex mLock;
+};
+
+#endif //LAUNCHPROFILER_H
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//#define LOG_NDEBUG 0
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+
+#include <inttypes.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <utils/Log.h>
+
+#include "PerfLockServer.h"
+
+PerfLockServer::PerfLockServer(Listener listener)
+    : mListener(std::move(listener)),
+      mSocketFd(-1),
+      mEventFd(-1),
+      mLevels(),
+      mClientCount(0),
+      mMessages(0) {
+}
+
+PerfLockServer::~PerfLockServer() {
+    Exit();
+}
+
+bool PerfLockServer::Init(int socket_fd) {
+    if (socket_fd < 0 || listen(socket_fd, kMaxClients) < 0) {
+        ALOGE("Unable to listen for perf locks (%d)", socket_fd < 0 ? socket_fd : errno);
+        return false;
+    }
+
+    mEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mEventFd < 0) {
+        ALOGE("Unable to create event fd (%d)", errno);
+        return false;
+    }
+    mSocketFd = socket_fd;
+
+    mThread = std::make_unique<std::thread>(&PerfLockServer::Routine, this);
+
+    return true;
+}
+
+void PerfLockServer::Exit() {
+    if (!mThread)
+        return;
+
+    uint64_t val = 1;
+    ssize_t ret = write(mEventFd, &val, sizeof(val));
+    if (ret != sizeof(val))
+        ALOGW("Unable to write to event fd (%zd)", ret);
+    mThread->join();
+    mThread.reset();
+
+    for (const auto &client : mClients)
+        close(client.fd);
+    mClients.clear();
+    close(mEventFd);
+}
+
+void PerfLockServer::Accept() {
+    int fd = accept4(mSocketFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        ALOGW("%s: unable to accept (%d)", __func__, errno);
+        return;
+    }
+    if (mClients.size() == kMaxClients) {
+        ALOGE("%s: too many perf lock clients", __func__);
+        close(fd);
+        return;
+    }
+    mClients.push_back({fd, {}});
+}
+
+bool PerfLockServer::Receive(Client *client) {
+    PerfLockLevel message;
+    ssize_t len;
+    while ((len = recv(client->fd, &message, sizeof(message), 0)) == sizeof(message)) {
+        if (message.resource >= PERF_LOCK_RESOURCE_COUNT) {
+            ALOGW("%s: unknown resource %" PRIu32, __func__, message.resource);
+            continue;
+        }
+        PerfLockResource resource = static_cast<PerfLockResource>(message.resource);
+        client->levels[resource] = std::clamp<int>(message.level, 0, kPerfLockLevelCount);
+        Update(resource);
+        std::lock_guard<std::mutex> lk(mLock);
+        mMessages++;
+    }
+    return len != 0 && (len > 0 || errno == EAGAIN || errno == EINTR);
+}
+
+void PerfLockServer::Update(PerfLockResource resource) {
+    int level = 0;
+    for (const auto &client : mClients)
+        level = std::max(level, client.levels[resource]);
+    if (level == mLevels[resource])
+        return;
+    mLevels[resource] = level;
+    mListener(resource, level);
+}
+
+void PerfLockServer::Routine() {
+    std::vector<struct pollfd> pfds;
+
+    while (true) {
+        pfds.clear();
+        pfds.push_back({mEventFd, POLLIN, 0});
+        pfds.push_back({mSocketFd, POLLIN, 0});
+        for (const auto &client : mClients)
+            pfds.push_back({client.fd, POLLIN, 0});
+
+        int ret = poll(pfds.data(), pfds.size(), -1);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            ALOGE("%s: error in poll (%d)", __func__, errno);
+            return;
+        }
+        if (pfds[0].revents)
+            return;
+
+        // Walk back so dropping a client leaves the indexes below intact
+        for (size_t i = mClients.size(); i > 0; i--) {
+            if (!pfds[i + 1].revents || Receive(&mClients[i - 1]))
+                continue;
+            Client client = mClients[i - 1];
+            mClients.erase(mClients.begin() + i - 1);
+            close(client.fd);
+            for (int r = 0; r < PERF_LOCK_RESOURCE_COUNT; r++) {
+                if (client.levels[r])
+                    Update(static_cast<PerfLockResource>(r));
+            }
+        }
+        if (pfds[1].revents)
+            Accept();
+
+        std::lock_guard<std::mutex> lk(mLock);
+        mClientCount = mClients.size();
+    }
+}
+
+void PerfLockServer::DumpToFd(int fd) const {
+    std::lock_guard<std::mutex> lk(mLock);
+    std::string buf(android::base::StringPrintf(
+            "PerfLock clients: %zu, %" PRIu64 " level changes received\n", mClientCount,
+            mMessages));
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump perf lock clients to fd";
+    }
+}
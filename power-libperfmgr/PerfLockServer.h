@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PERFLOCKSERVER_H
+#define PERFLOCKSERVER_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PerfLockHints.h"
+
+// Serves the perf lock socket of libqti-perfd-client, see PerfLockHints.h.
+// Each connection holds its own levels; a resource is held at the highest
+// of them, and a connection that closes, e.g. as its process died, no
+// longer holds anything.
+struct PerfLockServer {
+    // Told the level a resource is held at whenever it changes, on the
+    // server thread.
+    using Listener = std::function<void(PerfLockResource resource, int level)>;
+
+    PerfLockServer(Listener listener);
+    ~PerfLockServer();
+    // Serves the bound socket, e.g. the one init created for the service.
+    bool Init(int socket_fd);
+    void Exit();
+
+    void DumpToFd(int fd) const;
+
+ private:
+    static constexpr size_t kMaxClients = 16;
+
+    struct Client {
+        int fd;
+        int levels[PERF_LOCK_RESOURCE_COUNT];
+    };
+
+    void Accept();
+    // Returns false once the connection is closed.
+    bool Receive(Client *client);
+    void Update(PerfLockResource resource);
+    void Routine();
+
+    const Listener mListener;
+    int mSocketFd;
+    int mEventFd;
+    // Owned by the thread
+    std::vector<Client> mClients;
+    int mLevels[PERF_LOCK_RESOURCE_COUNT];
+
+    std::unique_ptr<std::thread> mThread;
+    // Guards the counts below, for dumps
+    mutable std::mutex mLock;
+    size_t mClientCount;
+    uint64_t mMessages;
+};
+
+#endif //PERFLOCKSERVER_H
@@ -17,23 +17,24 @@
 #define ATRACE_TAG (ATRACE_TAG_POWER | ATRACE_TAG_HAL)
 #define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
 
+#include <inttypes.h>
+
+#include <algorithm>
+
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/properties.h>
 #include <android-base/strings.h>
 #include <android-base/stringprintf.h>
 
+#include <cutils/sockets.h>
 #include <utils/Log.h>
 #include <utils/Trace.h>
 
 #include "Power.h"
+#include "node-cache.h"
 #include "power-helper.h"
 
-/* RPM runs at 19.2Mhz. Divide by 19200 for msec */
-#define RPM_CLK 19200
-
-extern struct stats_section master_sections[];
-
 namespace android {
 namespace hardware {
 namespace power {
@@ -50,40 +51,111 @@ using ::android::hardware::Return;
 using ::android::hardware::Void;
 
 Power::Power() :
+        mGovernorMonitor(std::make_unique<GovernorMonitor>(std::vector<int>{0, 4})),
+        mStatsSampler(std::make_unique<StatsSampler>(std::chrono::milliseconds(
+                android::base::GetUintProperty(kPowerHalStatsPeriodProp, kStatsPeriodMsDefault,
+                                               kStatsPeriodMsMax)))),
+        mEnergyModel(std::make_unique<EnergyModel>(EnergyModel::DefaultConfig())),
         mHintManager(nullptr),
+        mHintArbiter(nullptr),
         mInteractionHandler(nullptr),
-        mVRModeOn(false),
-        mSustainedPerfModeOn(false),
-        mCameraStreamingModeOn(false),
+        mPerfLockLevels(),
         mReady(false) {
 
+    if (!mGovernorMonitor->Init()) {
+        ALOGE("Unable to monitor governor changes");
+    }
+    mStatsSampler->SetListener([this](const StatsSnapshot &snapshot) {
+        mEnergyModel->OnSample(snapshot);
+    });
+    mStatsSampler->Init();
+    if (android::base::GetBoolProperty(kPowerHalTraceProp, false)) {
+        mHintTrace.Open(kPowerHalTracePath);
+    }
+
     mInitThread =
             std::thread([this](){
                             android::base::WaitForProperty(kPowerHalInitProp, "1");
-                            mHintManager = HintManager::GetFromJSON(kPowerHalConfigPath);
+                            std::vector<HintPriority> priorities;
+                            std::chrono::milliseconds launchMax(0);
+                            std::unique_ptr<PowerHintTable> table =
+                                    PowerHintTable::Open(kPowerHalTablePath, kPowerHalConfigPath);
+                            if (table) {
+                                mHintManager = table->CreateHintManager();
+                                priorities = table->GetPriorities();
+                                launchMax = table->GetMaxDuration("LAUNCH");
+                            }
                             if (!mHintManager) {
-                                LOG(FATAL) << "Invalid config: " << kPowerHalConfigPath;
+                                ALOGI("Falling back to JSON config");
+                                mHintManager = HintManager::GetFromJSON(kPowerHalConfigPath);
+                                if (!mHintManager) {
+                                    LOG(FATAL) << "Invalid config: " << kPowerHalConfigPath;
+                                }
+                                std::string json_doc;
+                                if (android::base::ReadFileToString(kPowerHalConfigPath,
+                                                                    &json_doc)) {
+                                    priorities = HintArbiter::ParsePriorities(json_doc);
+                                    launchMax = LaunchProfiler::ParseMaxDuration(json_doc,
+                                                                                 "LAUNCH");
+                                }
+                            }
+                            if (priorities.empty()) {
+                                ALOGI("No hint priorities in config, using defaults");
+                                priorities = HintArbiter::DefaultPriorities();
+                            }
+                            mHintArbiter = std::make_unique<HintArbiter>(mHintManager,
+                                                                         std::move(priorities));
+                            std::vector<std::string> levels;
+                            for (int i = 0; i < kSustainedLevelCount; i++) {
+                                levels.push_back(android::base::StringPrintf(
+                                        "SUSTAINED_PERFORMANCE_LEVEL_%d", i));
                             }
+                            mSustainedPerfController = std::make_unique<SustainedPerfController>(
+                                    mHintManager, std::move(levels), kSustainedStaticLevel);
+                            if (!mSustainedPerfController->Init()) {
+                                ALOGE("Unable to follow thermal zone, using static caps");
+                            }
+                            mHintArbiter->SetListener([this](const std::string &hint,
+                                                             bool applied) {
+                                if (hint != "SUSTAINED_PERFORMANCE")
+                                    return;
+                                if (applied)
+                                    mSustainedPerfController->Start();
+                                else
+                                    mSustainedPerfController->Stop();
+                            });
+                            if (launchMax.count() <= 0) {
+                                launchMax = std::chrono::milliseconds(kLaunchBoostMsDefault);
+                            }
+                            mLaunchProfiler = std::make_unique<LaunchProfiler>(launchMax);
                             mInteractionHandler = std::make_unique<InteractionHandler>(mHintManager);
+                            mInteractionHandler->SetIdleListener([this](int64_t nowNs) {
+                                mLaunchProfiler->OnDisplayIdle(nowNs);
+                                mHintTrace.Record(HintTraceRecorder::kDisplayIdle, 1, nowNs);
+                            });
                             mInteractionHandler->Init();
+                            std::vector<std::string> boostLevels;
+                            for (int i = 0; i < kSessionBoostLevelCount; i++) {
+                                boostLevels.push_back(android::base::StringPrintf(
+                                        "SESSION_BOOST_%d", i));
+                            }
+                            mHintSessionManager = std::make_unique<HintSessionManager>(
+                                    mHintManager, std::move(boostLevels));
+                            mHintSessionManager->Init();
                             std::string state = android::base::GetProperty(kPowerHalStateProp, "");
                             if (state == "CAMERA_STREAMING") {
                                 ALOGI("Initialize with CAMERA_STREAMING on");
-                                mHintManager->DoHint("CAMERA_STREAMING");
-                                mCameraStreamingModeOn = true;
+                                mHintArbiter->Request("CAMERA_STREAMING");
                             } else if (state ==  "SUSTAINED_PERFORMANCE") {
                                 ALOGI("Initialize with SUSTAINED_PERFORMANCE on");
-                                mHintManager->DoHint("SUSTAINED_PERFORMANCE");
-                                mSustainedPerfModeOn = true;
+                                mHintArbiter->Request("SUSTAINED_PERFORMANCE");
                             } else if (state == "VR_MODE") {
                                 ALOGI("Initialize with VR_MODE on");
-                                mHintManager->DoHint("VR_MODE");
-                                mVRModeOn = true;
+                                mHintArbiter->Request("VR_MODE");
                             } else if (state == "VR_SUSTAINED_PERFORMANCE") {
                                 ALOGI("Initialize with SUSTAINED_PERFORMANCE and VR_MODE on");
-                                mHintManager->DoHint("VR_SUSTAINED_PERFORMANCE");
-                                mSustainedPerfModeOn = true;
-                                mVRModeOn = true;
+                                mHintArbiter->Request("SUSTAINED_PERFORMANCE");
+                                mHintArbiter->Request("VR_MODE");
                             } else {
                                 ALOGI("Initialize PowerHAL");
                             }
@@ -91,15 +163,28 @@ Power::Power() :
                             state = android::base::GetProperty(kPowerHalAudioProp, "");
                             if (state == "AUDIO_LOW_LATENCY") {
                                 ALOGI("Initialize with AUDIO_LOW_LATENCY on");
-                                mHintManager->DoHint("AUDIO_LOW_LATENCY");
+                                mHintArbiter->Request("AUDIO_LOW_LATENCY");
                             }
 
                             state = android::base::GetProperty(kPowerHalRenderingProp, "");
                             if (state == "EXPENSIVE_RENDERING") {
                                 ALOGI("Initialize with EXPENSIVE_RENDERING on");
-                                mHintManager->DoHint("EXPENSIVE_RENDERING");
+                                mHintArbiter->Request("EXPENSIVE_RENDERING");
                             }
-                            // Now start to take powerhint
+                            mPerfLockServer = std::make_unique<PerfLockServer>(
+                                    [this](PerfLockResource resource, int level) {
+                                        handlePerfLock(resource, level);
+                                    });
+                            if (!mPerfLockServer->Init(
+                                        android_get_control_socket(kPerfLockSocket))) {
+                                ALOGE("Unable to serve perf locks");
+                            }
+                            // Catch up on hints sent while we were starting, then
+                            // start to take powerhint
+                            mHintJournal.Close([this](const HintJournal::Entry &entry,
+                                                      int64_t ageMs) {
+                                replayHint(entry, ageMs);
+                            });
                             mReady.store(true);
                         });
     mInitThread.detach();
@@ -107,78 +192,57 @@ Power::Power() :
 }
 
 // Methods from ::android::hardware::power::V1_0::IPower follow.
-Return<void> Power::setInteractive(bool /* interactive */)  {
+Return<void> Power::setInteractive(bool interactive)  {
+    set_interactive(interactive);
     return Void();
 }
 
 Return<void> Power::powerHint(PowerHint_1_0 hint, int32_t data) {
-    if (!isSupportedGovernor() || !mReady) {
-        return Void();
-    }
+    return powerHintAsync_1_3(static_cast<PowerHint_1_3>(hint), data);
+}
 
+void Power::handleHint_1_0(PowerHint_1_0 hint, int32_t data) {
     switch(hint) {
         case PowerHint_1_0::INTERACTION:
-            if (mVRModeOn || mSustainedPerfModeOn) {
+            if (mHintArbiter->IsSuppressed("INTERACTION")) {
                 ALOGV("%s: ignoring due to other active perf hints", __func__);
+                HintMetrics::Get().RecordSuppressed("INTERACTION");
             } else {
                 mInteractionHandler->Acquire(data);
             }
             break;
         case PowerHint_1_0::SUSTAINED_PERFORMANCE:
-            if (data && !mSustainedPerfModeOn) {
+            if (data && mHintArbiter->Request("SUSTAINED_PERFORMANCE")) {
                 ALOGD("SUSTAINED_PERFORMANCE ON");
-                if (!mVRModeOn) { // Sustained mode only.
-                    mHintManager->DoHint("SUSTAINED_PERFORMANCE");
-                } else { // Sustained + VR mode.
-                    mHintManager->EndHint("VR_MODE");
-                    mHintManager->DoHint("VR_SUSTAINED_PERFORMANCE");
-                }
-                mSustainedPerfModeOn = true;
-            } else if (!data && mSustainedPerfModeOn) {
+            } else if (!data && mHintArbiter->Cancel("SUSTAINED_PERFORMANCE")) {
                 ALOGD("SUSTAINED_PERFORMANCE OFF");
-                mHintManager->EndHint("VR_SUSTAINED_PERFORMANCE");
-                mHintManager->EndHint("SUSTAINED_PERFORMANCE");
-                if (mVRModeOn) { // Switch back to VR Mode.
-                    mHintManager->DoHint("VR_MODE");
-                }
-                mSustainedPerfModeOn = false;
             }
             break;
         case PowerHint_1_0::VR_MODE:
-            if (data && !mVRModeOn) {
+            if (data && mHintArbiter->Request("VR_MODE")) {
                 ALOGD("VR_MODE ON");
-                if (!mSustainedPerfModeOn) { // VR mode only.
-                    mHintManager->DoHint("VR_MODE");
-                } else { // Sustained + VR mode.
-                    mHintManager->EndHint("SUSTAINED_PERFORMANCE");
-                    mHintManager->DoHint("VR_SUSTAINED_PERFORMANCE");
-                }
-                mVRModeOn = true;
-            } else if (!data && mVRModeOn) {
+            } else if (!data && mHintArbiter->Cancel("VR_MODE")) {
                 ALOGD("VR_MODE OFF");
-                mHintManager->EndHint("VR_SUSTAINED_PERFORMANCE");
-                mHintManager->EndHint("VR_MODE");
-                if (mSustainedPerfModeOn) { // Switch back to sustained Mode.
-                    mHintManager->DoHint("SUSTAINED_PERFORMANCE");
-                }
-                mVRModeOn = false;
             }
             break;
         case PowerHint_1_0::LAUNCH:
             ATRACE_BEGIN("launch");
-            if (mVRModeOn || mSustainedPerfModeOn) {
-                ALOGV("%s: ignoring due to other active perf hints", __func__);
-            } else {
-                if (data) {
-                    // Hint until canceled
-                    ATRACE_INT("launch_lock", 1);
-                    mHintManager->DoHint("LAUNCH");
-                    ALOGD("LAUNCH ON");
-                } else {
-                    ATRACE_INT("launch_lock", 0);
-                    mHintManager->EndHint("LAUNCH");
-                    ALOGD("LAUNCH OFF");
+            if (data) {
+                // Hint until canceled, or for as long as launches need
+                ATRACE_INT("launch_lock", 1);
+                std::chrono::milliseconds timeout = mLaunchProfiler->OnLaunchStart();
+                mHintArbiter->Request("LAUNCH", timeout);
+                bool queued = mHintArbiter->IsSuppressed("LAUNCH");
+                if (queued) {
+                    HintMetrics::Get().RecordSuppressed("LAUNCH");
                 }
+                ALOGD("LAUNCH ON: %lld MS%s", static_cast<long long>(timeout.count()),
+                      queued ? " (queued)" : "");
+            } else {
+                ATRACE_INT("launch_lock", 0);
+                mLaunchProfiler->OnLaunchEnd();
+                mHintArbiter->Cancel("LAUNCH");
+                ALOGD("LAUNCH OFF");
             }
             ATRACE_END();
             break;
@@ -186,7 +250,80 @@ Return<void> Power::powerHint(PowerHint_1_0 hint, int32_t data) {
             break;
 
     }
-    return Void();
+}
+
+std::chrono::milliseconds Power::cameraLaunchBoost() const {
+    return std::min(mLaunchProfiler->GetTimeout(),
+                    std::chrono::milliseconds(kCameraLaunchBoostMs));
+}
+
+// Apply a hint that arrived before we were ready. Timed hints only get
+// what is left of their duration; the others are applied as last sent.
+void Power::replayHint(const HintJournal::Entry &entry, int64_t ageMs) {
+    PowerHint_1_3 hint = static_cast<PowerHint_1_3>(entry.hint);
+    int32_t data = entry.data;
+
+    switch (hint) {
+        case PowerHint_1_3::INTERACTION: {
+            int64_t remaining = (data > 0 ? data : kInteractionReplayMs) - ageMs;
+            if (remaining > 0 && !mHintArbiter->IsSuppressed("INTERACTION")) {
+                mInteractionHandler->Acquire(static_cast<int32_t>(remaining));
+            }
+            break;
+        }
+        case PowerHint_1_3::CAMERA_LAUNCH:
+            if (data > ageMs) {
+                HintMetrics::DoHint(*mHintManager, "CAMERA_LAUNCH",
+                                    std::chrono::milliseconds(data - ageMs));
+            }
+            if (data > 0 && cameraLaunchBoost().count() > ageMs) {
+                HintMetrics::DoHint(*mHintManager, "LAUNCH",
+                                    cameraLaunchBoost() - std::chrono::milliseconds(ageMs));
+            }
+            break;
+        case PowerHint_1_3::LAUNCH:
+            if (data) {
+                std::chrono::milliseconds remaining =
+                        mLaunchProfiler->OnLaunchStart() - std::chrono::milliseconds(ageMs);
+                if (remaining.count() > 0) {
+                    mHintArbiter->Request("LAUNCH", remaining);
+                }
+            } else {
+                mHintArbiter->Cancel("LAUNCH");
+            }
+            break;
+        case PowerHint_1_3::CAMERA_SHOT:
+            if (data > ageMs) {
+                HintMetrics::DoHint(*mHintManager, "CAMERA_SHOT",
+                                    std::chrono::milliseconds(data - ageMs));
+            }
+            break;
+        case PowerHint_1_3::CAMERA_STREAMING:
+            if (data < 0) {
+                break;
+            }
+            [[fallthrough]];
+        case PowerHint_1_3::SUSTAINED_PERFORMANCE:
+        case PowerHint_1_3::VR_MODE:
+        case PowerHint_1_3::AUDIO_STREAMING:
+        case PowerHint_1_3::AUDIO_LOW_LATENCY:
+            if (data) {
+                mHintArbiter->Request(toString(hint));
+            } else {
+                mHintArbiter->Cancel(toString(hint));
+            }
+            break;
+        case PowerHint_1_3::EXPENSIVE_RENDERING:
+            if (data > 0) {
+                mHintArbiter->Request(toString(hint));
+            } else {
+                mHintArbiter->Cancel(toString(hint));
+            }
+            break;
+        default:
+            break;
+    }
+    ALOGD("Replayed %s: %d, %" PRId64 " MS late", toString(hint).c_str(), data, ageMs);
 }
 
 Return<void> Power::setFeature(Feature feature, bool activate)  {
@@ -194,16 +331,25 @@ Return<void> Power::setFeature(Feature feature, bool activate)  {
     return Void();
 }
 
+void Power::getStatsSnapshot(StatsSnapshot *snapshot) {
+    // Answer from the sampler; only read sysfs here until its first sample.
+    if (!mStatsSampler->GetLatest(snapshot)) {
+        StatsSampler::Sample(snapshot);
+    }
+}
+
 Return<void> Power::getPlatformLowPowerStats(getPlatformLowPowerStats_cb _hidl_cb) {
 
     hidl_vec<PowerStatePlatformSleepState> states;
-    uint64_t stats[SYSTEM_SLEEP_STATE_COUNT * SYSTEM_STATE_STATS_COUNT] = {0};
+    StatsSnapshot snapshot;
+    uint64_t *stats = snapshot.system;
     uint64_t *state_stats;
     struct PowerStatePlatformSleepState *state;
 
+    getStatsSnapshot(&snapshot);
     states.resize(SYSTEM_SLEEP_STATE_COUNT);
 
-    if (extract_system_stats(stats, ARRAY_SIZE(stats)) != 0) {
+    if (!snapshot.systemValid) {
         states.resize(0);
         goto done;
     }
@@ -233,23 +379,24 @@ done:
     return Void();
 }
 
-static int get_master_low_power_stats(hidl_vec<PowerStateSubsystem> *subsystems) {
-    uint64_t all_stats[MASTER_COUNT * MASTER_STATS_COUNT] = {0};
-    uint64_t *section_stats;
+static int get_master_low_power_stats(const StatsSnapshot &snapshot,
+                                      hidl_vec<PowerStateSubsystem> *subsystems) {
+    const uint64_t *all_stats = snapshot.master;
+    const uint64_t *section_stats;
     struct PowerStateSubsystem *subsystem;
     struct PowerStateSubsystemSleepState *state;
 
-    if (extract_master_stats(all_stats, ARRAY_SIZE(all_stats)) != 0) {
-        for (size_t i = 0; i < MASTER_COUNT; i++) {
-            (*subsystems)[i].name = master_sections[i].label;
+    if (!snapshot.masterValid) {
+        for (size_t i = 0; i < snapshot.masterCount; i++) {
+            (*subsystems)[i].name = get_master_label(i);
             (*subsystems)[i].states.resize(0);
         }
         return -1;
     }
 
-    for (size_t i = 0; i < MASTER_COUNT; i++) {
+    for (size_t i = 0; i < snapshot.masterCount; i++) {
         subsystem = &(*subsystems)[i];
-        subsystem->name = master_sections[i].label;
+        subsystem->name = get_master_label(i);
         subsystem->states.resize(MASTER_SLEEP_STATE_COUNT);
 
         state = &(subsystem->states[MASTER_SLEEP]);
@@ -268,11 +415,13 @@ static int get_master_low_power_stats(hidl_vec<PowerStateSubsystem> *subsystems)
 // Methods from ::android::hardware::power::V1_1::IPower follow.
 Return<void> Power::getSubsystemLowPowerStats(getSubsystemLowPowerStats_cb _hidl_cb) {
     hidl_vec<PowerStateSubsystem> subsystems;
+    StatsSnapshot snapshot;
 
-    subsystems.resize(STATS_SOURCE_COUNT);
+    getStatsSnapshot(&snapshot);
+    subsystems.resize(snapshot.masterCount);
 
     // Get low power stats for all of the system masters.
-    if (get_master_low_power_stats(&subsystems) != 0) {
+    if (get_master_low_power_stats(snapshot, &subsystems) != 0) {
         ALOGE("%s: failed to process master stats", __func__);
     }
 
@@ -280,20 +429,6 @@ Return<void> Power::getSubsystemLowPowerStats(getSubsystemLowPowerStats_cb _hidl
     return Void();
 }
 
-bool Power::isSupportedGovernor() {
-    std::string buf;
-    if (android::base::ReadFileToString("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", &buf)) {
-        buf = android::base::Trim(buf);
-    }
-    // Only support EAS 1.2, legacy EAS
-    if (buf == "schedutil" || buf == "sched") {
-        return true;
-    } else {
-        LOG(ERROR) << "Governor not supported by powerHAL, skipping";
-        return false;
-    }
-}
-
 Return<void> Power::powerHintAsync(PowerHint_1_0 hint, int32_t data) {
     // just call the normal power hint in this oneway function
     return powerHint(hint, data);
@@ -301,40 +436,40 @@ Return<void> Power::powerHintAsync(PowerHint_1_0 hint, int32_t data) {
 
 // Methods from ::android::hardware::power::V1_2::IPower follow.
 Return<void> Power::powerHintAsync_1_2(PowerHint_1_2 hint, int32_t data) {
-    if (!isSupportedGovernor() || !mReady) {
-        return Void();
-    }
+    return powerHintAsync_1_3(static_cast<PowerHint_1_3>(hint), data);
+}
 
+void Power::handleHint_1_2(PowerHint_1_2 hint, int32_t data) {
     switch(hint) {
         case PowerHint_1_2::AUDIO_LOW_LATENCY:
             ATRACE_BEGIN("audio_low_latency");
             if (data) {
                 // Hint until canceled
                 ATRACE_INT("audio_low_latency_lock", 1);
-                mHintManager->DoHint("AUDIO_LOW_LATENCY");
+                mHintArbiter->Request("AUDIO_LOW_LATENCY");
                 ALOGD("AUDIO LOW LATENCY ON");
             } else {
                 ATRACE_INT("audio_low_latency_lock", 0);
-                mHintManager->EndHint("AUDIO_LOW_LATENCY");
+                mHintArbiter->Cancel("AUDIO_LOW_LATENCY");
                 ALOGD("AUDIO LOW LATENCY OFF");
             }
             ATRACE_END();
             break;
         case PowerHint_1_2::AUDIO_STREAMING:
             ATRACE_BEGIN("audio_streaming");
-            if (mVRModeOn || mSustainedPerfModeOn) {
-                ALOGV("%s: ignoring due to other active perf hints", __func__);
-            } else {
-                if (data) {
-                    // Hint until canceled
-                    ATRACE_INT("audio_streaming_lock", 1);
-                    mHintManager->DoHint("AUDIO_STREAMING");
-                    ALOGD("AUDIO STREAMING ON");
-                } else {
-                    ATRACE_INT("audio_streaming_lock", 0);
-                    mHintManager->EndHint("AUDIO_STREAMING");
-                    ALOGD("AUDIO STREAMING OFF");
+            if (data) {
+                // Hint until canceled
+                ATRACE_INT("audio_streaming_lock", 1);
+                mHintArbiter->Request("AUDIO_STREAMING");
+                bool queued = mHintArbiter->IsSuppressed("AUDIO_STREAMING");
+                if (queued) {
+                    HintMetrics::Get().RecordSuppressed("AUDIO_STREAMING");
                 }
+                ALOGD("AUDIO STREAMING ON%s", queued ? " (queued)" : "");
+            } else {
+                ATRACE_INT("audio_streaming_lock", 0);
+                mHintArbiter->Cancel("AUDIO_STREAMING");
+                ALOGD("AUDIO STREAMING OFF");
             }
             ATRACE_END();
             break;
@@ -342,13 +477,15 @@ Return<void> Power::powerHintAsync_1_2(PowerHint_1_2 hint, int32_t data) {
             ATRACE_BEGIN("camera_launch");
             if (data > 0) {
                 ATRACE_INT("camera_launch_lock", 1);
-                mHintManager->DoHint("CAMERA_LAUNCH", std::chrono::milliseconds(data));
-                ALOGD("CAMERA LAUNCH ON: %d MS, LAUNCH ON: 2500 MS", data);
-                // boosts 2.5s for launching
-                mHintManager->DoHint("LAUNCH", std::chrono::milliseconds(2500));
+                HintMetrics::DoHint(*mHintManager, "CAMERA_LAUNCH",
+                                    std::chrono::milliseconds(data));
+                ALOGD("CAMERA LAUNCH ON: %d MS, LAUNCH ON: %lld MS", data,
+                      static_cast<long long>(cameraLaunchBoost().count()));
+                // boosts up to 2.5s for launching
+                HintMetrics::DoHint(*mHintManager, "LAUNCH", cameraLaunchBoost());
             } else if (data == 0) {
                 ATRACE_INT("camera_launch_lock", 0);
-                mHintManager->EndHint("CAMERA_LAUNCH");
+                HintMetrics::EndHint(*mHintManager, "CAMERA_LAUNCH");
                 ALOGD("CAMERA LAUNCH OFF");
             } else {
                 ALOGE("CAMERA LAUNCH INVALID DATA: %d", data);
@@ -359,14 +496,12 @@ Return<void> Power::powerHintAsync_1_2(PowerHint_1_2 hint, int32_t data) {
             ATRACE_BEGIN("camera_streaming");
             if (data > 0) {
                 ATRACE_INT("camera_streaming_lock", 1);
-                mHintManager->DoHint("CAMERA_STREAMING");
+                mHintArbiter->Request("CAMERA_STREAMING");
                 ALOGD("CAMERA STREAMING ON");
-                mCameraStreamingModeOn = true;
             } else if (data == 0) {
                 ATRACE_INT("camera_streaming_lock", 0);
-                mHintManager->EndHint("CAMERA_STREAMING");
+                mHintArbiter->Cancel("CAMERA_STREAMING");
                 ALOGD("CAMERA STREAMING OFF");
-                mCameraStreamingModeOn = false;
             } else {
                 ALOGE("CAMERA STREAMING INVALID DATA: %d", data);
             }
@@ -376,11 +511,12 @@ Return<void> Power::powerHintAsync_1_2(PowerHint_1_2 hint, int32_t data) {
             ATRACE_BEGIN("camera_shot");
             if (data > 0) {
                 ATRACE_INT("camera_shot_lock", 1);
-                mHintManager->DoHint("CAMERA_SHOT", std::chrono::milliseconds(data));
+                HintMetrics::DoHint(*mHintManager, "CAMERA_SHOT",
+                                    std::chrono::milliseconds(data));
                 ALOGD("CAMERA SHOT ON: %d MS", data);
             } else if (data == 0) {
                 ATRACE_INT("camera_shot_lock", 0);
-                mHintManager->EndHint("CAMERA_SHOT");
+                HintMetrics::EndHint(*mHintManager, "CAMERA_SHOT");
                 ALOGD("CAMERA SHOT OFF");
             } else {
                 ALOGE("CAMERA SHOT INVALID DATA: %d", data);
@@ -388,55 +524,148 @@ Return<void> Power::powerHintAsync_1_2(PowerHint_1_2 hint, int32_t data) {
             ATRACE_END();
             break;
         default:
-            return powerHint(static_cast<PowerHint_1_0>(hint), data);
+            handleHint_1_0(static_cast<PowerHint_1_0>(hint), data);
+            break;
+    }
+}
+
+// The hints handleHint_1_3() and replayHint() act on. Anything else is
+// whatever value a client sent and not worth keeping until ready.
+static bool isHandledHint(PowerHint_1_3 hint) {
+    switch (hint) {
+        case PowerHint_1_3::INTERACTION:
+        case PowerHint_1_3::SUSTAINED_PERFORMANCE:
+        case PowerHint_1_3::VR_MODE:
+        case PowerHint_1_3::LAUNCH:
+        case PowerHint_1_3::AUDIO_STREAMING:
+        case PowerHint_1_3::AUDIO_LOW_LATENCY:
+        case PowerHint_1_3::CAMERA_LAUNCH:
+        case PowerHint_1_3::CAMERA_STREAMING:
+        case PowerHint_1_3::CAMERA_SHOT:
+        case PowerHint_1_3::EXPENSIVE_RENDERING:
+            return true;
+        default:
+            return false;
     }
-    return Void();
 }
 
 // Methods from ::android::hardware::power::V1_3::IPower follow.
+// Every hint enters here: the 1.0 and 1.2 hints keep their values in 1.3.
 Return<void> Power::powerHintAsync_1_3(PowerHint_1_3 hint, int32_t data) {
-    if (!isSupportedGovernor() || !mReady) {
+    mHintTrace.Record(static_cast<uint32_t>(hint), data);
+    if (!isSupportedGovernor()) {
         return Void();
     }
-
-    if (hint == PowerHint_1_3::EXPENSIVE_RENDERING) {
-        if (mVRModeOn || mSustainedPerfModeOn) {
-            ALOGV("%s: ignoring due to other active perf hints", __func__);
+    if (!mReady) {
+        if (!isHandledHint(hint) || mHintJournal.Record(static_cast<uint32_t>(hint), data)) {
             return Void();
         }
+    }
 
+    HintMetrics::Get().RecordInvocation(toString(hint));
+    handleHint_1_3(hint, data);
+    return Void();
+}
+
+// Perf locks of libqti-perfd-client, as the highest level any of its
+// connections holds a resource at, see PerfLockServer.h.
+void Power::handlePerfLock(PerfLockResource resource, int32_t level) {
+    mHintTrace.Record(HintTraceRecorder::kPerfLock + resource, level);
+
+    std::lock_guard<std::mutex> lk(mPerfLockLock);
+    int32_t old = mPerfLockLevels[resource];
+    if (level == old) {
+        return;
+    }
+    // Raise the new floor before dropping the old one so it never dips
+    if (level) {
+        HintMetrics::DoHint(*mHintManager, android::base::StringPrintf(
+                "PERF_LOCK_%s_%d", kPerfLockResourceNames[resource], level));
+    }
+    if (old) {
+        HintMetrics::EndHint(*mHintManager, android::base::StringPrintf(
+                "PERF_LOCK_%s_%d", kPerfLockResourceNames[resource], old));
+    }
+    mPerfLockLevels[resource] = level;
+    ATRACE_INT(android::base::StringPrintf("PERF_LOCK_%s",
+                                           kPerfLockResourceNames[resource]).c_str(), level);
+}
+
+void Power::handleHint_1_3(PowerHint_1_3 hint, int32_t data) {
+    if (hint == PowerHint_1_3::EXPENSIVE_RENDERING) {
         if (data > 0) {
             ATRACE_INT("EXPENSIVE_RENDERING", 1);
-            mHintManager->DoHint("EXPENSIVE_RENDERING");
+            mHintArbiter->Request("EXPENSIVE_RENDERING");
         } else {
             ATRACE_INT("EXPENSIVE_RENDERING", 0);
-            mHintManager->EndHint("EXPENSIVE_RENDERING");
+            mHintArbiter->Cancel("EXPENSIVE_RENDERING");
         }
     } else {
-        return powerHintAsync_1_2(static_cast<PowerHint_1_2>(hint), data);
+        handleHint_1_2(static_cast<PowerHint_1_2>(hint), data);
     }
-
-    return Void();
 }
 
 constexpr const char* boolToString(bool b) {
     return b ? "true" : "false";
 }
 
-Return<void> Power::debug(const hidl_handle& handle, const hidl_vec<hidl_string>&) {
+Return<void> Power::debug(const hidl_handle& handle, const hidl_vec<hidl_string>& args) {
     if (handle != nullptr && handle->numFds >= 1 && mReady) {
         int fd = handle->data[0];
 
+        std::vector<std::string> options(args.begin(), args.end());
+#ifdef POWERHAL_SESSION_COMMANDS
+        // Lets any caller of debug() boost any thread: development only.
+        if (mHintSessionManager->HandleCommand(options, fd)) {
+            fsync(fd);
+            return Void();
+        }
+#endif
+
+        // Only set_feature() writes go through the node cache, so these
+        // cover the DT2W node and none of the powerhint.json nodes
+        uint64_t writesIssued, writesSkipped;
+        node_cache_get_stats(&writesIssued, &writesSkipped);
+
         std::string buf(android::base::StringPrintf("HintManager Running: %s\n"
                                                     "VRMode: %s\n"
                                                     "CameraStreamingMode: %s\n"
-                                                    "SustainedPerformanceMode: %s\n",
+                                                    "SustainedPerformanceMode: %s\n"
+                                                    "DT2WNodeWrites (no powerhint.json nodes): %" PRIu64 " issued, %" PRIu64 " skipped\n",
                                                     boolToString(mHintManager->IsRunning()),
-                                                    boolToString(mVRModeOn),
-                                                    boolToString(mCameraStreamingModeOn),
-                                                    boolToString(mSustainedPerfModeOn)));
+                                                    boolToString(mHintArbiter->IsRequested("VR_MODE")),
+                                                    boolToString(mHintArbiter->IsRequested("CAMERA_STREAMING")),
+                                                    boolToString(mHintArbiter->IsRequested("SUSTAINED_PERFORMANCE")),
+                                                    writesIssued, writesSkipped));
         // Dump nodes through libperfmgr
         mHintManager->DumpToFd(fd);
+        mHintArbiter->DumpToFd(fd);
+        mGovernorMonitor->DumpToFd(fd);
+        mInteractionHandler->DumpToFd(fd);
+        mLaunchProfiler->DumpToFd(fd);
+        mSustainedPerfController->DumpToFd(fd);
+        mHintSessionManager->DumpToFd(fd);
+        mPerfLockServer->DumpToFd(fd);
+        {
+            std::string locks("PerfLock levels:");
+            std::lock_guard<std::mutex> lk(mPerfLockLock);
+            for (int r = 0; r < PERF_LOCK_RESOURCE_COUNT; r++) {
+                android::base::StringAppendF(&locks, " %s %d", kPerfLockResourceNames[r],
+                                             mPerfLockLevels[r]);
+            }
+            buf += locks + "\n";
+        }
+        mHintJournal.DumpToFd(fd);
+        mHintTrace.DumpToFd(fd);
+        mEnergyModel->DumpToFd(fd);
+        HintMetrics::Get().DumpToFd(fd);
+        for (const auto &arg : options) {
+            if (arg == "--stats-deltas") {
+                mStatsSampler->DumpDeltasToFd(fd);
+            } else if (arg == "--metrics-json") {
+                HintMetrics::Get().DumpJsonToFd(fd);
+            }
+        }
         if (!android::base::WriteStringToFd(buf, fd)) {
             PLOG(ERROR) << "Failed to dump state to fd";
         }
@@ -18,6 +18,7 @@
 #define ANDROID_HARDWARE_POWER_V1_3_POWER_H
 
 #include <atomic>
+#include <mutex>
 #include <thread>
 
 #include <android/hardware/power/1.3/IPower.h>
@@ -25,7 +26,19 @@
 #include <hidl/Status.h>
 #include <perfmgr/HintManager.h>
 
+#include "EnergyModel.h"
+#include "GovernorMonitor.h"
+#include "HintArbiter.h"
+#include "HintJournal.h"
+#include "HintMetrics.h"
+#include "HintSession.h"
+#include "HintTrace.h"
 #include "InteractionHandler.h"
+#include "LaunchProfiler.h"
+#include "PerfLockServer.h"
+#include "PowerHintTable.h"
+#include "StatsSampler.h"
+#include "SustainedPerfController.h"
 
 namespace android {
 namespace hardware {
@@ -37,7 +50,19 @@ using ::android::hardware::power::V1_0::Feature;
 using ::android::hardware::power::V1_3::IPower;
 using ::android::hardware::Return;
 using ::android::hardware::Void;
+using ::EnergyModel;
+using ::GovernorMonitor;
+using ::HintArbiter;
+using ::HintJournal;
+using ::HintMetrics;
+using ::HintSessionManager;
+using ::HintTraceRecorder;
 using ::InteractionHandler;
+using ::LaunchProfiler;
+using ::PowerHintTable;
+using ::StatsSampler;
+using ::StatsSnapshot;
+using ::SustainedPerfController;
 using PowerHint_1_0 = ::android::hardware::power::V1_0::PowerHint;
 using PowerHint_1_2 = ::android::hardware::power::V1_2::PowerHint;
 using PowerHint_1_3 = ::android::hardware::power::V1_3::PowerHint;
@@ -47,7 +72,26 @@ constexpr char kPowerHalStateProp[] = "vendor.powerhal.state";
 constexpr char kPowerHalAudioProp[] = "vendor.powerhal.audio";
 constexpr char kPowerHalInitProp[] = "vendor.powerhal.init";
 constexpr char kPowerHalRenderingProp[] = "vendor.powerhal.rendering";
+constexpr char kPowerHalStatsPeriodProp[] = "vendor.powerhal.stats_period_ms";
+constexpr char kPowerHalTraceProp[] = "vendor.powerhal.trace.record";
 constexpr char kPowerHalConfigPath[] = "/vendor/etc/powerhint.json";
+constexpr char kPowerHalTablePath[] = "/vendor/etc/powerhint.bin";
+constexpr char kPowerHalTracePath[] = "/data/vendor/powerhal/hints.trace";
+
+constexpr uint32_t kStatsPeriodMsDefault = 10000;
+constexpr uint32_t kStatsPeriodMsMax = 600000;
+// How long an INTERACTION without a duration stays worth replaying.
+constexpr int32_t kInteractionReplayMs = 1400;
+// CAMERA_LAUNCH also boosts LAUNCH for up to this long.
+constexpr int32_t kCameraLaunchBoostMs = 2500;
+// LAUNCH timeout when powerhint.json does not give one.
+constexpr int32_t kLaunchBoostMsDefault = 5000;
+// SUSTAINED_PERFORMANCE_LEVEL_<n> hints in powerhint.json, and the one that
+// matches the old fixed SUSTAINED_PERFORMANCE caps.
+constexpr int kSustainedLevelCount = 5;
+constexpr int kSustainedStaticLevel = 1;
+// SESSION_BOOST_<n> hints used when the kernel has no uclamp.
+constexpr int kSessionBoostLevelCount = 4;
 
 struct Power : public IPower {
     // Methods from ::android::hardware::power::V1_0::IPower follow.
@@ -73,13 +117,30 @@ struct Power : public IPower {
     Return<void> debug(const hidl_handle& fd, const hidl_vec<hidl_string>& args) override;
 
  private:
-    static bool isSupportedGovernor();
-
+    bool isSupportedGovernor() const { return mGovernorMonitor->IsSupported(); }
+    void getStatsSnapshot(StatsSnapshot *snapshot);
+    void handleHint_1_0(PowerHint_1_0 hint, int32_t data);
+    void handleHint_1_2(PowerHint_1_2 hint, int32_t data);
+    void handleHint_1_3(PowerHint_1_3 hint, int32_t data);
+    std::chrono::milliseconds cameraLaunchBoost() const;
+    void replayHint(const HintJournal::Entry &entry, int64_t ageMs);
+    void handlePerfLock(PerfLockResource resource, int32_t level);
+
+    std::unique_ptr<GovernorMonitor> mGovernorMonitor;
+    std::unique_ptr<StatsSampler> mStatsSampler;
+    std::unique_ptr<EnergyModel> mEnergyModel;
     std::shared_ptr<HintManager> mHintManager;
+    std::unique_ptr<HintArbiter> mHintArbiter;
     std::unique_ptr<InteractionHandler> mInteractionHandler;
-    std::atomic<bool> mVRModeOn;
-    std::atomic<bool> mSustainedPerfModeOn;
-    std::atomic<bool> mCameraStreamingModeOn;
+    std::unique_ptr<LaunchProfiler> mLaunchProfiler;
+    std::unique_ptr<SustainedPerfController> mSustainedPerfController;
+    std::unique_ptr<HintSessionManager> mHintSessionManager;
+    std::unique_ptr<PerfLockServer> mPerfLockServer;
+    HintJournal mHintJournal;
+    HintTraceRecorder mHintTrace;
+    // Level each perf lock resource is held at, 0 when released
+    std::mutex mPerfLockLock;
+    int32_t mPerfLockLevels[PERF_LOCK_RESOURCE_COUNT];
     std::atomic<bool> mReady;
     std::thread mInitThread;
 };
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+#define ATRACE_TAG (ATRACE_TAG_POWER | ATRACE_TAG_HAL)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <perfmgr/FileNode.h>
+#include <perfmgr/NodeLooperThread.h>
+#include <perfmgr/PropertyNode.h>
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include "PowerHintTable.h"
+
+using ::android::sp;
+using ::android::perfmgr::FileNode;
+using ::android::perfmgr::NodeAction;
+using ::android::perfmgr::NodeLooperThread;
+using ::android::perfmgr::PropertyNode;
+using ::android::perfmgr::RequestGroup;
+
+// Same hash the compiler stores, used to tell whether the JSON changed.
+static uint32_t Fnv1a(const std::string &data) {
+    uint32_t h = 0x811c9dc5;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 0x01000193;
+    }
+    return h;
+}
+
+PowerHintTable::PowerHintTable(void *base, size_t size)
+    : mBase(base), mSize(size), mHeader(static_cast<const Header *>(base)) {
+}
+
+PowerHintTable::~PowerHintTable() {
+    munmap(mBase, mSize);
+}
+
+template <typename T>
+const T *PowerHintTable::Table(uint32_t offset) const {
+    return reinterpret_cast<const T *>(static_cast<const char *>(mBase) + offset);
+}
+
+const char *PowerHintTable::String(uint32_t offset) const {
+    return Table<char>(mHeader->strings_off) + offset;
+}
+
+bool PowerHintTable::Validate() const {
+    const Header *h = mHeader;
+    if (mSize < sizeof(Header) || h->magic != kPowerHintTableMagic ||
+        h->version != kPowerHintTableVersion) {
+        LOG(ERROR) << "Bad power hint table header";
+        return false;
+    }
+
+    auto fits = [this](uint32_t off, uint32_t count, size_t size) {
+        return off % 4 == 0 && off + static_cast<uint64_t>(count) * size <= mSize;
+    };
+    if (!fits(h->strings_off, h->strings_size, 1) ||
+        !fits(h->nodes_off, h->nodes_count, sizeof(Node)) ||
+        !fits(h->values_off, h->values_count, sizeof(uint32_t)) ||
+        !fits(h->actions_off, h->actions_count, sizeof(Action)) ||
+        !fits(h->priorities_off, h->priorities_count, sizeof(Priority)) ||
+        !fits(h->components_off, h->components_count, sizeof(uint32_t))) {
+        LOG(ERROR) << "Power hint table section out of bounds";
+        return false;
+    }
+    // Every string offset is checked below, so the last one must end here.
+    if (!h->strings_size || Table<char>(h->strings_off)[h->strings_size - 1] != '\0') {
+        LOG(ERROR) << "Power hint table strings are not terminated";
+        return false;
+    }
+
+    const Node *nodes = Table<Node>(h->nodes_off);
+    const uint32_t *values = Table<uint32_t>(h->values_off);
+    for (uint32_t i = 0; i < h->nodes_count; ++i) {
+        const Node &n = nodes[i];
+        if (n.name >= h->strings_size || n.path >= h->strings_size || n.type > PROPERTY_NODE ||
+            !n.values_count || n.default_index >= n.values_count ||
+            static_cast<uint64_t>(n.values_begin) + n.values_count > h->values_count) {
+            LOG(ERROR) << "Bad power hint table node " << i;
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < h->values_count; ++i) {
+        if (values[i] >= h->strings_size) {
+            LOG(ERROR) << "Bad power hint table value " << i;
+            return false;
+        }
+    }
+
+    const Action *actions = Table<Action>(h->actions_off);
+    for (uint32_t i = 0; i < h->actions_count; ++i) {
+        const Action &a = actions[i];
+        if (a.hint >= h->strings_size || a.node >= h->nodes_count ||
+            a.value >= nodes[a.node].values_count) {
+            LOG(ERROR) << "Bad power hint table action " << i;
+            return false;
+        }
+    }
+
+    const Priority *priorities = Table<Priority>(h->priorities_off);
+    const uint32_t *components = Table<uint32_t>(h->components_off);
+    for (uint32_t i = 0; i < h->priorities_count; ++i) {
+        const Priority &p = priorities[i];
+        if (p.hint >= h->strings_size ||
+            static_cast<uint64_t>(p.components_begin) + p.components_count >
+                    h->components_count) {
+            LOG(ERROR) << "Bad power hint table priority " << i;
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < h->components_count; ++i) {
+        if (components[i] >= h->strings_size) {
+            LOG(ERROR) << "Bad power hint table component " << i;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::unique_ptr<PowerHintTable> PowerHintTable::Open(const std::string &path,
+                                                     const std::string &json_path) {
+    ATRACE_CALL();
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        PLOG(INFO) << "No power hint table at " << path;
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        LOG(ERROR) << "Invalid power hint table " << path;
+        close(fd);
+        return nullptr;
+    }
+    void *base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        PLOG(ERROR) << "Failed to map " << path;
+        return nullptr;
+    }
+
+    std::unique_ptr<PowerHintTable> table(new PowerHintTable(base, st.st_size));
+    if (!table->Validate()) {
+        return nullptr;
+    }
+
+    // Hashing the JSON is far cheaper than parsing it and catches a config
+    // that was edited or pushed without rebuilding the table.
+    std::string json_doc;
+    if (!android::base::ReadFileToString(json_path, &json_doc)) {
+        LOG(ERROR) << "Failed to read JSON config from " << json_path;
+        return nullptr;
+    }
+    if (json_doc.size() != table->mHeader->json_size ||
+        Fnv1a(json_doc) != table->mHeader->json_hash) {
+        LOG(WARNING) << "Power hint table " << path << " is stale";
+        return nullptr;
+    }
+
+    return table;
+}
+
+std::unique_ptr<HintManager> PowerHintTable::CreateHintManager() const {
+    ATRACE_CALL();
+
+    const Node *nodes = Table<Node>(mHeader->nodes_off);
+    const uint32_t *values = Table<uint32_t>(mHeader->values_off);
+    std::vector<std::unique_ptr<android::perfmgr::Node>> hint_nodes;
+    hint_nodes.reserve(mHeader->nodes_count);
+    for (uint32_t i = 0; i < mHeader->nodes_count; ++i) {
+        const Node &n = nodes[i];
+        std::vector<RequestGroup> req_groups;
+        req_groups.reserve(n.values_count);
+        for (uint32_t j = 0; j < n.values_count; ++j) {
+            req_groups.emplace_back(String(values[n.values_begin + j]));
+        }
+        if (n.type == PROPERTY_NODE) {
+            hint_nodes.emplace_back(std::make_unique<PropertyNode>(
+                    String(n.name), String(n.path), std::move(req_groups), n.default_index,
+                    n.reset_on_init));
+        } else {
+            hint_nodes.emplace_back(std::make_unique<FileNode>(
+                    String(n.name), String(n.path), std::move(req_groups), n.default_index,
+                    n.reset_on_init, n.hold_fd));
+        }
+    }
+
+    const Action *actions = Table<Action>(mHeader->actions_off);
+    std::map<std::string, std::vector<NodeAction>> hint_actions;
+    for (uint32_t i = 0; i < mHeader->actions_count; ++i) {
+        const Action &a = actions[i];
+        hint_actions[String(a.hint)].emplace_back(a.node, a.value,
+                                                  std::chrono::milliseconds(a.duration_ms));
+    }
+
+    sp<NodeLooperThread> nm = new NodeLooperThread(std::move(hint_nodes));
+    std::unique_ptr<HintManager> hm = std::make_unique<HintManager>(std::move(nm), hint_actions);
+    if (!hm->Start()) {
+        LOG(ERROR) << "Failed to start HintManager from power hint table";
+        return nullptr;
+    }
+    LOG(INFO) << "Initialized HintManager from power hint table with "
+              << mHeader->nodes_count << " nodes and " << hint_actions.size() << " hints";
+    return hm;
+}
+
+std::vector<HintPriority> PowerHintTable::GetPriorities() const {
+    const Priority *priorities = Table<Priority>(mHeader->priorities_off);
+    const uint32_t *components = Table<uint32_t>(mHeader->components_off);
+    std::vector<HintPriority> result;
+    result.reserve(mHeader->priorities_count);
+    for (uint32_t i = 0; i < mHeader->priorities_count; ++i) {
+        const Priority &p = priorities[i];
+        HintPriority hp{String(p.hint), p.priority, p.exclusive != 0, {}};
+        for (uint32_t j = 0; j < p.components_count; ++j) {
+            hp.components.emplace_back(String(components[p.components_begin + j]));
+        }
+        result.push_back(std::move(hp));
+    }
+    return result;
+}
+
+std::chrono::milliseconds PowerHintTable::GetMaxDuration(const std::string &hint) const {
+    const Action *actions = Table<Action>(mHeader->actions_off);
+    uint32_t duration = 0;
+    for (uint32_t i = 0; i < mHeader->actions_count; ++i) {
+        if (hint == String(actions[i].hint))
+            duration = std::max(duration, actions[i].duration_ms);
+    }
+    return std::chrono::milliseconds(duration);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef POWERHINTTABLE_H
+#define POWERHINTTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <perfmgr/HintManager.h>
+
+#include "HintArbiter.h"
+
+using ::android::perfmgr::HintManager;
+
+// powerhint.json compiled by tools/powerhint_compiler.py. All fields are
+// little-endian uint32_t, every table is 4-byte aligned, and strings are
+// offsets into a table of NUL terminated, interned strings.
+//
+//   header      magic, version, json size, json FNV-1a hash,
+//               then (offset, count) for each table below
+//   strings     string bytes, count is the size in bytes
+//   nodes       name, path, type, default index, reset on init, hold fd,
+//               first value, value count
+//   values      string
+//   actions     hint, node index, value index, duration ms; grouped by hint
+//   priorities  hint, priority, exclusive, first component, component count
+//   components  string
+constexpr uint32_t kPowerHintTableMagic = 0x42544850;  // "PHTB"
+constexpr uint32_t kPowerHintTableVersion = 1;
+
+struct PowerHintTable {
+    ~PowerHintTable();
+
+    // Map the table at |path|. Returns nullptr if it is missing, malformed
+    // or was not compiled from the current contents of |json_path|.
+    static std::unique_ptr<PowerHintTable> Open(const std::string &path,
+                                                const std::string &json_path);
+
+    // Build and start a HintManager equivalent to the one
+    // HintManager::GetFromJSON would create from the source JSON.
+    std::unique_ptr<HintManager> CreateHintManager() const;
+    std::vector<HintPriority> GetPriorities() const;
+    // Longest Duration of the hint's actions.
+    std::chrono::milliseconds GetMaxDuration(const std::string &hint) const;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t json_size;
+        uint32_t json_hash;
+        uint32_t strings_off, strings_size;
+        uint32_t nodes_off, nodes_count;
+        uint32_t values_off, values_count;
+        uint32_t actions_off, actions_count;
+        uint32_t priorities_off, priorities_count;
+        uint32_t components_off, components_count;
+    };
+    struct Node {
+        uint32_t name;
+        uint32_t path;
+        uint32_t type;
+        uint32_t default_index;
+        uint32_t reset_on_init;
+        uint32_t hold_fd;
+        uint32_t values_begin;
+        uint32_t values_count;
+    };
+    struct Action {
+        uint32_t hint;
+        uint32_t node;
+        uint32_t value;
+        uint32_t duration_ms;
+    };
+    struct Priority {
+        uint32_t hint;
+        int32_t priority;
+        uint32_t exclusive;
+        uint32_t components_begin;
+        uint32_t components_count;
+    };
+
+    enum NodeType : uint32_t {
+        FILE_NODE = 0,
+        PROPERTY_NODE = 1,
+    };
+
+  private:
+    PowerHintTable(void *base, size_t size);
+    bool Validate() const;
+    const char *String(uint32_t offset) const;
+    template <typename T>
+    const T *Table(uint32_t offset) const;
+
+    void *mBase;
+    size_t mSize;
+    const Header *mHeader;
+};
+
+#endif //POWERHINTTABLE_H
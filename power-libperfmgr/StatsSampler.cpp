@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//#define LOG_NDEBUG 0
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+#define ATRACE_TAG (ATRACE_TAG_POWER | ATRACE_TAG_HAL)
+
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include "StatsSampler.h"
+
+#define NSINMS 1000000LL
+
+static constexpr std::chrono::milliseconds kMinPeriod(1000);
+
+static int64_t BoottimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+StatsSampler::StatsSampler(std::chrono::milliseconds period)
+    : mPeriod(std::max(period, kMinPeriod)),
+      mCount(0),
+      mExit(false) {
+    for (auto &slot : mRing)
+        slot.seq.store(0, std::memory_order_relaxed);
+}
+
+StatsSampler::~StatsSampler() {
+    Exit();
+}
+
+bool StatsSampler::Init() {
+    std::lock_guard<std::mutex> lk(mLock);
+    if (mThread)
+        return true;
+
+    mExit = false;
+    mThread = std::make_unique<std::thread>(&StatsSampler::Routine, this);
+    return true;
+}
+
+void StatsSampler::Exit() {
+    std::unique_lock<std::mutex> lk(mLock);
+    if (!mThread)
+        return;
+    mExit = true;
+    lk.unlock();
+
+    mCond.notify_all();
+    mThread->join();
+    mThread.reset();
+}
+
+void StatsSampler::Sample(StatsSnapshot *snapshot) {
+    ATRACE_CALL();
+
+    snapshot->timestampNs = BoottimeNs();
+    snapshot->masterCount = get_master_count();
+    snapshot->masterValid =
+            extract_master_stats(snapshot->master, ARRAY_SIZE(snapshot->master)) == 0;
+    snapshot->systemValid =
+            extract_system_stats(snapshot->system, ARRAY_SIZE(snapshot->system)) == 0;
+}
+
+// Single writer: only the sampler thread publishes.
+void StatsSampler::Publish(const StatsSnapshot &snapshot) {
+    uint64_t count = mCount.load(std::memory_order_relaxed);
+    Slot &slot = mRing[count % kRingSize];
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot.data, &snapshot, sizeof(snapshot));
+    slot.seq.store(seq + 2, std::memory_order_release);
+
+    mCount.store(count + 1, std::memory_order_release);
+}
+
+bool StatsSampler::ReadSlot(uint64_t index, StatsSnapshot *snapshot) const {
+    const Slot &slot = mRing[index % kRingSize];
+
+    while (true) {
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+        memcpy(snapshot, &slot.data, sizeof(*snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == before)
+            break;
+    }
+
+    // The slot may have been reused while we were looking at it.
+    return mCount.load(std::memory_order_acquire) - index <= kRingSize;
+}
+
+bool StatsSampler::GetLatest(StatsSnapshot *snapshot) const {
+    while (true) {
+        uint64_t count = mCount.load(std::memory_order_acquire);
+        if (count == 0)
+            return false;
+        if (ReadSlot(count - 1, snapshot))
+            return true;
+    }
+}
+
+void StatsSampler::Routine() {
+    std::unique_lock<std::mutex> lk(mLock);
+
+    while (!mExit) {
+        lk.unlock();
+        StatsSnapshot snapshot;
+        Sample(&snapshot);
+        Publish(snapshot);
+        if (mListener)
+            mListener(snapshot);
+        lk.lock();
+
+        mCond.wait_for(lk, mPeriod, [&] { return mExit; });
+    }
+}
+
+void StatsSampler::DumpDeltasToFd(int fd) const {
+    std::string buf("Low power stats deltas:\n");
+    uint64_t count = mCount.load(std::memory_order_acquire);
+    uint64_t first = count > kRingSize ? count - kRingSize + 1 : 1;
+    StatsSnapshot prev, cur;
+
+    if (count < 2 || !ReadSlot(first - 1, &prev)) {
+        buf += "  not enough samples\n";
+        first = count;
+    }
+
+    for (uint64_t i = first; i < count; i++) {
+        if (!ReadSlot(i, &cur))
+            break;
+
+        int64_t intervalMs = (cur.timestampNs - prev.timestampNs) / NSINMS;
+        android::base::StringAppendF(&buf, "  +%" PRId64 " ms:", intervalMs);
+
+        if (cur.masterValid && prev.masterValid) {
+            for (size_t m = 0; m < cur.masterCount; m++) {
+                const uint64_t *c = &cur.master[m * MASTER_STATS_COUNT];
+                const uint64_t *p = &prev.master[m * MASTER_STATS_COUNT];
+                uint64_t sleepMs = (c[SLEEP_CUMULATIVE_DURATION_MS] -
+                                    p[SLEEP_CUMULATIVE_DURATION_MS]) / RPM_CLK;
+                android::base::StringAppendF(
+                        &buf, " %s %" PRIu64 " ms (%.1f%%) %" PRIu64 "x",
+                        get_master_label(m), sleepMs,
+                        intervalMs > 0 ? 100.0 * sleepMs / intervalMs : 0.0,
+                        c[SLEEP_ENTER_COUNT] - p[SLEEP_ENTER_COUNT]);
+            }
+        }
+
+        if (cur.systemValid && prev.systemValid) {
+            static const char *kSystemStates[SYSTEM_SLEEP_STATE_COUNT] = {"AOSD", "CXSD"};
+            for (size_t s = 0; s < SYSTEM_SLEEP_STATE_COUNT; s++) {
+                const uint64_t *c = &cur.system[s * SYSTEM_STATE_STATS_COUNT];
+                const uint64_t *p = &prev.system[s * SYSTEM_STATE_STATS_COUNT];
+                uint64_t sleepMs = c[ACCUMULATED_TIME_MS] - p[ACCUMULATED_TIME_MS];
+                android::base::StringAppendF(
+                        &buf, " %s %" PRIu64 " ms (%.1f%%) %" PRIu64 "x", kSystemStates[s],
+                        sleepMs, intervalMs > 0 ? 100.0 * sleepMs / intervalMs : 0.0,
+                        c[TOTAL_COUNT] - p[TOTAL_COUNT]);
+            }
+        }
+
+        buf += "\n";
+        prev = cur;
+    }
+
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump stats deltas to fd";
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef STATSSAMPLER_H
+#define STATSSAMPLER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "power-helper.h"
+
+struct StatsSnapshot {
+    // CLOCK_BOOTTIME, so intervals include time spent in suspend
+    int64_t timestampNs;
+    bool masterValid;
+    bool systemValid;
+    size_t masterCount;
+    uint64_t master[MAX_MASTER_COUNT * MASTER_STATS_COUNT];
+    uint64_t system[SYSTEM_SLEEP_STATE_COUNT * SYSTEM_STATE_STATS_COUNT];
+};
+
+// Samples the RPMh master and system sleep stats on a fixed period into a
+// ring of snapshots. Readers never block the sampler: each slot is guarded
+// by a sequence counter and a torn read is simply retried.
+struct StatsSampler {
+    // Told about every snapshot once it is published, on the sampler thread.
+    using Listener = std::function<void(const StatsSnapshot &snapshot)>;
+
+    StatsSampler(std::chrono::milliseconds period);
+    ~StatsSampler();
+    bool Init();
+    void Exit();
+
+    // Must be set before Init().
+    void SetListener(Listener listener) { mListener = std::move(listener); }
+
+    // Copies the most recent snapshot. Returns false until the first
+    // sample has been taken.
+    bool GetLatest(StatsSnapshot *snapshot) const;
+    // Dumps the residency deltas between consecutive snapshots in the ring.
+    void DumpDeltasToFd(int fd) const;
+
+    static void Sample(StatsSnapshot *snapshot);
+
+ private:
+    static constexpr size_t kRingSize = 16;
+
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        StatsSnapshot data;
+    };
+
+    bool ReadSlot(uint64_t index, StatsSnapshot *snapshot) const;
+    void Publish(const StatsSnapshot &snapshot);
+    void Routine();
+
+    const std::chrono::milliseconds mPeriod;
+    Listener mListener;
+    Slot mRing[kRingSize];
+    // Number of snapshots published so far
+    std::atomic<uint64_t> mCount;
+
+    bool mExit;
+    std::unique_ptr<std::thread> mThread;
+    std::mutex mLock;
+    std::condition_variable mCond;
+};
+
+#endif //STATSSAMPLER_H
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//#define LOG_NDEBUG 0
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+#define ATRACE_TAG (ATRACE_TAG_POWER | ATRACE_TAG_HAL)
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include "HintMetrics.h"
+#include "SustainedPerfController.h"
+
+constexpr char kAdaptiveProp[] = "vendor.powerhal.sustained.adaptive";
+constexpr char kZoneProp[] = "vendor.powerhal.sustained.zone";
+constexpr char kTargetProp[] = "vendor.powerhal.sustained.target_mc";
+
+static constexpr char kDefaultZone[] = "xo-therm-adc";
+static constexpr int kDefaultTargetMilliC = 45000;
+static constexpr std::chrono::milliseconds kPeriod(1000);
+// One level per 4C of error, and closing a 1C error over about 25s.
+static constexpr double kKp = 0.25;
+static constexpr double kKi = 0.04;
+static constexpr double kHysteresis = 0.75;
+
+SustainedPerfController::SustainedPerfController(
+        std::shared_ptr<HintManager> const & hint_manager, std::vector<std::string> levels,
+        int static_level, std::string const & sysfs_root)
+    : mHintManager(hint_manager),
+      mLevels(std::move(levels)),
+      mStaticLevel(static_level),
+      mSysfsRoot(sysfs_root),
+      mPeriod(kPeriod),
+      mParams(DefaultParams()),
+      mTempFd(-1),
+      mLastTempMilliC(0),
+      mActive(false),
+      mExit(false),
+      mState({0, static_level}),
+      mAppliedLevel(-1),
+      mLevelChanges(0) {
+}
+
+SustainedPerfController::~SustainedPerfController() {
+    Exit();
+}
+
+bool SustainedPerfController::FindZone(const std::string &type) {
+    std::string dir = mSysfsRoot + "/class/thermal";
+    std::unique_ptr<DIR, decltype(&closedir)> d(opendir(dir.c_str()), closedir);
+    if (!d) {
+        ALOGE("Unable to open %s (%d)", dir.c_str(), errno);
+        return false;
+    }
+
+    struct dirent *de;
+    while ((de = readdir(d.get()))) {
+        if (!android::base::StartsWith(de->d_name, "thermal_zone"))
+            continue;
+        std::string zone = dir + "/" + de->d_name;
+        std::string buf;
+        if (!android::base::ReadFileToString(zone + "/type", &buf) ||
+            android::base::Trim(buf) != type)
+            continue;
+
+        mTempFd = open((zone + "/temp").c_str(), O_RDONLY | O_CLOEXEC);
+        if (mTempFd < 0) {
+            ALOGE("Unable to open %s/temp (%d)", zone.c_str(), errno);
+            return false;
+        }
+        mZone = de->d_name;
+        return true;
+    }
+
+    ALOGE("No thermal zone of type %s", type.c_str());
+    return false;
+}
+
+bool SustainedPerfController::Init() {
+    std::lock_guard<std::mutex> lk(mLock);
+    if (mThread || mTempFd >= 0)
+        return true;
+
+    if (!android::base::GetBoolProperty(kAdaptiveProp, false)) {
+        ALOGI("Sustained performance uses static caps");
+        return true;
+    }
+    mParams.targetMilliC = android::base::GetIntProperty(kTargetProp, kDefaultTargetMilliC,
+                                                         20000, 80000);
+    if (!FindZone(android::base::GetProperty(kZoneProp, kDefaultZone)))
+        return false;
+
+    mExit = false;
+    mThread = std::make_unique<std::thread>(&SustainedPerfController::Routine, this);
+    ALOGI("Sustained performance follows %s to %d mC", mZone.c_str(), mParams.targetMilliC);
+    return true;
+}
+
+void SustainedPerfController::Exit() {
+    std::unique_lock<std::mutex> lk(mLock);
+    if (mThread) {
+        mExit = true;
+        lk.unlock();
+        mCond.notify_all();
+        mThread->join();
+        lk.lock();
+        mThread.reset();
+    }
+    if (mTempFd >= 0) {
+        close(mTempFd);
+        mTempFd = -1;
+    }
+}
+
+void SustainedPerfController::Start() {
+    std::lock_guard<std::mutex> lk(mLock);
+    if (mActive)
+        return;
+
+    mActive = true;
+    mState = {0, mStaticLevel};
+    ApplyLevelLocked(mStaticLevel);
+    mCond.notify_all();
+}
+
+void SustainedPerfController::Stop() {
+    std::lock_guard<std::mutex> lk(mLock);
+    if (!mActive)
+        return;
+
+    mActive = false;
+    ApplyLevelLocked(-1);
+    mCond.notify_all();
+}
+
+// should be called while locked
+void SustainedPerfController::ApplyLevelLocked(int level) {
+    if (level == mAppliedLevel)
+        return;
+
+    // Take the new caps before dropping the old ones so the nodes move
+    // straight from one level to the next.
+    if (level >= 0)
+        HintMetrics::DoHint(*mHintManager, mLevels[level]);
+    if (mAppliedLevel >= 0)
+        HintMetrics::EndHint(*mHintManager, mLevels[mAppliedLevel]);
+
+    ALOGV("%s: level %d -> %d", __func__, mAppliedLevel, level);
+    ATRACE_INT("sustained_level", level);
+    mAppliedLevel = level;
+    mLevelChanges++;
+}
+
+SustainedPerfController::Params SustainedPerfController::DefaultParams() {
+    return {kDefaultTargetMilliC, kKp, kKi, kHysteresis};
+}
+
+int SustainedPerfController::Update(const Params &params, int staticLevel, int levelCount,
+                                    State *state, int tempMilliC, int64_t dtMs) {
+    // Positive error is thermal headroom, which lets the level go up.
+    double error = (params.targetMilliC - tempMilliC) / 1000.0;
+    double maxLevel = levelCount - 1;
+
+    double integral = state->integral + error * dtMs / 1000.0;
+    double output = staticLevel + params.kp * error + params.ki * integral;
+    // Stop integrating while the output is pinned at either end, so the
+    // loop does not wind up during a long stretch it cannot act on.
+    if ((output > maxLevel && error > 0) || (output < 0 && error < 0)) {
+        integral = state->integral;
+        output = staticLevel + params.kp * error + params.ki * integral;
+    }
+    state->integral = integral;
+
+    output = std::clamp(output, 0.0, maxLevel);
+    if (std::fabs(output - state->level) >= params.hysteresis)
+        state->level = std::clamp(static_cast<int>(std::lround(output)), 0, levelCount - 1);
+    return state->level;
+}
+
+bool SustainedPerfController::ReadTemp(int *tempMilliC) {
+    char buf[16];
+    ssize_t ret = pread(mTempFd, buf, sizeof(buf) - 1, 0);
+    if (ret <= 0) {
+        ALOGE("%s: failed to read %s (%d)", __func__, mZone.c_str(), errno);
+        return false;
+    }
+    buf[ret] = '\0';
+    *tempMilliC = atoi(buf);
+    return true;
+}
+
+void SustainedPerfController::Routine() {
+    std::unique_lock<std::mutex> lk(mLock);
+    auto last = std::chrono::steady_clock::now();
+
+    while (!mExit) {
+        if (!mActive) {
+            mCond.wait(lk, [&] { return mExit || mActive; });
+            last = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (mCond.wait_for(lk, mPeriod, [&] { return mExit || !mActive; }))
+            continue;
+
+        lk.unlock();
+        int temp;
+        bool valid = ReadTemp(&temp);
+        auto now = std::chrono::steady_clock::now();
+        lk.lock();
+        if (mExit || !mActive)
+            continue;
+
+        if (!valid) {
+            // Fall back to the static caps until the zone reads again.
+            mState = {0, mStaticLevel};
+            ApplyLevelLocked(mStaticLevel);
+            continue;
+        }
+
+        int64_t dtMs =
+                std::chrono::duration_cast<std::chrono::milliseconds>(now - last).count();
+        last = now;
+        mLastTempMilliC = temp;
+        ATRACE_INT("sustained_temp", temp);
+        ApplyLevelLocked(Update(mParams, mStaticLevel, mLevels.size(), &mState, temp, dtMs));
+    }
+}
+
+void SustainedPerfController::DumpToFd(int fd) const {
+    std::lock_guard<std::mutex> lk(mLock);
+    std::string buf(android::base::StringPrintf(
+            "SustainedPerfController:\n"
+            "  Mode: %s\n"
+            "  Active: %s\n"
+            "  Level: %d of %zu (static %d), %" PRIu64 " changes\n",
+            mThread ? "adaptive" : "static", mActive ? "true" : "false", mAppliedLevel,
+            mLevels.size(), mStaticLevel, mLevelChanges));
+    if (mThread) {
+        buf += android::base::StringPrintf("  Zone: %s, %d mC (target %d mC), integral %.2f\n",
+                                           mZone.c_str(), mLastTempMilliC, mParams.targetMilliC,
+                                           mState.integral);
+    }
+    if (!android::base::WriteStringToFd(buf, fd)) {
+        PLOG(ERROR) << "Failed to dump sustained performance state to fd";
+    }
+}
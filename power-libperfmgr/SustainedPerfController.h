@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SUSTAINEDPERFCONTROLLER_H
+#define SUSTAINEDPERFCONTROLLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <perfmgr/HintManager.h>
+
+using ::android::perfmgr::HintManager;
+
+// Picks the frequency caps held while SUSTAINED_PERFORMANCE is applied.
+//
+// The caps live in powerhint.json as a ladder of level hints, from the most
+// throttled one to the least. Without a usable thermal zone, or with the
+// controller disabled, the static level is held, which matches the fixed
+// caps SUSTAINED_PERFORMANCE used to carry. Otherwise a PI loop on the zone
+// temperature walks the ladder to hold the target temperature, so the
+// device settles on the highest level it can sustain.
+struct SustainedPerfController {
+    struct Params {
+        int targetMilliC;
+        // Levels per degree C of error, and per degree C second of error.
+        double kp;
+        double ki;
+        // Minimum distance in levels from the current level before moving.
+        double hysteresis;
+    };
+
+    struct State {
+        double integral;
+        int level;
+    };
+
+    SustainedPerfController(std::shared_ptr<HintManager> const & hint_manager,
+                            std::vector<std::string> levels, int static_level,
+                            std::string const & sysfs_root = "/sys");
+    ~SustainedPerfController();
+    bool Init();
+    void Exit();
+
+    // Called when SUSTAINED_PERFORMANCE is applied and when it goes away.
+    void Start();
+    void Stop();
+
+    void DumpToFd(int fd) const;
+
+    // One controller step for a temperature sample taken |dtMs| after the
+    // previous one. Returns the new level; kept free of I/O so it can be
+    // driven from recorded or simulated temperatures.
+    static int Update(const Params &params, int staticLevel, int levelCount, State *state,
+                      int tempMilliC, int64_t dtMs);
+    // The gains and target used unless properties override the target.
+    static Params DefaultParams();
+
+ private:
+    bool FindZone(const std::string &type);
+    bool ReadTemp(int *tempMilliC);
+    void ApplyLevelLocked(int level);
+    void Routine();
+
+    std::shared_ptr<HintManager> mHintManager;
+    const std::vector<std::string> mLevels;
+    const int mStaticLevel;
+    const std::string mSysfsRoot;
+    const std::chrono::milliseconds mPeriod;
+    Params mParams;
+
+    std::string mZone;
+    int mTempFd;
+    int mLastTempMilliC;
+    bool mActive;
+    bool mExit;
+    State mState;
+    int mAppliedLevel;
+    uint64_t mLevelChanges;
+
+    std::unique_ptr<std::thread> mThread;
+    mutable std::mutex mLock;
+    std::condition_variable mCond;
+};
+
+#endif //SUSTAINEDPERFCONTROLLER_H
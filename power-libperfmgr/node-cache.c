@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "android.hardware.power@1.3-service.nubia_sdm845-libperfmgr"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <log/log.h>
+
+#include "node-cache.h"
+
+#define MAX_CACHED_NODES 32
+#define MAX_NODE_PATH 128
+#define MAX_NODE_VALUE 32
+
+#define NSINSEC 1000000000LL
+// How long an absent node is taken to stay absent
+#define ABSENT_RETRY_NS (60 * NSINSEC)
+// Errors of one node are logged at most once per this interval
+#define ERROR_LOG_INTERVAL_NS (60 * NSINSEC)
+
+struct cached_node {
+    char path[MAX_NODE_PATH];
+    int fd;
+    int rfd;
+    // Set once rfd has been handed out, it must not be closed after that
+    int rfd_pinned;
+    // Empty until a write succeeded; values too long to cache stay empty
+    char value[MAX_NODE_VALUE];
+    // CLOCK_MONOTONIC time until which the node is taken to be absent
+    int64_t absent_until_ns;
+    int64_t last_error_log_ns;
+    unsigned int errors_not_logged;
+};
+
+static struct cached_node nodes[MAX_CACHED_NODES];
+static size_t num_nodes;
+static pthread_mutex_t nodes_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_uint_fast64_t writes_issued;
+static atomic_uint_fast64_t writes_skipped;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSINSEC + ts.tv_nsec;
+}
+
+// should be called while locked
+static struct cached_node *find_node(const char *path, int create) {
+    size_t i;
+
+    for (i = 0; i < num_nodes; i++) {
+        if (!strcmp(nodes[i].path, path))
+            return &nodes[i];
+    }
+
+    if (!create || num_nodes == MAX_CACHED_NODES || strlen(path) >= MAX_NODE_PATH) {
+        if (create)
+            ALOGW("%s: not caching %s", __func__, path);
+        return NULL;
+    }
+
+    struct cached_node *node = &nodes[num_nodes++];
+    strcpy(node->path, path);
+    node->fd = -1;
+    node->rfd = -1;
+    node->rfd_pinned = 0;
+    node->value[0] = '\0';
+    node->absent_until_ns = 0;
+    node->last_error_log_ns = 0;
+    node->errors_not_logged = 0;
+    return node;
+}
+
+// should be called while locked
+static void log_error(struct cached_node *node, const char *what, int err) {
+    char buf[80];
+    int64_t now = now_ns();
+
+    if (node->last_error_log_ns &&
+        now - node->last_error_log_ns < ERROR_LOG_INTERVAL_NS) {
+        node->errors_not_logged++;
+        return;
+    }
+
+    strerror_r(err, buf, sizeof(buf));
+    if (node->errors_not_logged) {
+        ALOGE("Error %s %s: %s (%u more not logged)\n", what, node->path, buf,
+              node->errors_not_logged);
+    } else {
+        ALOGE("Error %s %s: %s\n", what, node->path, buf);
+    }
+    node->last_error_log_ns = now;
+    node->errors_not_logged = 0;
+}
+
+// Opens the node unless it was found absent recently. Returns the fd or
+// -errno. should be called while locked
+static int open_node(struct cached_node *node, int flags) {
+    if (node->absent_until_ns && now_ns() < node->absent_until_ns)
+        return -ENOENT;
+
+    int fd = open(node->path, flags | O_CLOEXEC);
+    if (fd < 0) {
+        int err = errno;
+        if (err == ENOENT)
+            node->absent_until_ns = now_ns() + ABSENT_RETRY_NS;
+        log_error(node, "opening", err);
+        return -err;
+    }
+    node->absent_until_ns = 0;
+    return fd;
+}
+
+int node_cache_write(const char *path, const char *value) {
+    struct cached_node *node;
+    size_t len = strlen(value);
+    int ret = 0;
+
+    pthread_mutex_lock(&nodes_lock);
+    node = find_node(path, 1);
+    if (!node) {
+        // Table full: fall back to an uncached write
+        pthread_mutex_unlock(&nodes_lock);
+        int fd = open(path, O_WRONLY | O_CLOEXEC);
+        if (fd < 0)
+            return -1;
+        atomic_fetch_add(&writes_issued, 1);
+        if (pwrite(fd, value, len, 0) != (ssize_t)len)
+            ret = -1;
+        close(fd);
+        return ret;
+    }
+
+    if (node->value[0] && !strcmp(node->value, value)) {
+        pthread_mutex_unlock(&nodes_lock);
+        atomic_fetch_add(&writes_skipped, 1);
+        return 0;
+    }
+
+    if (node->fd < 0) {
+        node->fd = open_node(node, O_WRONLY);
+        if (node->fd < 0) {
+            node->fd = -1;
+            pthread_mutex_unlock(&nodes_lock);
+            return -1;
+        }
+    }
+
+    atomic_fetch_add(&writes_issued, 1);
+    if (pwrite(node->fd, value, len, 0) != (ssize_t)len) {
+        log_error(node, "writing to", errno);
+        ret = -1;
+    }
+    if (ret == 0 && len < MAX_NODE_VALUE) {
+        strcpy(node->value, value);
+    } else {
+        node->value[0] = '\0';
+        if (ret) {
+            // Reopen on the next write in case the node was recreated
+            close(node->fd);
+            node->fd = -1;
+        }
+    }
+    pthread_mutex_unlock(&nodes_lock);
+
+    return ret;
+}
+
+void node_cache_invalidate(const char *path) {
+    struct cached_node *node;
+
+    pthread_mutex_lock(&nodes_lock);
+    node = find_node(path, 0);
+    if (node)
+        node->value[0] = '\0';
+    pthread_mutex_unlock(&nodes_lock);
+}
+
+// Returns the node's read fd, opening it if needed, or -errno.
+// should be called while locked
+static int get_read_fd(struct cached_node *node) {
+    if (node->rfd < 0) {
+        int fd = open_node(node, O_RDONLY);
+        if (fd < 0)
+            return fd;
+        node->rfd = fd;
+    }
+    return node->rfd;
+}
+
+ssize_t node_cache_read(const char *path, char *buf, size_t size) {
+    struct cached_node *node;
+    ssize_t len;
+    int fd;
+
+    pthread_mutex_lock(&nodes_lock);
+    node = find_node(path, 1);
+    if (!node) {
+        pthread_mutex_unlock(&nodes_lock);
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return -errno;
+        len = pread(fd, buf, size - 1, 0);
+        if (len < 0)
+            len = -errno;
+        else
+            buf[len] = '\0';
+        close(fd);
+        return len;
+    }
+
+    fd = get_read_fd(node);
+    if (fd < 0) {
+        pthread_mutex_unlock(&nodes_lock);
+        return fd;
+    }
+
+    // Read locked: on an error the fd is closed below, and its number could
+    // be reused by then for another node.
+    len = pread(fd, buf, size - 1, 0);
+    if (len < 0) {
+        len = -errno;
+        log_error(node, "reading", -len);
+        // Reopen on the next read in case the node went away and came back
+        if (!node->rfd_pinned) {
+            close(fd);
+            node->rfd = -1;
+        }
+    } else {
+        buf[len] = '\0';
+    }
+    pthread_mutex_unlock(&nodes_lock);
+
+    return len;
+}
+
+int node_cache_read_fd(const char *path) {
+    struct cached_node *node;
+    int fd;
+
+    pthread_mutex_lock(&nodes_lock);
+    node = find_node(path, 1);
+    if (!node) {
+        pthread_mutex_unlock(&nodes_lock);
+        return -1;
+    }
+    fd = get_read_fd(node);
+    if (fd >= 0)
+        node->rfd_pinned = 1;
+    pthread_mutex_unlock(&nodes_lock);
+
+    return fd < 0 ? -1 : fd;
+}
+
+void node_cache_get_stats(uint64_t *issued, uint64_t *skipped) {
+    *issued = atomic_load(&writes_issued);
+    *skipped = atomic_load(&writes_skipped);
+}
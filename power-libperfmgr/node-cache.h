@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __NODE_CACHE_H__
+#define __NODE_CACHE_H__
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// sysfs I/O for the nodes the power HAL reads and writes itself (libperfmgr
+// keeps its own per-node state for powerhint.json).
+//
+// Descriptors are opened on first use and stay open; every access is a
+// single pread/pwrite at offset 0, under the cache lock. A node that does not exist is not
+// looked for again for a while, and errors are logged at most once per
+// node per interval with a count of those left out.
+
+// Writes are combined: the last value written to each node is remembered
+// and writes that would not change it are skipped. Only set_feature()
+// writes through here, so far just the double-tap-to-wake node, whose
+// cached value set_interactive() drops as the driver may reset it.
+//
+// Returns 0 when the node holds the value afterwards, -1 otherwise.
+int node_cache_write(const char *path, const char *value);
+
+// Forgets the cached value, e.g. after something else wrote the node.
+void node_cache_invalidate(const char *path);
+
+// Reads the node into buf and NUL-terminates it. Returns the length read,
+// or -errno.
+ssize_t node_cache_read(const char *path, char *buf, size_t size);
+
+// The descriptor node_cache_read() uses for the node, for poll(). It stays
+// owned by the cache and open for the life of the process. Returns -1 if
+// the node cannot be opened.
+int node_cache_read_fd(const char *path);
+
+// Counts of node_cache_write() calls that reached the node and of those
+// skipped as redundant: DT2W writes only, none of libperfmgr's writes to
+// the powerhint.json nodes.
+void node_cache_get_stats(uint64_t *issued, uint64_t *skipped);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__NODE_CACHE_H__
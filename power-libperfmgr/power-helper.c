@@ -37,10 +37,12 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <dlfcn.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <log/log.h>
 
+#include "node-cache.h"
 #include "power-helper.h"
 
 #ifndef MASTER_STATS_FILE
@@ -51,187 +53,271 @@
 #define SYSTEM_STATS_FILE "/sys/power/system_sleep/stats"
 #endif
 
-#define LINE_SIZE 128
+// sysfs attributes never exceed a page, so one read gets the whole file
+#define STATS_BUF_SIZE 4096
 
-const char *master_stats_labels[MASTER_STATS_COUNT] = {
-    "Sleep Accumulated Duration",
-    "Sleep Count",
-    "Sleep Last Entered At",
+const struct stats_label master_stats_labels[MASTER_STATS_COUNT] = {
+    STATS_LABEL("Sleep Accumulated Duration"),
+    STATS_LABEL("Sleep Count"),
+    STATS_LABEL("Sleep Last Entered At"),
 };
 
-struct stats_section master_sections[MASTER_COUNT] = {
-    { MASTER_APSS,       "APSS", master_stats_labels, ARRAY_SIZE(master_stats_labels) },
-    { MASTER_MPSS,       "MPSS", master_stats_labels, ARRAY_SIZE(master_stats_labels) },
-    { MASTER_ADSP,       "ADSP", master_stats_labels, ARRAY_SIZE(master_stats_labels) },
-    { MASTER_SLPI,       "SLPI", master_stats_labels, ARRAY_SIZE(master_stats_labels) },
-    // The following masters are currently unused
-    //{ MASTER_CDSP,       "CDSP", master_stats_labels, ARRAY_SIZE(master_stats_labels) },
-    //{ MASTER_GPU,         "GPU", master_stats_labels, ARRAY_SIZE(master_stats_labels) },
-    //{ MASTER_DISPLAY, "DISPLAY", master_stats_labels, ARRAY_SIZE(master_stats_labels) },
-};
+#define MAX_MASTER_LABEL 16
 
-const char *system_stats_labels[SYSTEM_STATE_STATS_COUNT] = {
-    "count",
-    "actual last sleep(msec)"
-};
+// Filled in from the master stats file by discover_master_sections()
+static char master_labels[MAX_MASTER_COUNT][MAX_MASTER_LABEL];
+static struct stats_section master_sections[MAX_MASTER_COUNT];
+static size_t master_count;
+static pthread_mutex_t master_sections_lock = PTHREAD_MUTEX_INITIALIZER;
 
-struct stats_section system_sections[] = {
-    { SYSTEM_STATES, "RPM Mode:aosd", system_stats_labels, ARRAY_SIZE(system_stats_labels) },
-    { SYSTEM_STATES, "RPM Mode:cxsd", system_stats_labels, ARRAY_SIZE(system_stats_labels) },
+const struct stats_label system_stats_labels[SYSTEM_STATE_STATS_COUNT] = {
+    STATS_LABEL("count"),
+    STATS_LABEL("actual last sleep(msec)"),
 };
 
-static int sysfs_write(char *path, char *s)
-{
-    char buf[80];
-    int len;
-    int ret = 0;
-    int fd = open(path, O_WRONLY);
-
-    if (fd < 0) {
-        strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error opening %s: %s\n", path, buf);
-        return -1 ;
-    }
-
-    len = write(fd, s, strlen(s));
-    if (len < 0) {
-        strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error writing to %s: %s\n", path, buf);
+#define SYSTEM_SECTION(label) \
+    { SYSTEM_STATES, label, sizeof(label) - 1, system_stats_labels, ARRAY_SIZE(system_stats_labels) }
 
-        ret = -1;
-    }
-
-    close(fd);
-
-    return ret;
-}
+struct stats_section system_sections[] = {
+    SYSTEM_SECTION("RPM Mode:aosd"),
+    SYSTEM_SECTION("RPM Mode:cxsd"),
+};
 
 void set_feature(feature_t feature, int state) {
     switch (feature) {
         case POWER_FEATURE_DOUBLE_TAP_TO_WAKE:
-            sysfs_write(TAP_TO_WAKE_NODE, state ? "1" : "0");
+            node_cache_write(TAP_TO_WAKE_NODE, state ? "1" : "0");
             break;
         default:
             break;
     }
 }
 
-static int parse_stats(const char **stat_labels, size_t num_stats,
-        uint64_t *list, FILE *fp) {
-    ssize_t nread;
-    size_t len = LINE_SIZE;
-    char *line;
-    size_t stats_read = 0;
-    size_t i;
-
-    line = malloc(len);
-    if (!line) {
-        ALOGE("%s: no memory to hold line", __func__);
-        return -ENOMEM;
-    }
+void set_interactive(int on __unused) {
+    // The touch driver may reset the gesture node across suspend and resume,
+    // so the next set_feature() must reach it even with the same value.
+    node_cache_invalidate(TAP_TO_WAKE_NODE);
+}
 
-    while ((stats_read < num_stats) &&
-        (nread = getline(&line, &len, fp) > 0)) {
-        char *key = line + strspn(line, " \t");
-        char *value = strchr(key, ':');
-        if (!value || (value > (line + len)))
-            continue;
-        *value++ = '\0';
-
-        for (i = 0; i < num_stats; i++) {
-            if (!strncmp(key, stat_labels[i], strlen(stat_labels[i]))) {
-                list[i] = strtoull(value, NULL, 0);
-                stats_read++;
-                break;
-            }
-        }
-    }
+// Labels match as prefixes of the key, like the strncmp() they replace. The
+// first character is compared before anything else, which rejects nearly
+// every mismatch without a memcmp().
+static inline int label_matches(const char *key, size_t key_len, const char *label,
+        size_t label_len) {
+    return key_len >= label_len && key[0] == label[0] && !memcmp(key, label, label_len);
+}
 
-    free(line);
+static int find_section(const char *key, size_t key_len,
+        const struct stats_section *sections, size_t num_sections) {
+    size_t i;
 
-    return stats_read;
+    for (i = 0; i < num_sections; i++) {
+        if (label_matches(key, key_len, sections[i].label, sections[i].label_len))
+            return i;
+    }
+    return -1;
 }
 
-
-static int extract_stats(uint64_t *stats_list, size_t entries_per_section, char *file,
-        struct stats_section *sections, size_t num_sections) {
-    FILE *fp;
-    ssize_t read;
-    size_t len = LINE_SIZE;
-    char *line;
+static int find_stat(const char *key, size_t key_len,
+        const struct stats_label *labels, size_t num_labels) {
     size_t i;
-    size_t sections_read = 0;
-    size_t stats_read = 0;
-    int ret = 0;
 
-    fp = fopen(file, "re");
-    if (fp == NULL) {
-        ALOGE("%s: failed to open: %s Error = %s", __func__, file, strerror(errno));
-        return -errno;
+    for (i = 0; i < num_labels; i++) {
+        if (label_matches(key, key_len, labels[i].name, labels[i].len))
+            return i;
     }
+    return -1;
+}
 
-    line = malloc(len);
-    if (!line) {
-        ALOGE("%s: no memory to hold line", __func__);
-        fclose(fp);
-        return -ENOMEM;
+static void check_section(const struct stats_section *section, size_t stats_read) {
+    // If we don't find all of the stats we expect in this section, our understanding of
+    // the input is wrong.  Log it so that the zeroed stats are not mistaken for real data.
+    if (section && stats_read != section->num_stats) {
+        ALOGE("%s: failed to read all stats for %s section (%zu of %zu)", __func__,
+                section->label, stats_read, section->num_stats);
     }
+}
+
+// Parses one stats file.  Only a section header starts a new section; the
+// stats of a section are not all indented (the system sleep stats file puts
+// "actual last sleep(msec)" at the start of the line), so every "key:value"
+// line after a header is matched against that section's labels until all of
+// them have been read.
+static int parse_stats(const char *buf, size_t len, uint64_t *stats_list,
+        size_t entries_per_section, const struct stats_section *sections,
+        size_t num_sections) {
+    const struct stats_section *section = NULL;
+    uint64_t *section_stats = NULL;
+    size_t stats_read = 0;
+    const char *line, *end;
+    size_t i;
 
     // Ensure that any missing stats default to 0
     for (i = 0; i < (entries_per_section * num_sections); i++) {
         stats_list[i] = 0L;
     }
 
-    // Iterate over the sections we expect to find in the file, calling parse_stats()
-    // to process each section as we detect section headers
-    while ((sections_read < num_sections) && (read = getline(&line, &len, fp) != -1)) {
-        size_t begin = strspn(line, " \t");
-
-        for (i = 0; i < num_sections; i++) {
-            if (!strncmp(line + begin, sections[i].label, strlen(sections[i].label))) {
-                sections_read++;
-                break;
-            }
+    end = buf + len;
+    for (line = buf; line < end; ) {
+        const char *eol = memchr(line, '\n', end - line);
+        const char *key, *value;
+        size_t key_len;
+        int idx;
+
+        if (!eol)
+            eol = end;
+        key = line + strspn(line, " \t");
+        line = eol + 1;
+        if (key >= eol)
+            continue;
+        key_len = eol - key;
+
+        idx = find_section(key, key_len, sections, num_sections);
+        if (idx >= 0) {
+            check_section(section, stats_read);
+            section = &sections[idx];
+            section_stats = &stats_list[idx * entries_per_section];
+            stats_read = 0;
+            continue;
         }
 
-        if (i == num_sections) {
+        if (!section || stats_read == section->num_stats)
             continue;
-        }
 
-        stats_read = parse_stats(sections[i].stats_labels, sections[i].num_stats,
-                &stats_list[i * entries_per_section], fp);
-        // If we don't find all of the stats we expect in this section, our understanding of
-        // the input is wrong, and we can't just carry on as if everything is okay.  Better
-        // to log the error and give up than potentially return incorrect data as stats.
-        if (stats_read != sections[i].num_stats) {
-            ALOGE("%s: failed to read all stats for %s section (%zu of %zu)", __func__,
-                    sections[i].label, stats_read, sections[i].num_stats);
-            break;
+        value = memchr(key, ':', key_len);
+        if (!value)
+            continue;
+
+        idx = find_stat(key, value - key, section->stats_labels, section->num_stats);
+        if (idx < 0)
+            continue;
+
+        section_stats[idx] = strtoull(value + 1, NULL, 0);
+        stats_read++;
+    }
+    check_section(section, stats_read);
+
+    return 0;
+}
+
+// Builds the master section table from the section headers in a copy of the
+// master stats file: every unindented line without a ':' names one RPMh
+// master.  The table is built once; until that succeeds every call tries
+// again.  Called with master_sections_lock held.
+static size_t discover_master_sections_locked(const char *buf, size_t len) {
+    const char *line, *end;
+    size_t count = 0;
+
+    if (master_count)
+        return master_count;
+
+    end = buf + len;
+    for (line = buf; line < end && count < MAX_MASTER_COUNT; ) {
+        const char *eol = memchr(line, '\n', end - line);
+        size_t label_len;
+
+        if (!eol)
+            eol = end;
+        label_len = eol - line;
+        if (label_len && !strchr(" \t", line[0]) && !memchr(line, ':', label_len)) {
+            while (label_len && strchr(" \t\r", line[label_len - 1]))
+                label_len--;
+            if (label_len >= MAX_MASTER_LABEL)
+                label_len = MAX_MASTER_LABEL - 1;
+            memcpy(master_labels[count], line, label_len);
+            master_labels[count][label_len] = '\0';
+
+            master_sections[count].source = MASTER_STATS;
+            master_sections[count].label = master_labels[count];
+            master_sections[count].label_len = label_len;
+            master_sections[count].stats_labels = master_stats_labels;
+            master_sections[count].num_stats = ARRAY_SIZE(master_stats_labels);
+            ALOGI("%s: found RPMh master %s", __func__, master_labels[count]);
+            count++;
         }
+        line = eol + 1;
     }
 
-    free(line);
-    fclose(fp);
+    if (!count)
+        ALOGE("%s: no masters found in %s", __func__, MASTER_STATS_FILE);
+    master_count = count;
 
-    return ret;
+    return count;
 }
 
-int extract_master_stats(uint64_t *list, size_t list_length) {
-    size_t entries_per_section = list_length / ARRAY_SIZE(master_sections);
-    if (list_length % entries_per_section != 0) {
+static size_t discover_master_sections(void) {
+    char buf[STATS_BUF_SIZE];
+    ssize_t len;
+    size_t count = 0;
+
+    pthread_mutex_lock(&master_sections_lock);
+    if (master_count) {
+        count = master_count;
+    } else {
+        len = node_cache_read(MASTER_STATS_FILE, buf, sizeof(buf));
+        if (len >= 0)
+            count = discover_master_sections_locked(buf, len);
+    }
+    pthread_mutex_unlock(&master_sections_lock);
+
+    return count;
+}
+
+size_t get_master_count(void) {
+    return discover_master_sections();
+}
+
+const char *get_master_label(size_t index) {
+    if (index >= discover_master_sections())
+        return "";
+    return master_sections[index].label;
+}
+
+int parse_master_stats(const char *buf, size_t len, uint64_t *list, size_t list_length) {
+    size_t entries_per_section = list_length / MAX_MASTER_COUNT;
+    size_t num_sections;
+    if (list_length % MAX_MASTER_COUNT != 0) {
         ALOGW("%s: stats list size not an even multiple of section count", __func__);
     }
 
-    return extract_stats(list, entries_per_section, MASTER_STATS_FILE,
-            master_sections, ARRAY_SIZE(master_sections));
+    pthread_mutex_lock(&master_sections_lock);
+    num_sections = discover_master_sections_locked(buf, len);
+    pthread_mutex_unlock(&master_sections_lock);
+
+    if (!num_sections)
+        return -ENOENT;
+
+    return parse_stats(buf, len, list, entries_per_section, master_sections, num_sections);
 }
 
-int extract_system_stats(uint64_t *list, size_t list_length) {
+int parse_system_stats(const char *buf, size_t len, uint64_t *list, size_t list_length) {
     size_t entries_per_section = list_length / ARRAY_SIZE(system_sections);
     if (list_length % entries_per_section != 0) {
         ALOGW("%s: stats list size not an even multiple of section count", __func__);
     }
 
-    return extract_stats(list, entries_per_section, SYSTEM_STATS_FILE,
-            system_sections, ARRAY_SIZE(system_sections));
+    return parse_stats(buf, len, list, entries_per_section, system_sections,
+            ARRAY_SIZE(system_sections));
+}
+
+int extract_master_stats(uint64_t *list, size_t list_length) {
+    char buf[STATS_BUF_SIZE];
+    ssize_t len;
+
+    len = node_cache_read(MASTER_STATS_FILE, buf, sizeof(buf));
+    if (len < 0)
+        return len;
+
+    return parse_master_stats(buf, len, list, list_length);
+}
+
+int extract_system_stats(uint64_t *list, size_t list_length) {
+    char buf[STATS_BUF_SIZE];
+    ssize_t len;
+
+    len = node_cache_read(SYSTEM_STATS_FILE, buf, sizeof(buf));
+    if (len < 0)
+        return len;
+
+    return parse_system_stats(buf, len, list, list_length);
 }
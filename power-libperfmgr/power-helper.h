@@ -36,31 +36,16 @@ extern "C" {
 
 #include <hardware/power.h>
 
-// These values are used as indices in getSubsystemLowPowerStats(), as source IDs
-// in stats_section instances, and (in the case of the _COUNT values) to dimension
-// containers.  The values used as indices need to be contiguous, but others do
-// not (which is why SYSTEM_STATES is all the way at the end; it is not used as
-// an index, but only as a source ID).
+// Source IDs in stats_section instances.  The RPMh masters are not listed
+// individually: they are discovered from the master stats file at runtime,
+// and MAX_MASTER_COUNT only bounds the containers that hold their stats.
 enum stats_source {
-    // Master stats
-    MASTER_APSS = 0,
-    MASTER_MPSS,
-    MASTER_ADSP,
-    MASTER_SLPI,
-    // The following 3 masters are supported by the RPMh stats driver, but not
-    // in use on our devices.
-    // MASTER_CDSP,
-    // MASTER_GPU,
-    // MASTER_DISPLAY,
-    MASTER_COUNT, // Total master sources
-
-    // Don't add any lines after this line
-    STATS_SOURCE_COUNT, // Total sources of any kind excluding system states
-    SUBSYSTEM_COUNT = STATS_SOURCE_COUNT - MASTER_COUNT,
-
+    MASTER_STATS = 0,
     SYSTEM_STATES
 };
 
+#define MAX_MASTER_COUNT 16
+
 enum master_sleep_states {
     MASTER_SLEEP = 0,
 
@@ -93,20 +78,37 @@ enum system_state_stats {
     SYSTEM_STATE_STATS_COUNT
 };
 
+/* RPM runs at 19.2Mhz. Divide by 19200 for msec */
+#define RPM_CLK 19200
+
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x) (sizeof((x))/sizeof((x)[0]))
 #endif
 
+struct stats_label {
+    const char *name;
+    size_t len;
+};
+
+#define STATS_LABEL(s) { (s), sizeof(s) - 1 }
+
 struct stats_section {
     enum stats_source source;
     const char *label;
-    const char **stats_labels;
+    size_t label_len;
+    const struct stats_label *stats_labels;
     size_t num_stats;
 };
 
+size_t get_master_count(void);
+const char *get_master_label(size_t index);
 int extract_master_stats(uint64_t *list, size_t list_length);
 int extract_system_stats(uint64_t *list, size_t list_length);
+// The parsers behind extract_*_stats(), run on a copy of the stats file.
+int parse_master_stats(const char *buf, size_t len, uint64_t *list, size_t list_length);
+int parse_system_stats(const char *buf, size_t len, uint64_t *list, size_t list_length);
 void set_feature(feature_t feature, int state);
+void set_interactive(int on);
 
 #ifdef __cplusplus
 }
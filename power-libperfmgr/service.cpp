@@ -33,6 +33,8 @@ using android::hardware::joinRpcThreadpool;
 using android::hardware::power::V1_3::IPower;
 using android::hardware::power::V1_3::implementation::Power;
 
+constexpr size_t kBinderThreads = 4;
+
 int main(int /* argc */, char** /* argv */) {
     ALOGI("Power HAL Service 1.3 is starting.");
 
@@ -42,7 +44,8 @@ int main(int /* argc */, char** /* argv */) {
         return 1;
     }
 
-    configureRpcThreadpool(1, true /*callerWillJoin*/);
+    // Keep a hint from queuing behind a stats query or a debug dump
+    configureRpcThreadpool(kBinderThreads, true /*callerWillJoin*/);
 
     status_t status = service->registerAsService();
     if (status != OK) {
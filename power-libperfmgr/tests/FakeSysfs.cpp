@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <set>
+#include <thread>
+
+#include <android-base/file.h>
+#include <android-base/strings.h>
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+#include <perfmgr/FileNode.h>
+
+#include "FakeSysfs.h"
+
+using ::android::sp;
+using ::android::perfmgr::FileNode;
+using ::android::perfmgr::Node;
+using ::android::perfmgr::NodeAction;
+using ::android::perfmgr::NodeLooperThread;
+using ::android::perfmgr::RequestGroup;
+
+void FakeSysfs::AddNode(const std::string &name, std::vector<std::string> values) {
+    WriteFile(name, values.back());
+    mNodes.push_back({name, std::move(values)});
+}
+
+void FakeSysfs::AddAction(const std::string &hint, const std::string &node, size_t index,
+                          std::chrono::milliseconds duration) {
+    for (size_t i = 0; i < mNodes.size(); i++) {
+        if (mNodes[i].name == node) {
+            mActions[hint].emplace_back(i, index, duration);
+            return;
+        }
+    }
+    abort();
+}
+
+std::shared_ptr<HintManager> FakeSysfs::Start() {
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (const auto &spec : mNodes) {
+        std::vector<RequestGroup> groups;
+        for (const auto &value : spec.values) {
+            groups.emplace_back(value);
+        }
+        nodes.emplace_back(std::make_unique<FileNode>(spec.name, Path(spec.name),
+                                                      std::move(groups),
+                                                      spec.values.size() - 1, false));
+    }
+    sp<NodeLooperThread> nm = new NodeLooperThread(std::move(nodes));
+    std::shared_ptr<HintManager> hm = std::make_shared<HintManager>(std::move(nm), mActions);
+    if (!hm->Start()) {
+        return nullptr;
+    }
+    return hm;
+}
+
+std::shared_ptr<HintManager> FakeSysfs::StartFromConfig(const std::string &json_doc) {
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errorMessage;
+    if (!reader->parse(json_doc.c_str(), json_doc.c_str() + json_doc.size(), &root,
+                       &errorMessage)) {
+        return nullptr;
+    }
+
+    std::set<std::string> properties;
+    Json::Value nodes(Json::arrayValue);
+    for (auto node : root["Nodes"]) {
+        if (node["Type"].asString() == "Property") {
+            properties.insert(node["Name"].asString());
+            continue;
+        }
+        const Json::Value &values = node["Values"];
+        Json::ArrayIndex defaultIndex =
+                node.isMember("DefaultIndex") ? node["DefaultIndex"].asUInt() : values.size() - 1;
+        node["Path"] = WriteFile(node["Name"].asString(), values[defaultIndex].asString());
+        nodes.append(node);
+    }
+    root["Nodes"] = nodes;
+
+    Json::Value actions(Json::arrayValue);
+    for (const auto &action : root["Actions"]) {
+        if (!properties.count(action["Node"].asString())) {
+            actions.append(action);
+        }
+    }
+    root["Actions"] = actions;
+
+    std::string path = WriteFile("powerhint.json", Json::writeString(Json::StreamWriterBuilder(), root));
+    return HintManager::GetFromJSON(path);
+}
+
+std::string FakeSysfs::WriteFile(const std::string &relPath, const std::string &value) const {
+    std::string path = Path(relPath);
+    // Create the parent directories of nested nodes
+    for (size_t pos = path.find('/', strlen(mDir.path) + 1); pos != std::string::npos;
+         pos = path.find('/', pos + 1)) {
+        mkdir(path.substr(0, pos).c_str(), 0755);
+    }
+    android::base::WriteStringToFile(value, path);
+    return path;
+}
+
+std::string FakeSysfs::Path(const std::string &relPath) const {
+    return std::string(mDir.path) + "/" + relPath;
+}
+
+std::string FakeSysfs::Read(const std::string &relPath) const {
+    std::string value;
+    android::base::ReadFileToString(Path(relPath), &value);
+    return android::base::Trim(value);
+}
+
+bool FakeSysfs::WaitFor(const std::string &relPath, const std::string &value,
+                        std::chrono::milliseconds timeout) const {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (Read(relPath) != value) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FAKESYSFS_H
+#define FAKESYSFS_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <android-base/file.h>
+#include <perfmgr/HintManager.h>
+
+using ::android::perfmgr::HintManager;
+
+// A HintManager whose nodes are plain files in a temporary directory, so
+// the HAL code can run against it off device. libperfmgr writes from its
+// own thread, so checks on node values wait for them with WaitFor().
+class FakeSysfs {
+  public:
+    // Adds a node, created with its default value. As in powerhint.json the
+    // first value has the highest priority; the last one is the default.
+    void AddNode(const std::string &name, std::vector<std::string> values);
+    // The hint sets the node to values[index], for duration if not zero.
+    void AddAction(const std::string &hint, const std::string &node, size_t index,
+                   std::chrono::milliseconds duration = std::chrono::milliseconds(0));
+    // Builds and starts the HintManager. Nodes and actions are fixed after.
+    std::shared_ptr<HintManager> Start();
+    // Builds it from a powerhint.json document instead, with every File
+    // node moved to a file named after it under the root. Property nodes
+    // and the actions on them are left out.
+    std::shared_ptr<HintManager> StartFromConfig(const std::string &json_doc);
+
+    // Creates or overwrites a file under the root, e.g. a fake thermal zone.
+    std::string WriteFile(const std::string &relPath, const std::string &value) const;
+    std::string Path(const std::string &relPath) const;
+    std::string Read(const std::string &relPath) const;
+    // Waits until the file holds value, false if it did not in time.
+    bool WaitFor(const std::string &relPath, const std::string &value,
+                 std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) const;
+
+  private:
+    struct NodeSpec {
+        std::string name;
+        std::vector<std::string> values;
+    };
+
+    TemporaryDir mDir;
+    std::vector<NodeSpec> mNodes;
+    std::map<std::string, std::vector<::android::perfmgr::NodeAction>> mActions;
+};
+
+#endif //FAKESYSFS_H
@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <unistd.h>
+
+#include <chrono>
+#include <climits>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "FakeSysfs.h"
+#include "HintArbiter.h"
+
+namespace {
+
+// Every hint Power sends through the arbiter. CAMERA_STREAMING and
+// AUDIO_LOW_LATENCY have no priority entry.
+const std::vector<std::string> kHints = {
+        "SUSTAINED_PERFORMANCE", "VR_MODE",          "EXPENSIVE_RENDERING", "AUDIO_STREAMING",
+        "LAUNCH",                "INTERACTION",      "CAMERA_STREAMING",    "AUDIO_LOW_LATENCY",
+};
+
+const HintPriority *FindPriority(const std::vector<HintPriority> &priorities,
+                                 const std::string &hint) {
+    for (const auto &p : priorities) {
+        if (p.name == hint) return &p;
+    }
+    return nullptr;
+}
+
+// What a pair of requests should resolve to, spelled out from the rules in
+// HintArbiter.h rather than computed the way Resolve() does it.
+std::set<std::string> ExpectedPair(const std::vector<HintPriority> &priorities,
+                                   const std::string &a, const std::string &b) {
+    std::set<std::string> requested = {a, b};
+    if (requested == std::set<std::string>{"VR_MODE", "SUSTAINED_PERFORMANCE"}) {
+        return {"VR_SUSTAINED_PERFORMANCE"};
+    }
+    std::set<std::string> expected;
+    for (const auto &hint : requested) {
+        const std::string &other = hint == a ? b : a;
+        const HintPriority *self = FindPriority(priorities, hint);
+        const HintPriority *p = FindPriority(priorities, other);
+        bool heldBack = self && p && p->exclusive && p->priority > self->priority;
+        if (!heldBack) expected.insert(hint);
+    }
+    return expected;
+}
+
+std::string Describe(const std::set<std::string> &hints) {
+    std::string s = "{";
+    for (const auto &hint : hints) s += " " + hint;
+    return s + " }";
+}
+
+class HintArbiterTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        // One node per hint, so every hint has actions to apply
+        std::vector<std::string> hints = kHints;
+        hints.push_back("VR_SUSTAINED_PERFORMANCE");
+        for (const auto &hint : hints) {
+            mSysfs.AddNode(hint, {"1", "0"});
+            mSysfs.AddAction(hint, hint, 0);
+        }
+        mHintManager = mSysfs.Start();
+        ASSERT_NE(mHintManager, nullptr);
+
+        mArbiter = std::make_unique<HintArbiter>(mHintManager, HintArbiter::DefaultPriorities());
+        mArbiter->SetListener([this](const std::string &hint, bool applied) {
+            if (applied) {
+                EXPECT_TRUE(mApplied.insert(hint).second) << hint << " started twice";
+            } else {
+                EXPECT_EQ(mApplied.erase(hint), 1u) << hint << " ended while not applied";
+            }
+        });
+    }
+
+    FakeSysfs mSysfs;
+    std::shared_ptr<HintManager> mHintManager;
+    std::unique_ptr<HintArbiter> mArbiter;
+    // Hints the arbiter has started and not ended, as told to the listener
+    std::set<std::string> mApplied;
+};
+
+TEST(HintArbiterResolveTest, SingleHints) {
+    std::vector<HintPriority> priorities = HintArbiter::DefaultPriorities();
+    for (const auto &hint : kHints) {
+        EXPECT_EQ(HintArbiter::Resolve(priorities, {hint}, nullptr), std::set<std::string>{hint})
+                << hint;
+    }
+}
+
+TEST(HintArbiterResolveTest, PairMatrix) {
+    std::vector<HintPriority> priorities = HintArbiter::DefaultPriorities();
+    for (size_t i = 0; i < kHints.size(); i++) {
+        for (size_t j = i + 1; j < kHints.size(); j++) {
+            const std::string &a = kHints[i];
+            const std::string &b = kHints[j];
+            std::set<std::string> applied = HintArbiter::Resolve(priorities, {a, b}, nullptr);
+            EXPECT_EQ(applied, ExpectedPair(priorities, a, b))
+                    << a << " + " << b << " resolved to " << Describe(applied);
+        }
+    }
+}
+
+TEST(HintArbiterResolveTest, Floor) {
+    std::vector<HintPriority> priorities = HintArbiter::DefaultPriorities();
+    int floor;
+    HintArbiter::Resolve(priorities, {"INTERACTION", "LAUNCH"}, &floor);
+    EXPECT_EQ(floor, INT_MIN);
+    HintArbiter::Resolve(priorities, {"VR_MODE", "INTERACTION"}, &floor);
+    EXPECT_EQ(floor, 2);
+    HintArbiter::Resolve(priorities, {"VR_MODE", "SUSTAINED_PERFORMANCE"}, &floor);
+    EXPECT_EQ(floor, 3);
+}
+
+TEST(HintArbiterResolveTest, ParsePriorities) {
+    std::vector<HintPriority> priorities = HintArbiter::ParsePriorities(R"({
+        "Priorities": [
+            {"PowerHint": "A_AND_B", "Priority": 3, "Exclusive": true, "Components": ["A", "B"]},
+            {"PowerHint": "A", "Priority": 2, "Exclusive": true},
+            {"PowerHint": "C", "Priority": 1}
+        ]
+    })");
+    ASSERT_EQ(priorities.size(), 3u);
+    EXPECT_EQ(priorities[0].name, "A_AND_B");
+    EXPECT_EQ(priorities[0].components, (std::vector<std::string>{"A", "B"}));
+    EXPECT_TRUE(priorities[1].exclusive);
+    EXPECT_FALSE(priorities[2].exclusive);
+    EXPECT_EQ(priorities[2].priority, 1);
+
+    EXPECT_TRUE(HintArbiter::ParsePriorities(R"({"Priorities": [{"Priority": 1}]})").empty());
+}
+
+// Requests in both orders, then cancels in both orders: what is applied
+// at each step must only depend on what is requested at that step.
+TEST_F(HintArbiterTest, PairSequences) {
+    std::vector<HintPriority> priorities = HintArbiter::DefaultPriorities();
+    for (const auto &a : kHints) {
+        for (const auto &b : kHints) {
+            if (a == b) continue;
+            for (bool cancelFirstA : {true, false}) {
+                SCOPED_TRACE(a + " then " + b + (cancelFirstA ? ", cancel A" : ", cancel B"));
+                EXPECT_TRUE(mArbiter->Request(a));
+                EXPECT_EQ(mApplied, std::set<std::string>{a});
+                EXPECT_TRUE(mArbiter->Request(b));
+                EXPECT_EQ(mApplied, ExpectedPair(priorities, a, b));
+                if (!mApplied.count("VR_SUSTAINED_PERFORMANCE")) {
+                    EXPECT_EQ(mArbiter->IsSuppressed(a), !mApplied.count(a));
+                }
+
+                const std::string &first = cancelFirstA ? a : b;
+                const std::string &second = cancelFirstA ? b : a;
+                EXPECT_TRUE(mArbiter->Cancel(first));
+                EXPECT_EQ(mApplied, std::set<std::string>{second});
+                EXPECT_FALSE(mArbiter->IsRequested(first));
+                EXPECT_TRUE(mArbiter->IsRequested(second));
+                EXPECT_TRUE(mArbiter->Cancel(second));
+                EXPECT_TRUE(mApplied.empty());
+            }
+        }
+    }
+}
+
+TEST_F(HintArbiterTest, RepeatedRequests) {
+    EXPECT_TRUE(mArbiter->Request("LAUNCH"));
+    EXPECT_FALSE(mArbiter->Request("LAUNCH"));
+    EXPECT_TRUE(mArbiter->Cancel("LAUNCH"));
+    EXPECT_FALSE(mArbiter->Cancel("LAUNCH"));
+    EXPECT_TRUE(mApplied.empty());
+}
+
+// A boost that arrives during sustained performance waits for it to end
+// instead of being lost, and reaches the nodes then.
+TEST_F(HintArbiterTest, HeldBackHintIsAppliedLater) {
+    mArbiter->Request("SUSTAINED_PERFORMANCE");
+    ASSERT_TRUE(mSysfs.WaitFor("SUSTAINED_PERFORMANCE", "1"));
+    EXPECT_TRUE(mArbiter->IsSuppressed("LAUNCH"));
+    mArbiter->Request("LAUNCH");
+    EXPECT_TRUE(mArbiter->IsRequested("LAUNCH"));
+    EXPECT_FALSE(mApplied.count("LAUNCH"));
+
+    mArbiter->Cancel("SUSTAINED_PERFORMANCE");
+    EXPECT_TRUE(mSysfs.WaitFor("LAUNCH", "1"));
+    EXPECT_TRUE(mSysfs.WaitFor("SUSTAINED_PERFORMANCE", "0"));
+    mArbiter->Cancel("LAUNCH");
+    EXPECT_TRUE(mSysfs.WaitFor("LAUNCH", "0"));
+}
+
+// A timed hint requested again restarts its timeout, and once libperfmgr
+// has ended it the next request applies it again instead of being lost.
+TEST_F(HintArbiterTest, TimedRequestIsRearmed) {
+    using std::chrono::milliseconds;
+
+    EXPECT_TRUE(mArbiter->Request("LAUNCH", milliseconds(300)));
+    ASSERT_TRUE(mSysfs.WaitFor("LAUNCH", "1"));
+    usleep(200000);
+    EXPECT_FALSE(mArbiter->Request("LAUNCH", milliseconds(300)));
+    usleep(200000);
+    EXPECT_EQ(mSysfs.Read("LAUNCH"), "1");
+    ASSERT_TRUE(mSysfs.WaitFor("LAUNCH", "0"));
+
+    // Timed out without an OFF
+    usleep(100000);
+    EXPECT_TRUE(mArbiter->Request("LAUNCH", milliseconds(300)));
+    EXPECT_TRUE(mApplied.count("LAUNCH"));
+    EXPECT_TRUE(mSysfs.WaitFor("LAUNCH", "1"));
+    EXPECT_TRUE(mArbiter->Cancel("LAUNCH"));
+    EXPECT_TRUE(mSysfs.WaitFor("LAUNCH", "0"));
+    EXPECT_TRUE(mApplied.empty());
+}
+
+// A timed hint held back keeps counting down: it only gets what is left of
+// its timeout once applied, and nothing if it ran out while waiting.
+TEST_F(HintArbiterTest, HeldBackTimedHintKeepsItsDeadline) {
+    using std::chrono::milliseconds;
+
+    mArbiter->Request("SUSTAINED_PERFORMANCE");
+    mArbiter->Request("LAUNCH", milliseconds(400));
+    usleep(200000);
+    auto start = std::chrono::steady_clock::now();
+    mArbiter->Cancel("SUSTAINED_PERFORMANCE");
+    EXPECT_TRUE(mApplied.count("LAUNCH"));
+    ASSERT_TRUE(mSysfs.WaitFor("LAUNCH", "1"));
+    ASSERT_TRUE(mSysfs.WaitFor("LAUNCH", "0"));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, milliseconds(350));
+
+    mArbiter->Request("SUSTAINED_PERFORMANCE");
+    mArbiter->Request("LAUNCH", milliseconds(100));
+    usleep(200000);
+    mArbiter->Cancel("SUSTAINED_PERFORMANCE");
+    EXPECT_FALSE(mArbiter->IsRequested("LAUNCH"));
+    EXPECT_TRUE(mApplied.empty());
+    EXPECT_FALSE(mSysfs.WaitFor("LAUNCH", "1", milliseconds(200)));
+}
+
+// VR and sustained performance switch to the combined hint without the
+// combined hint's nodes seeing the parts in between.
+TEST_F(HintArbiterTest, CompositeReplacesComponents) {
+    mArbiter->Request("VR_MODE");
+    ASSERT_TRUE(mSysfs.WaitFor("VR_MODE", "1"));
+    mArbiter->Request("SUSTAINED_PERFORMANCE");
+    EXPECT_EQ(mApplied, std::set<std::string>{"VR_SUSTAINED_PERFORMANCE"});
+    EXPECT_TRUE(mSysfs.WaitFor("VR_SUSTAINED_PERFORMANCE", "1"));
+    EXPECT_TRUE(mSysfs.WaitFor("VR_MODE", "0"));
+    EXPECT_EQ(mSysfs.Read("SUSTAINED_PERFORMANCE"), "0");
+
+    mArbiter->Cancel("VR_MODE");
+    EXPECT_EQ(mApplied, std::set<std::string>{"SUSTAINED_PERFORMANCE"});
+    EXPECT_TRUE(mSysfs.WaitFor("SUSTAINED_PERFORMANCE", "1"));
+    EXPECT_TRUE(mSysfs.WaitFor("VR_SUSTAINED_PERFORMANCE", "0"));
+}
+
+}  // namespace
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "HintJournal.h"
+
+namespace {
+
+std::vector<HintJournal::Entry> Replay(HintJournal *journal) {
+    std::vector<HintJournal::Entry> entries;
+    journal->Close([&](const HintJournal::Entry &entry, int64_t ageMs) {
+        EXPECT_GE(ageMs, 0);
+        entries.push_back(entry);
+    });
+    return entries;
+}
+
+TEST(HintJournalTest, ReplaysLastEntryOfEachHint) {
+    HintJournal journal;
+    for (int32_t i = 0; i < 200; i++) {
+        ASSERT_TRUE(journal.Record(1, i));
+        ASSERT_TRUE(journal.Record(2, -i));
+    }
+    ASSERT_TRUE(journal.Record(1, 1000));
+
+    std::vector<HintJournal::Entry> entries = Replay(&journal);
+    ASSERT_EQ(2u, entries.size());
+    EXPECT_EQ(2u, entries[0].hint);
+    EXPECT_EQ(-199, entries[0].data);
+    EXPECT_EQ(1u, entries[1].hint);
+    EXPECT_EQ(1000, entries[1].data);
+
+    EXPECT_FALSE(journal.Record(1, 0));
+}
+
+// A client sending made up hint values must not grow the journal.
+TEST(HintJournalTest, ManyDistinctHintsStayBounded) {
+    HintJournal journal;
+    for (uint32_t hint = 0; hint < 10 * HintJournal::kMaxEntries; hint++)
+        ASSERT_TRUE(journal.Record(hint, 1));
+
+    std::vector<HintJournal::Entry> entries = Replay(&journal);
+    ASSERT_EQ(HintJournal::kMaxEntries, entries.size());
+    // The newest ones are kept
+    EXPECT_EQ(10 * HintJournal::kMaxEntries - 1, entries.back().hint);
+}
+
+}  // namespace
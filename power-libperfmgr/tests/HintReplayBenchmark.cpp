@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android-base/file.h>
+#include <benchmark/benchmark.h>
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+#include "FakeSysfs.h"
+#include "HintArbiter.h"
+#include "HintTrace.h"
+
+// Replays a hint trace through HintArbiter and the HintManager built from
+// powerhint.json, with the nodes in a fake sysfs tree, and counts the node
+// writes against the writes of every action of every hint call.
+//
+// POWERHINT_JSON overrides the config and POWERHAL_TRACE names a trace
+// recorded with vendor.powerhal.trace.record. Without one, a session of
+// scrolling, app launches, audio, camera and gaming is replayed. Time runs
+// kTimeScale times faster, action durations included.
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+constexpr int kTimeScale = 20;
+
+// IPower 1.3 PowerHint values
+enum : uint32_t {
+    INTERACTION = 2,
+    SUSTAINED_PERFORMANCE = 6,
+    VR_MODE = 7,
+    LAUNCH = 8,
+    AUDIO_STREAMING = 9,
+    AUDIO_LOW_LATENCY = 10,
+    CAMERA_LAUNCH = 11,
+    CAMERA_STREAMING = 12,
+    CAMERA_SHOT = 13,
+    EXPENSIVE_RENDERING = 14,
+};
+
+const std::map<uint32_t, std::string> kHintNames = {
+        {SUSTAINED_PERFORMANCE, "SUSTAINED_PERFORMANCE"},
+        {VR_MODE, "VR_MODE"},
+        {LAUNCH, "LAUNCH"},
+        {AUDIO_STREAMING, "AUDIO_STREAMING"},
+        {AUDIO_LOW_LATENCY, "AUDIO_LOW_LATENCY"},
+        {CAMERA_STREAMING, "CAMERA_STREAMING"},
+        {EXPENSIVE_RENDERING, "EXPENSIVE_RENDERING"},
+};
+
+// Keep in sync with Power.h and InteractionHandler.cpp
+constexpr int32_t kInteractionBoostMs = 1400;
+constexpr int32_t kCameraLaunchBoostMs = 2500;
+
+struct TraceEntry {
+    int64_t ms;
+    uint32_t hint;
+    int32_t data;
+};
+
+std::vector<TraceEntry> SessionTrace() {
+    std::vector<TraceEntry> trace;
+    int64_t t = 0;
+    auto gesture = [&](int touches) {
+        for (int i = 0; i < touches; i++, t += 100) trace.push_back({t, INTERACTION, 0});
+    };
+
+    // Scrolling, then app launches
+    for (int i = 0; i < 10; i++, t += 1500) gesture(10);
+    for (int i = 0; i < 5; i++, t += 3000) {
+        gesture(1);
+        trace.push_back({t, LAUNCH, 1});
+        trace.push_back({t + 700, LAUNCH, 0});
+    }
+    // Music while scrolling
+    trace.push_back({t, AUDIO_STREAMING, 1});
+    t += 300;
+    trace.push_back({t, AUDIO_STREAMING, 0});
+    for (int i = 0; i < 5; i++, t += 1500) gesture(10);
+    // Camera: launch, preview, three shots
+    trace.push_back({t, CAMERA_LAUNCH, 1000});
+    trace.push_back({t + 800, CAMERA_STREAMING, 1});
+    t += 1000;
+    for (int i = 0; i < 3; i++, t += 2000) trace.push_back({t, CAMERA_SHOT, 500});
+    trace.push_back({t, CAMERA_STREAMING, 0});
+    t += 1000;
+    // A game with touches and heavy scenes
+    trace.push_back({t, SUSTAINED_PERFORMANCE, 1});
+    for (int i = 0; i < 10; i++, t += 2000) {
+        gesture(5);
+        trace.push_back({t, EXPENSIVE_RENDERING, i % 2 ? 0 : 1});
+    }
+    trace.push_back({t, EXPENSIVE_RENDERING, 0});
+    trace.push_back({t, SUSTAINED_PERFORMANCE, 0});
+    return trace;
+}
+
+std::vector<TraceEntry> LoadTrace(const char *path) {
+    std::string data;
+    std::vector<TraceEntry> trace;
+    if (!android::base::ReadFileToString(path, &data)) return trace;
+
+    int64_t startNs = -1;
+    for (size_t off = 0; off + 16 <= data.size(); off += 16) {
+        auto u32 = [&](size_t at) {
+            uint32_t v = 0;
+            for (int i = 0; i < 4; i++)
+                v |= static_cast<uint32_t>(static_cast<uint8_t>(data[at + i])) << (8 * i);
+            return v;
+        };
+        uint32_t hint = u32(off);
+        int64_t ns = static_cast<int64_t>(u32(off + 8) | static_cast<uint64_t>(u32(off + 12)) << 32);
+        // Session starts and display idle events do not reach the nodes
+        if (hint == HintTraceRecorder::kMagic || hint == HintTraceRecorder::kDisplayIdle) continue;
+        if (startNs < 0) startNs = ns;
+        trace.push_back({(ns - startNs) / 1000000, hint, static_cast<int32_t>(u32(off + 4))});
+    }
+    return trace;
+}
+
+class Replay {
+  public:
+    bool Init() {
+        const char *configPath = getenv("POWERHINT_JSON");
+        std::string doc;
+        if (!android::base::ReadFileToString(configPath ? configPath : "/vendor/etc/powerhint.json",
+                                             &doc)) {
+            return false;
+        }
+
+        Json::Value root;
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        std::string errorMessage;
+        if (!reader->parse(doc.c_str(), doc.c_str() + doc.size(), &root, &errorMessage)) {
+            return false;
+        }
+        std::map<std::string, bool> property;
+        for (const auto &node : root["Nodes"])
+            property[node["Name"].asString()] = node["Type"].asString() == "Property";
+        for (auto &action : root["Actions"]) {
+            action["Duration"] = action["Duration"].asUInt64() / kTimeScale;
+            if (!property[action["Node"].asString()]) mActionCount[action["PowerHint"].asString()]++;
+        }
+        doc = Json::writeString(Json::StreamWriterBuilder(), root);
+
+        mHintManager = mSysfs.StartFromConfig(doc);
+        if (!mHintManager) return false;
+        mArbiter = std::make_unique<HintArbiter>(mHintManager, HintArbiter::ParsePriorities(doc));
+
+        mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        return inotify_add_watch(mInotifyFd, mSysfs.Path("").c_str(), IN_MODIFY) >= 0;
+    }
+
+    ~Replay() {
+        if (mInotifyFd >= 0) close(mInotifyFd);
+    }
+
+    // Mirrors Power::handleHint_1_3 with a static INTERACTION boost
+    void Dispatch(const TraceEntry &entry) {
+        switch (entry.hint) {
+            case INTERACTION:
+                if (!mArbiter->IsSuppressed("INTERACTION"))
+                    DoHint("INTERACTION", kInteractionBoostMs);
+                break;
+            case CAMERA_LAUNCH:
+                if (entry.data > 0) {
+                    DoHint("CAMERA_LAUNCH", entry.data);
+                    DoHint("LAUNCH", kCameraLaunchBoostMs);
+                } else if (entry.data == 0) {
+                    EndHint("CAMERA_LAUNCH");
+                }
+                break;
+            case CAMERA_SHOT:
+                if (entry.data > 0)
+                    DoHint("CAMERA_SHOT", entry.data);
+                else if (entry.data == 0)
+                    EndHint("CAMERA_SHOT");
+                break;
+            default: {
+                auto name = kHintNames.find(entry.hint);
+                if (name == kHintNames.end()) break;
+                Count(name->second);
+                if (entry.data > 0)
+                    mArbiter->Request(name->second);
+                else if (entry.data == 0)
+                    mArbiter->Cancel(name->second);
+                break;
+            }
+        }
+    }
+
+    // Node writes since the last call
+    uint64_t DrainWrites() {
+        alignas(struct inotify_event) char buf[4096];
+        uint64_t writes = 0;
+        ssize_t len;
+        while ((len = read(mInotifyFd, buf, sizeof(buf))) > 0) {
+            for (char *p = buf; p < buf + len;) {
+                auto *event = reinterpret_cast<struct inotify_event *>(p);
+                writes++;
+                p += sizeof(*event) + event->len;
+            }
+        }
+        return writes;
+    }
+
+    uint64_t mCalls = 0;
+    uint64_t mActionWrites = 0;
+
+  private:
+    void Count(const std::string &hint) {
+        mCalls++;
+        mActionWrites += mActionCount[hint];
+    }
+    void DoHint(const std::string &hint, int32_t ms) {
+        Count(hint);
+        mHintManager->DoHint(hint, milliseconds(ms / kTimeScale));
+    }
+    void EndHint(const std::string &hint) {
+        Count(hint);
+        mHintManager->EndHint(hint);
+    }
+
+    FakeSysfs mSysfs;
+    std::shared_ptr<HintManager> mHintManager;
+    std::unique_ptr<HintArbiter> mArbiter;
+    std::map<std::string, uint64_t> mActionCount;
+    int mInotifyFd = -1;
+};
+
+void BM_HintReplay(benchmark::State &state) {
+    const char *tracePath = getenv("POWERHAL_TRACE");
+    std::vector<TraceEntry> trace = tracePath ? LoadTrace(tracePath) : SessionTrace();
+    Replay replay;
+    if (trace.empty() || !replay.Init()) {
+        state.SkipWithError("no trace or config");
+        return;
+    }
+    replay.DrainWrites();
+
+    uint64_t writes = 0;
+    for (auto _ : state) {
+        double callSeconds = 0;
+        auto start = steady_clock::now();
+        for (const auto &entry : trace) {
+            std::this_thread::sleep_until(start + milliseconds(entry.ms / kTimeScale));
+            auto begin = steady_clock::now();
+            replay.Dispatch(entry);
+            callSeconds += std::chrono::duration<double>(steady_clock::now() - begin).count();
+        }
+        // Let the timed hints run out before counting
+        std::this_thread::sleep_for(milliseconds(5000 / kTimeScale));
+        writes += replay.DrainWrites();
+        state.SetIterationTime(callSeconds);
+    }
+
+    state.counters["calls"] = replay.mCalls;
+    state.counters["action_writes"] = replay.mActionWrites;
+    state.counters["node_writes"] = writes;
+    state.counters["skipped_pct"] =
+            replay.mActionWrites ? 100.0 * (1.0 - double(writes) / replay.mActionWrites) : 0;
+}
+BENCHMARK(BM_HintReplay)->UseManualTime()->Iterations(1)->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "FakeSysfs.h"
+#include "HintSession.h"
+
+namespace {
+
+using std::chrono::steady_clock;
+
+constexpr int64_t kTargetNs = 8333333;  // 120 Hz frame
+
+struct Sessions {
+    explicit Sessions(int count) {
+        mSysfs.AddNode("TASchedtuneBoost", {"50", "40", "30", "20", "10"});
+        std::vector<std::string> levels;
+        for (int i = 0; i < 4; i++) {
+            levels.push_back("SESSION_BOOST_" + std::to_string(i));
+            mSysfs.AddAction(levels.back(), "TASchedtuneBoost", 3 - i);
+        }
+        mManager = std::make_unique<HintSessionManager>(mSysfs.Start(), levels, false);
+        mManager->Init();
+        for (int i = 0; i < count; i++)
+            mIds.push_back(mManager->CreateSession(getpid(), {gettid()}, kTargetNs));
+    }
+
+    FakeSysfs mSysfs;
+    std::unique_ptr<HintSessionManager> mManager;
+    std::vector<int64_t> mIds;
+};
+
+void ReportPercentiles(benchmark::State &state, std::vector<double> *samplesUs) {
+    if (samplesUs->empty()) return;
+    std::sort(samplesUs->begin(), samplesUs->end());
+    auto at = [&](double p) { return (*samplesUs)[(samplesUs->size() - 1) * p]; };
+    state.counters["p50_us"] = at(0.50);
+    state.counters["p99_us"] = at(0.99);
+    state.counters["max_us"] = samplesUs->back();
+}
+
+// Cost of one report with range(0) sessions open, each reporting in turn
+// with durations around the target, as a render loop would.
+void BM_ReportActualWorkDuration(benchmark::State &state) {
+    Sessions sessions(state.range(0));
+    std::vector<double> samplesUs;
+    size_t n = 0;
+    for (auto _ : state) {
+        int64_t actualNs = kTargetNs + (n % 7 - 3) * kTargetNs / 8;
+        auto start = steady_clock::now();
+        sessions.mManager->ReportActualWorkDuration(sessions.mIds[n % sessions.mIds.size()],
+                                                    {actualNs});
+        samplesUs.push_back(
+                std::chrono::duration<double, std::micro>(steady_clock::now() - start).count());
+        n++;
+    }
+    ReportPercentiles(state, &samplesUs);
+}
+BENCHMARK(BM_ReportActualWorkDuration)->Arg(1)->Arg(8)->Arg(32);
+
+// Time from a run of late frames starting to the schedtune ladder holding
+// the top level, reporting once per frame.
+void BM_BoostLatency(benchmark::State &state) {
+    Sessions sessions(1);
+    int64_t id = sessions.mIds[0];
+    std::vector<double> samplesUs;
+    for (auto _ : state) {
+        // Settle at the lowest level first
+        while (sessions.mSysfs.Read("TASchedtuneBoost") != "10") {
+            sessions.mManager->ReportActualWorkDuration(id, {kTargetNs / 4});
+            std::this_thread::sleep_for(std::chrono::nanoseconds(kTargetNs));
+        }
+
+        auto start = steady_clock::now();
+        while (sessions.mSysfs.Read("TASchedtuneBoost") != "50") {
+            sessions.mManager->ReportActualWorkDuration(id, {2 * kTargetNs});
+            std::this_thread::sleep_for(std::chrono::nanoseconds(kTargetNs));
+        }
+        double us = std::chrono::duration<double, std::micro>(steady_clock::now() - start).count();
+        samplesUs.push_back(us);
+        state.SetIterationTime(us / 1e6);
+    }
+    ReportPercentiles(state, &samplesUs);
+}
+BENCHMARK(BM_BoostLatency)->UseManualTime()->Iterations(10)->Unit(benchmark::kMillisecond);
+
+}  // namespace
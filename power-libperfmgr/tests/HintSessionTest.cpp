@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+
+#include "FakeSysfs.h"
+#include "HintSession.h"
+
+namespace {
+
+using Params = HintSessionManager::Params;
+using State = HintSessionManager::State;
+
+constexpr Params kParams = {160, 512, 0.5, 0.05, 4.0};
+constexpr int64_t kTargetNs = 8000000;  // 120 Hz frame
+
+TEST(HintSessionUpdateTest, FollowsError) {
+    State state{0, kParams.initBoost};
+
+    // On target: the boost stays where it starts
+    EXPECT_EQ(kParams.initBoost, HintSessionManager::Update(kParams, &state, kTargetNs, kTargetNs));
+
+    // Late work raises it, and the integral keeps raising it
+    int late = HintSessionManager::Update(kParams, &state, 2 * kTargetNs, kTargetNs);
+    EXPECT_GT(late, kParams.initBoost);
+    EXPECT_GT(HintSessionManager::Update(kParams, &state, 2 * kTargetNs, kTargetNs), late);
+
+    // Never past the maximum however late
+    for (int i = 0; i < 100; i++) HintSessionManager::Update(kParams, &state, 10 * kTargetNs, kTargetNs);
+    EXPECT_EQ(kParams.maxBoost, state.boost);
+    EXPECT_DOUBLE_EQ(kParams.integralMax, state.integral);
+
+    // Early work brings it back down to nothing
+    for (int i = 0; i < 100; i++) HintSessionManager::Update(kParams, &state, kTargetNs / 4, kTargetNs);
+    EXPECT_EQ(0, state.boost);
+}
+
+// Sessions against the schedtune ladder of powerhint.json in a fake sysfs
+class HintSessionTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        mSysfs.AddNode("TASchedtuneBoost", {"50", "40", "30", "20", "10"});
+        std::vector<std::string> levels;
+        for (int i = 0; i < 4; i++) {
+            levels.push_back("SESSION_BOOST_" + std::to_string(i));
+            mSysfs.AddAction(levels.back(), "TASchedtuneBoost", 3 - i);
+        }
+        mManager = std::make_unique<HintSessionManager>(mSysfs.Start(), levels, false);
+        ASSERT_TRUE(mManager->Init());
+    }
+
+    bool WaitForBoost(const std::string &value) {
+        return mSysfs.WaitFor("TASchedtuneBoost", value);
+    }
+
+    // Reports spaced past the rate limit so each one can apply
+    void Report(int64_t id, int64_t actualNs, int count) {
+        for (int i = 0; i < count; i++) {
+            ASSERT_TRUE(mManager->ReportActualWorkDuration(id, {actualNs}));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    FakeSysfs mSysfs;
+    std::unique_ptr<HintSessionManager> mManager;
+};
+
+TEST_F(HintSessionTest, RejectsBadSessions) {
+    EXPECT_EQ(-1, mManager->CreateSession(0, {gettid()}, kTargetNs));
+    EXPECT_EQ(-1, mManager->CreateSession(getpid(), {}, kTargetNs));
+    EXPECT_EQ(-1, mManager->CreateSession(getpid(), {gettid()}, 0));
+    EXPECT_EQ(-1, mManager->CreateSession(getpid(), std::vector<int32_t>(17, gettid()),
+                                          kTargetNs));
+    EXPECT_FALSE(mManager->ReportActualWorkDuration(42, {kTargetNs}));
+    EXPECT_FALSE(mManager->UpdateTargetWorkDuration(42, kTargetNs));
+    EXPECT_FALSE(mManager->CloseSession(42));
+}
+
+TEST_F(HintSessionTest, BoostFollowsReports) {
+    int64_t id = mManager->CreateSession(getpid(), {gettid()}, kTargetNs);
+    ASSERT_GT(id, 0);
+    // The initial boost is the second level
+    EXPECT_TRUE(WaitForBoost("30"));
+
+    Report(id, 3 * kTargetNs, 10);
+    EXPECT_TRUE(WaitForBoost("50"));
+
+    Report(id, kTargetNs / 4, 20);
+    EXPECT_TRUE(WaitForBoost("10"));
+
+    EXPECT_TRUE(mManager->CloseSession(id));
+    EXPECT_TRUE(WaitForBoost("10"));
+}
+
+TEST_F(HintSessionTest, NeediestSessionWins) {
+    int64_t calm = mManager->CreateSession(getpid(), {gettid()}, kTargetNs);
+    int64_t busy = mManager->CreateSession(getpid(), {gettid()}, kTargetNs);
+    ASSERT_GT(calm, 0);
+    ASSERT_GT(busy, 0);
+
+    Report(busy, 3 * kTargetNs, 10);
+    EXPECT_TRUE(WaitForBoost("50"));
+
+    // Closing the busy one falls back to the calm one's level, the initial
+    // boost once it reports again after going idle
+    EXPECT_TRUE(mManager->CloseSession(busy));
+    Report(calm, kTargetNs, 1);
+    EXPECT_TRUE(WaitForBoost("30"));
+    EXPECT_TRUE(mManager->CloseSession(calm));
+    EXPECT_TRUE(WaitForBoost("10"));
+}
+
+TEST_F(HintSessionTest, StaleSessionDropsBoost) {
+    int64_t id = mManager->CreateSession(getpid(), {gettid()}, kTargetNs);
+    ASSERT_GT(id, 0);
+    Report(id, 3 * kTargetNs, 10);
+    EXPECT_TRUE(WaitForBoost("50"));
+
+    // No reports for 20 targets, at least 100 ms: the boost goes away
+    EXPECT_TRUE(WaitForBoost("10"));
+    // and stays away over the next ticks
+    for (int i = 0; i < 50; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ASSERT_EQ("10", mSysfs.Read("TASchedtuneBoost")) << "after " << (i + 1) * 10 << " ms";
+    }
+
+    // and reports start over from the initial boost
+    Report(id, kTargetNs, 1);
+    EXPECT_TRUE(WaitForBoost("30"));
+}
+
+TEST_F(HintSessionTest, HandleCommand) {
+    TemporaryFile out;
+    auto run = [&](std::vector<std::string> args) {
+        EXPECT_TRUE(mManager->HandleCommand(args, out.fd));
+        std::string result;
+        android::base::ReadFileToString(out.path, &result);
+        ftruncate(out.fd, 0);
+        lseek(out.fd, 0, SEEK_SET);
+        return result;
+    };
+
+    EXPECT_FALSE(mManager->HandleCommand({"--stats-deltas"}, out.fd));
+    std::string created = run({"--session", "create", std::to_string(getpid()),
+                               std::to_string(kTargetNs), std::to_string(gettid())});
+    ASSERT_EQ(0u, created.find("session "));
+    std::string id = created.substr(8, created.size() - 9);
+
+    EXPECT_EQ("ok\n", run({"--session", "report", id, std::to_string(kTargetNs)}));
+    EXPECT_EQ("ok\n", run({"--session", "target", id, "16000000"}));
+    EXPECT_EQ("ok\n", run({"--session", "close", id}));
+    EXPECT_EQ("no such session\n", run({"--session", "close", id}));
+    EXPECT_EQ("Invalid session command arguments\n", run({"--session", "report", "x"}));
+}
+
+}  // namespace
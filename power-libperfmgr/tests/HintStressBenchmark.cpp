@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android-base/macros.h>
+#include <android-base/unique_fd.h>
+#include <benchmark/benchmark.h>
+
+#include "FakeSysfs.h"
+#include "HintArbiter.h"
+#include "StatsSamples.h"
+#include "power-helper.h"
+
+// Tail latency of the hint path while other binder threads serve low power
+// stats queries and debug() dumps, as the service's thread pool does.
+// range(0) is the number of those other threads; with none it is the
+// uncontended baseline.
+
+namespace {
+
+using std::chrono::steady_clock;
+
+struct Hints {
+    Hints() {
+        mSysfs.AddNode("CPUMinFreq", {"1766400", "1209600", "300000"});
+        mSysfs.AddNode("GPUMinFreq", {"520000000", "257000000"});
+        mSysfs.AddAction("LAUNCH", "CPUMinFreq", 0);
+        mSysfs.AddAction("LAUNCH", "GPUMinFreq", 0);
+        mSysfs.AddAction("SUSTAINED_PERFORMANCE", "CPUMinFreq", 1);
+        mArbiter = std::make_unique<HintArbiter>(mSysfs.Start(),
+                                                 HintArbiter::DefaultPriorities());
+    }
+
+    FakeSysfs mSysfs;
+    std::unique_ptr<HintArbiter> mArbiter;
+};
+
+// One binder thread of the pool that is not serving hints. Even threads
+// parse the stats as the fallback read does; odd ones dump the arbiter.
+void OtherCalls(int index, HintArbiter *arbiter, const std::atomic<bool> *stop) {
+    android::base::unique_fd devnull(open("/dev/null", O_WRONLY | O_CLOEXEC));
+    uint64_t master[MAX_MASTER_COUNT * MASTER_STATS_COUNT];
+    uint64_t system[SYSTEM_SLEEP_STATE_COUNT * SYSTEM_STATE_STATS_COUNT];
+    while (!stop->load(std::memory_order_relaxed)) {
+        if (index % 2 == 0) {
+            parse_master_stats(kMasterStatsSample, strlen(kMasterStatsSample), master,
+                               ARRAY_SIZE(master));
+            parse_system_stats(kSystemStatsSample, strlen(kSystemStatsSample), system,
+                               ARRAY_SIZE(system));
+        } else {
+            arbiter->DumpToFd(devnull.get());
+        }
+    }
+}
+
+void ReportPercentiles(benchmark::State &state, std::vector<double> *samplesUs) {
+    if (samplesUs->empty()) return;
+    std::sort(samplesUs->begin(), samplesUs->end());
+    auto at = [&](double p) { return (*samplesUs)[(samplesUs->size() - 1) * p]; };
+    state.counters["p50_us"] = at(0.50);
+    state.counters["p99_us"] = at(0.99);
+    state.counters["max_us"] = samplesUs->back();
+}
+
+// One LAUNCH hint as Power handles it: the suppression check, then the
+// request or the cancel, alternating.
+void BM_HintUnderStatsLoad(benchmark::State &state) {
+    Hints hints;
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> others;
+    for (int i = 0; i < state.range(0); i++)
+        others.emplace_back(OtherCalls, i, hints.mArbiter.get(), &stop);
+
+    std::vector<double> samplesUs;
+    bool launch = false;
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        launch = !launch;
+        if (!launch) {
+            hints.mArbiter->Cancel("LAUNCH");
+        } else if (!hints.mArbiter->IsSuppressed("LAUNCH")) {
+            hints.mArbiter->Request("LAUNCH", std::chrono::milliseconds(5000));
+        }
+        samplesUs.push_back(
+                std::chrono::duration<double, std::micro>(steady_clock::now() - start).count());
+    }
+
+    stop = true;
+    for (auto &t : others) t.join();
+    ReportPercentiles(state, &samplesUs);
+}
+BENCHMARK(BM_HintUnderStatsLoad)->Arg(0)->Arg(1)->Arg(3)->UseRealTime();
+
+}  // namespace
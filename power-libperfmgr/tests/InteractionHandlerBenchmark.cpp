@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <android-base/file.h>
+#include <benchmark/benchmark.h>
+
+#include "FakeSysfs.h"
+#include "InteractionHandler.h"
+
+// The benchmark target points FB_IDLE_PATH at a plain file. That cannot be
+// added to epoll, so these runs use the polled idle fallback.
+
+namespace {
+
+using std::chrono::steady_clock;
+
+constexpr auto kTouchInterval = std::chrono::microseconds(8333);  // 120 Hz
+constexpr int kTouchesPerGesture = 30;
+// StaticDuration(0) plus the 100 ms idle check delay
+constexpr auto kBoostLength = std::chrono::milliseconds(1400 + 100);
+
+class Touch {
+  public:
+    Touch() {
+        mSysfs.AddNode("CPUMinFreq", {"1766400", "0"});
+        mSysfs.AddAction("INTERACTION", "CPUMinFreq", 0);
+        SetIdle(false);
+        mHandler = std::make_unique<InteractionHandler>(mSysfs.Start());
+        mHandler->Init();
+    }
+
+    void SetIdle(bool idle) {
+        android::base::WriteStringToFile(idle ? "idle" : "busy", FB_IDLE_PATH);
+    }
+
+    // Touches at 120 Hz, returns the time of the last one
+    steady_clock::time_point Gesture() {
+        auto next = steady_clock::now();
+        for (int i = 0; i < kTouchesPerGesture; i++) {
+            std::this_thread::sleep_until(next);
+            mHandler->Acquire(0);
+            next += kTouchInterval;
+        }
+        return next - kTouchInterval;
+    }
+
+    bool WaitForRelease() {
+        return mSysfs.WaitFor("CPUMinFreq", "0", std::chrono::seconds(10));
+    }
+
+    FakeSysfs mSysfs;
+    std::unique_ptr<InteractionHandler> mHandler;
+};
+
+// Cost of Acquire() on the touch path while a stream keeps the boost held
+void BM_AcquireTouchStream(benchmark::State &state) {
+    Touch touch;
+    auto next = steady_clock::now();
+    for (auto _ : state) {
+        std::this_thread::sleep_until(next);
+        auto start = steady_clock::now();
+        touch.mHandler->Acquire(0);
+        state.SetIterationTime(
+                std::chrono::duration<double>(steady_clock::now() - start).count());
+        next += kTouchInterval;
+    }
+}
+BENCHMARK(BM_AcquireTouchStream)->UseManualTime()->Iterations(600);
+
+// Time from the display going idle after a gesture to the boost ending,
+// at least the 100 ms idle check delay after the last touch
+void BM_ReleaseAfterIdle(benchmark::State &state) {
+    Touch touch;
+    for (auto _ : state) {
+        touch.SetIdle(false);
+        touch.Gesture();
+        touch.SetIdle(true);
+        auto idle = steady_clock::now();
+        if (!touch.WaitForRelease()) {
+            state.SkipWithError("boost not released");
+            break;
+        }
+        state.SetIterationTime(std::chrono::duration<double>(steady_clock::now() - idle).count());
+    }
+}
+BENCHMARK(BM_ReleaseAfterIdle)->UseManualTime()->Iterations(10)->Unit(benchmark::kMillisecond);
+
+// How late the boost ends after its deadline when the display never idles
+void BM_ReleaseAtDeadline(benchmark::State &state) {
+    Touch touch;
+    touch.SetIdle(false);
+    for (auto _ : state) {
+        auto deadline = touch.Gesture() + kBoostLength;
+        if (!touch.WaitForRelease()) {
+            state.SkipWithError("boost not released");
+            break;
+        }
+        state.SetIterationTime(
+                std::chrono::duration<double>(steady_clock::now() - deadline).count());
+    }
+}
+BENCHMARK(BM_ReleaseAtDeadline)->UseManualTime()->Iterations(5)->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+
+#include "node-cache.h"
+
+namespace {
+
+using android::base::ReadFileToString;
+using android::base::WriteStringToFile;
+
+// The cache holds a fixed number of nodes for the life of the process, so
+// every test, and every repeat of it, uses the same few paths.
+std::string NodePath(const std::string &name) {
+    static TemporaryDir dir;
+    return std::string(dir.path) + "/" + name;
+}
+
+std::string ReadNode(const std::string &path) {
+    std::string value;
+    ReadFileToString(path, &value);
+    return value;
+}
+
+TEST(NodeCacheTest, WritesAreCombinedUntilInvalidated) {
+    std::string node = NodePath("double_tap");
+    ASSERT_TRUE(WriteStringToFile("0", node));
+    node_cache_invalidate(node.c_str());
+    uint64_t issued, skipped, issuedBefore, skippedBefore;
+    node_cache_get_stats(&issuedBefore, &skippedBefore);
+
+    EXPECT_EQ(0, node_cache_write(node.c_str(), "1"));
+    EXPECT_EQ("1", ReadNode(node));
+
+    // A driver reset is not seen, the same value is skipped...
+    ASSERT_TRUE(WriteStringToFile("0", node));
+    EXPECT_EQ(0, node_cache_write(node.c_str(), "1"));
+    EXPECT_EQ("0", ReadNode(node));
+
+    // ...until the cached value is dropped.
+    node_cache_invalidate(node.c_str());
+    EXPECT_EQ(0, node_cache_write(node.c_str(), "1"));
+    EXPECT_EQ("1", ReadNode(node));
+
+    node_cache_get_stats(&issued, &skipped);
+    EXPECT_EQ(2u, issued - issuedBefore);
+    EXPECT_EQ(1u, skipped - skippedBefore);
+}
+
+// A node whose reads fail has its fd closed and reopened on every read, and
+// the fd number is reused at once by the next open(). A read that raced with
+// the close must not end up reading whatever file got the number.
+TEST(NodeCacheTest, ReadErrorsDoNotReadReusedFds) {
+    std::string broken = NodePath("broken");
+    ASSERT_TRUE(mkdir(broken.c_str(), 0700) == 0 || errno == EEXIST);
+    std::string other = NodePath("other");
+    ASSERT_TRUE(WriteStringToFile("other", other));
+
+    std::atomic<bool> stop(false);
+    std::thread opener([&] {
+        while (!stop) ReadNode(other);
+    });
+    std::atomic<int> unexpected(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 2; i++) {
+        readers.emplace_back([&] {
+            char buf[32];
+            for (int n = 0; n < 20000; n++) {
+                if (node_cache_read(broken.c_str(), buf, sizeof(buf)) != -EISDIR) unexpected++;
+            }
+        });
+    }
+    for (auto &t : readers) t.join();
+    stop = true;
+    opener.join();
+
+    EXPECT_EQ(0, unexpected);
+}
+
+}  // namespace
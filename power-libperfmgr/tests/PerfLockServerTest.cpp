@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <android-base/file.h>
+#include <android-base/unique_fd.h>
+#include <gtest/gtest.h>
+
+#include "PerfLockServer.h"
+
+namespace {
+
+using android::base::unique_fd;
+
+std::pair<int, int> Change(PerfLockResource resource, int level) {
+    return {resource, level};
+}
+
+class PerfLockServerTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        mPath = std::string(mDir.path) + "/perflock";
+        mSocketFd.reset(socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+        ASSERT_GE(mSocketFd, 0);
+        ASSERT_EQ(0, bind(mSocketFd, Address(), sizeof(struct sockaddr_un)));
+        mServer = std::make_unique<PerfLockServer>([this](PerfLockResource resource, int level) {
+            std::lock_guard<std::mutex> lk(mLock);
+            mChanges.emplace_back(resource, level);
+            mCond.notify_all();
+        });
+        ASSERT_TRUE(mServer->Init(mSocketFd));
+    }
+
+    void TearDown() override { mServer.reset(); }
+
+    struct sockaddr *Address() {
+        mAddr = {};
+        mAddr.sun_family = AF_UNIX;
+        snprintf(mAddr.sun_path, sizeof(mAddr.sun_path), "%s", mPath.c_str());
+        return reinterpret_cast<struct sockaddr *>(&mAddr);
+    }
+
+    unique_fd Connect() {
+        unique_fd fd(socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+        EXPECT_EQ(0, connect(fd, Address(), sizeof(struct sockaddr_un)));
+        return fd;
+    }
+
+    static void Send(int fd, PerfLockResource resource, int level) {
+        PerfLockLevel message = {static_cast<uint32_t>(resource), level};
+        ASSERT_EQ(static_cast<ssize_t>(sizeof(message)), send(fd, &message, sizeof(message), 0));
+    }
+
+    // The next change the server applied, or {-1, -1} if none came in time.
+    std::pair<int, int> Next() {
+        std::unique_lock<std::mutex> lk(mLock);
+        if (!mCond.wait_for(lk, std::chrono::seconds(2), [this] { return !mChanges.empty(); }))
+            return {-1, -1};
+        auto change = mChanges.front();
+        mChanges.pop_front();
+        return {change.first, change.second};
+    }
+
+    bool NoMoreChanges() {
+        std::unique_lock<std::mutex> lk(mLock);
+        return !mCond.wait_for(lk, std::chrono::milliseconds(100),
+                               [this] { return !mChanges.empty(); });
+    }
+
+    TemporaryDir mDir;
+    std::string mPath;
+    struct sockaddr_un mAddr;
+    // Owned by the test, as init owns the HAL's
+    unique_fd mSocketFd;
+    std::unique_ptr<PerfLockServer> mServer;
+    std::mutex mLock;
+    std::condition_variable mCond;
+    std::deque<std::pair<PerfLockResource, int>> mChanges;
+};
+
+TEST_F(PerfLockServerTest, HoldsHighestLevelOfAllClients) {
+    unique_fd camera = Connect();
+    unique_fd codec = Connect();
+
+    Send(camera, PERF_LOCK_CPU_BIG_MIN, 1);
+    EXPECT_EQ(Change(PERF_LOCK_CPU_BIG_MIN, 1), Next());
+    Send(codec, PERF_LOCK_CPU_BIG_MIN, 3);
+    EXPECT_EQ(Change(PERF_LOCK_CPU_BIG_MIN, 3), Next());
+    // Lower than what the codec holds: no change
+    Send(camera, PERF_LOCK_CPU_BIG_MIN, 2);
+    EXPECT_TRUE(NoMoreChanges());
+
+    Send(codec, PERF_LOCK_CPU_BIG_MIN, 0);
+    EXPECT_EQ(Change(PERF_LOCK_CPU_BIG_MIN, 2), Next());
+    Send(camera, PERF_LOCK_CPU_BIG_MIN, 0);
+    EXPECT_EQ(Change(PERF_LOCK_CPU_BIG_MIN, 0), Next());
+}
+
+TEST_F(PerfLockServerTest, DropsLevelsOfClosedClients) {
+    unique_fd camera = Connect();
+    unique_fd codec = Connect();
+
+    Send(camera, PERF_LOCK_GPU_MIN, 2);
+    EXPECT_EQ(Change(PERF_LOCK_GPU_MIN, 2), Next());
+    Send(codec, PERF_LOCK_GPU_MIN, 1);
+    Send(codec, PERF_LOCK_SCHED_BOOST, 3);
+    EXPECT_EQ(Change(PERF_LOCK_SCHED_BOOST, 3), Next());
+
+    // The camera died holding its lock
+    camera.reset();
+    EXPECT_EQ(Change(PERF_LOCK_GPU_MIN, 1), Next());
+    codec.reset();
+    auto first = Next();
+    auto second = Next();
+    EXPECT_EQ(Change(PERF_LOCK_SCHED_BOOST, 0), first);
+    EXPECT_EQ(Change(PERF_LOCK_GPU_MIN, 0), second);
+}
+
+TEST_F(PerfLockServerTest, IgnoresBadMessages) {
+    unique_fd client = Connect();
+
+    PerfLockLevel unknown = {PERF_LOCK_RESOURCE_COUNT, 1};
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(unknown)), send(client, &unknown, sizeof(unknown), 0));
+    uint32_t truncated = 0;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(truncated)),
+              send(client, &truncated, sizeof(truncated), 0));
+    // Levels past the last one are clamped
+    Send(client, PERF_LOCK_CPUBW_MIN, 100);
+    EXPECT_EQ(Change(PERF_LOCK_CPUBW_MIN, kPerfLockLevelCount), Next());
+    EXPECT_TRUE(NoMoreChanges());
+}
+
+}  // namespace
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <android-base/file.h>
+#include <android-base/macros.h>
+#include <benchmark/benchmark.h>
+
+#include "StatsSamples.h"
+#include "power-helper.h"
+
+namespace {
+
+// The getline() parser power-helper.c used before it read the whole file at
+// once, kept here as the baseline.
+struct LegacySection {
+    const char *label;
+    const char *const *stats_labels;
+    size_t num_stats;
+};
+
+const char *const kLegacyMasterLabels[] = {
+        "Sleep Accumulated Duration",
+        "Sleep Count",
+        "Sleep Last Entered At",
+};
+
+const char *const kLegacySystemLabels[] = {
+        "count",
+        "actual last sleep(msec)",
+};
+
+const LegacySection kLegacyMasterSections[] = {
+        {"APSS", kLegacyMasterLabels, 3},
+        {"MPSS", kLegacyMasterLabels, 3},
+        {"ADSP", kLegacyMasterLabels, 3},
+        {"SLPI", kLegacyMasterLabels, 3},
+};
+
+const LegacySection kLegacySystemSections[] = {
+        {"RPM Mode:aosd", kLegacySystemLabels, 2},
+        {"RPM Mode:cxsd", kLegacySystemLabels, 2},
+};
+
+size_t LegacyParseStats(const char *const *labels, size_t num_stats, uint64_t *list, FILE *fp) {
+    size_t len = 128;
+    char *line = static_cast<char *>(malloc(len));
+    size_t stats_read = 0;
+
+    while (stats_read < num_stats && getline(&line, &len, fp) > 0) {
+        char *key = line + strspn(line, " \t");
+        char *value = strchr(key, ':');
+        if (!value) continue;
+        *value++ = '\0';
+
+        for (size_t i = 0; i < num_stats; i++) {
+            if (!strncmp(key, labels[i], strlen(labels[i]))) {
+                list[i] = strtoull(value, NULL, 0);
+                stats_read++;
+                break;
+            }
+        }
+    }
+    free(line);
+    return stats_read;
+}
+
+void LegacyExtractStats(uint64_t *list, size_t entries_per_section, FILE *fp,
+                        const LegacySection *sections, size_t num_sections) {
+    size_t len = 128;
+    char *line = static_cast<char *>(malloc(len));
+    size_t sections_read = 0;
+
+    for (size_t i = 0; i < entries_per_section * num_sections; i++) list[i] = 0;
+
+    while (sections_read < num_sections && getline(&line, &len, fp) != -1) {
+        size_t begin = strspn(line, " \t");
+        size_t i;
+        for (i = 0; i < num_sections; i++) {
+            if (!strncmp(line + begin, sections[i].label, strlen(sections[i].label))) {
+                sections_read++;
+                break;
+            }
+        }
+        if (i == num_sections) continue;
+
+        if (LegacyParseStats(sections[i].stats_labels, sections[i].num_stats,
+                             &list[i * entries_per_section], fp) != sections[i].num_stats) {
+            break;
+        }
+    }
+    free(line);
+}
+
+// Parsing only: both parsers run on the sample in memory.
+void BM_LegacyParse(benchmark::State &state, bool master) {
+    uint64_t stats[MAX_MASTER_COUNT * MASTER_STATS_COUNT];
+    const char *sample = master ? kMasterStatsSample : kSystemStatsSample;
+    size_t len = strlen(sample);
+    for (auto _ : state) {
+        FILE *fp = fmemopen(const_cast<char *>(sample), len, "r");
+        if (master) {
+            LegacyExtractStats(stats, MASTER_STATS_COUNT, fp, kLegacyMasterSections,
+                               arraysize(kLegacyMasterSections));
+        } else {
+            LegacyExtractStats(stats, SYSTEM_STATE_STATS_COUNT, fp, kLegacySystemSections,
+                               arraysize(kLegacySystemSections));
+        }
+        fclose(fp);
+        benchmark::DoNotOptimize(stats);
+    }
+}
+BENCHMARK_CAPTURE(BM_LegacyParse, master_stats, true);
+BENCHMARK_CAPTURE(BM_LegacyParse, system_stats, false);
+
+void BM_Parse(benchmark::State &state, bool master) {
+    uint64_t stats[MAX_MASTER_COUNT * MASTER_STATS_COUNT];
+    const char *sample = master ? kMasterStatsSample : kSystemStatsSample;
+    size_t len = strlen(sample);
+    for (auto _ : state) {
+        if (master) {
+            parse_master_stats(sample, len, stats, MAX_MASTER_COUNT * MASTER_STATS_COUNT);
+        } else {
+            parse_system_stats(sample, len, stats,
+                               SYSTEM_SLEEP_STATE_COUNT * SYSTEM_STATE_STATS_COUNT);
+        }
+        benchmark::DoNotOptimize(stats);
+    }
+}
+BENCHMARK_CAPTURE(BM_Parse, master_stats, true);
+BENCHMARK_CAPTURE(BM_Parse, system_stats, false);
+
+// Reading: fopen() and getline() per sample against pread() on a kept fd.
+void BM_LegacyRead(benchmark::State &state) {
+    TemporaryFile tf;
+    android::base::WriteStringToFile(kMasterStatsSample, tf.path);
+    uint64_t stats[MAX_MASTER_COUNT * MASTER_STATS_COUNT];
+    for (auto _ : state) {
+        FILE *fp = fopen(tf.path, "re");
+        LegacyExtractStats(stats, MASTER_STATS_COUNT, fp, kLegacyMasterSections,
+                           arraysize(kLegacyMasterSections));
+        fclose(fp);
+        benchmark::DoNotOptimize(stats);
+    }
+}
+BENCHMARK(BM_LegacyRead);
+
+void BM_Read(benchmark::State &state) {
+    TemporaryFile tf;
+    android::base::WriteStringToFile(kMasterStatsSample, tf.path);
+    int fd = open(tf.path, O_RDONLY | O_CLOEXEC);
+    uint64_t stats[MAX_MASTER_COUNT * MASTER_STATS_COUNT];
+    char buf[4096];
+    for (auto _ : state) {
+        ssize_t len = pread(fd, buf, sizeof(buf), 0);
+        parse_master_stats(buf, len, stats, MAX_MASTER_COUNT * MASTER_STATS_COUNT);
+        benchmark::DoNotOptimize(stats);
+    }
+    close(fd);
+}
+BENCHMARK(BM_Read);
+
+}  // namespace
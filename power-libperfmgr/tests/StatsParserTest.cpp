@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "StatsSamples.h"
+#include "power-helper.h"
+
+namespace {
+
+TEST(StatsParserTest, SystemStats) {
+    uint64_t stats[SYSTEM_SLEEP_STATE_COUNT * SYSTEM_STATE_STATS_COUNT];
+
+    ASSERT_EQ(0, parse_system_stats(kSystemStatsSample, strlen(kSystemStatsSample), stats,
+                                    ARRAY_SIZE(stats)));
+
+    const uint64_t *aosd = &stats[SYSTEM_STATE_AOSD * SYSTEM_STATE_STATS_COUNT];
+    const uint64_t *cxsd = &stats[SYSTEM_STATE_CXSD * SYSTEM_STATE_STATS_COUNT];
+    EXPECT_EQ(4431u, aosd[TOTAL_COUNT]);
+    EXPECT_EQ(5083447u, aosd[ACCUMULATED_TIME_MS]);
+    EXPECT_EQ(3602u, cxsd[TOTAL_COUNT]);
+    EXPECT_EQ(16472836u, cxsd[ACCUMULATED_TIME_MS]);
+}
+
+TEST(StatsParserTest, SystemStatsMissingSection) {
+    // Only aosd present: cxsd reads as zeroes rather than aosd's values.
+    std::string sample(kSystemStatsSample);
+    sample.resize(sample.find("RPM Mode:cxsd"));
+    uint64_t stats[SYSTEM_SLEEP_STATE_COUNT * SYSTEM_STATE_STATS_COUNT];
+
+    ASSERT_EQ(0, parse_system_stats(sample.data(), sample.size(), stats, ARRAY_SIZE(stats)));
+
+    EXPECT_EQ(4431u, stats[SYSTEM_STATE_AOSD * SYSTEM_STATE_STATS_COUNT + TOTAL_COUNT]);
+    EXPECT_EQ(0u, stats[SYSTEM_STATE_CXSD * SYSTEM_STATE_STATS_COUNT + TOTAL_COUNT]);
+    EXPECT_EQ(0u, stats[SYSTEM_STATE_CXSD * SYSTEM_STATE_STATS_COUNT + ACCUMULATED_TIME_MS]);
+}
+
+TEST(StatsParserTest, MasterStats) {
+    uint64_t stats[MAX_MASTER_COUNT * MASTER_STATS_COUNT];
+
+    ASSERT_EQ(0, parse_master_stats(kMasterStatsSample, strlen(kMasterStatsSample), stats,
+                                    ARRAY_SIZE(stats)));
+
+    ASSERT_EQ(7u, get_master_count());
+    EXPECT_STREQ("APSS", get_master_label(0));
+    EXPECT_STREQ("DISPLAY", get_master_label(6));
+
+    const uint64_t *mpss = &stats[1 * MASTER_STATS_COUNT];
+    EXPECT_EQ(0x1b02f7a9a4u, mpss[SLEEP_CUMULATIVE_DURATION_MS]);
+    EXPECT_EQ(0x2c71u, mpss[SLEEP_ENTER_COUNT]);
+    EXPECT_EQ(0x1d2c9ea312u, mpss[SLEEP_LAST_ENTER_TSTAMP_MS]);
+
+    const uint64_t *slpi = &stats[4 * MASTER_STATS_COUNT];
+    EXPECT_EQ(0x1a77c0a88fu, slpi[SLEEP_CUMULATIVE_DURATION_MS]);
+    EXPECT_EQ(0x3f81u, slpi[SLEEP_ENTER_COUNT]);
+}
+
+}  // namespace
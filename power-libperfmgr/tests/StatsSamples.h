@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+// Stats files as the sdm845 kernel prints them (rpmh_master_stat.c and
+// rpm_stats.c). Only "count" is indented in the system sleep stats.
+
+constexpr char kMasterStatsSample[] =
+        "APSS\n"
+        "\tVersion:0x1\n"
+        "\tSleep Count:0x1b3f\n"
+        "\tSleep Last Entered At:0x1d2c8b0e87\n"
+        "\tSleep Last Exited At:0x1d2cb57a71\n"
+        "\tSleep Accumulated Duration:0x16a8d47c1c\n"
+        "\n"
+        "MPSS\n"
+        "\tVersion:0x1\n"
+        "\tSleep Count:0x2c71\n"
+        "\tSleep Last Entered At:0x1d2c9ea312\n"
+        "\tSleep Last Exited At:0x1d2ca01bb8\n"
+        "\tSleep Accumulated Duration:0x1b02f7a9a4\n"
+        "\n"
+        "ADSP\n"
+        "\tVersion:0x1\n"
+        "\tSleep Count:0x9e2\n"
+        "\tSleep Last Entered At:0x1d2b7a6c40\n"
+        "\tSleep Last Exited At:0x1d2b7b1f03\n"
+        "\tSleep Accumulated Duration:0x1c1e52a6e9\n"
+        "\n"
+        "CDSP\n"
+        "\tVersion:0x1\n"
+        "\tSleep Count:0x41\n"
+        "\tSleep Last Entered At:0x1a04b7e8c2\n"
+        "\tSleep Last Exited At:0x1a04b80011\n"
+        "\tSleep Accumulated Duration:0x1ce0a1b3c5\n"
+        "\n"
+        "SLPI\n"
+        "\tVersion:0x1\n"
+        "\tSleep Count:0x3f81\n"
+        "\tSleep Last Entered At:0x1d2cb3f7e2\n"
+        "\tSleep Last Exited At:0x1d2cb4a1c9\n"
+        "\tSleep Accumulated Duration:0x1a77c0a88f\n"
+        "\n"
+        "GPU\n"
+        "\tVersion:0x1\n"
+        "\tSleep Count:0x0\n"
+        "\tSleep Last Entered At:0x0\n"
+        "\tSleep Last Exited At:0x0\n"
+        "\tSleep Accumulated Duration:0x0\n"
+        "\n"
+        "DISPLAY\n"
+        "\tVersion:0x1\n"
+        "\tSleep Count:0x0\n"
+        "\tSleep Last Entered At:0x0\n"
+        "\tSleep Last Exited At:0x0\n"
+        "\tSleep Accumulated Duration:0x0\n"
+        "\n";
+
+constexpr char kSystemStatsSample[] =
+        "RPM Mode:aosd\n"
+        "\t count:4431\n"
+        "time in last mode(msec):120\n"
+        "time since last mode(sec):17\n"
+        "actual last sleep(msec):5083447\n"
+        "\n"
+        "RPM Mode:cxsd\n"
+        "\t count:3602\n"
+        "time in last mode(msec):7411\n"
+        "time since last mode(sec):21\n"
+        "actual last sleep(msec):16472836\n"
+        "\n";
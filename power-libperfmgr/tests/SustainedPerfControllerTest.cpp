@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2026 The LineageOS Project
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
+#include <gtest/gtest.h>
+
+#include "FakeSysfs.h"
+#include "SustainedPerfController.h"
+
+namespace {
+
+using Params = SustainedPerfController::Params;
+using State = SustainedPerfController::State;
+
+constexpr int kLevelCount = 5;
+constexpr int kStaticLevel = 2;
+
+// A first order model of the skin temperature: it moves towards ambient
+// plus kCPerWatt per watt drawn at the current level, with time constant
+// kTauS.
+struct ThermalModel {
+    static constexpr double kAmbientC = 25.0;
+    static constexpr double kCPerWatt = 5.0;
+    static constexpr double kTauS = 60.0;
+    // Equilibrium at 35, 40, 45, 50 and 55 C
+    static constexpr double kWatts[kLevelCount] = {2.0, 3.0, 4.0, 5.0, 6.0};
+
+    double tempC;
+
+    void Step(int level, double dtS, double extraWatts) {
+        double target = kAmbientC + kCPerWatt * (kWatts[level] + extraWatts);
+        tempC += (target - tempC) * dtS / kTauS;
+    }
+};
+
+struct SimulationReport {
+    double overshootC;     // peak above target once the target was reached
+    int levelChanges;      // after the first kSettleS seconds
+    double meanLevel;      // after the first kSettleS seconds
+    int minLevel, maxLevel;
+
+    std::string ToString() const {
+        return android::base::StringPrintf(
+                "overshoot %.2f C, %d level changes, mean level %.2f in [%d, %d]", overshootC,
+                levelChanges, meanLevel, minLevel, maxLevel);
+    }
+};
+
+constexpr int kSettleS = 300;
+
+// Runs Update() once a second for durationS over the model, starting from
+// startC, with extraWatts of load from durationS / 2 on.
+SimulationReport Simulate(const Params &params, double startC, int durationS,
+                          double extraWatts = 0.0) {
+    ThermalModel model{startC};
+    State state{0, kStaticLevel};
+    SimulationReport report{0, 0, 0, kLevelCount, -1};
+    double targetC = params.targetMilliC / 1000.0;
+    bool reached = false;
+    int level = kStaticLevel;
+    double levelSum = 0;
+
+    for (int t = 0; t < durationS; t++) {
+        model.Step(level, 1.0, t >= durationS / 2 ? extraWatts : 0.0);
+        int next = SustainedPerfController::Update(params, kStaticLevel, kLevelCount, &state,
+                                                   static_cast<int>(model.tempC * 1000), 1000);
+        reached |= model.tempC >= targetC;
+        if (reached) report.overshootC = std::max(report.overshootC, model.tempC - targetC);
+        if (t >= kSettleS) {
+            report.levelChanges += next != level;
+            levelSum += next;
+            report.minLevel = std::min(report.minLevel, next);
+            report.maxLevel = std::max(report.maxLevel, next);
+        }
+        level = next;
+    }
+    report.meanLevel = levelSum / (durationS - kSettleS);
+    return report;
+}
+
+TEST(SustainedPerfControllerTest, SettlesBelowTarget) {
+    // The static level runs at 45 C; a 47 C target has room for more.
+    Params params = SustainedPerfController::DefaultParams();
+    params.targetMilliC = 47000;
+    SimulationReport report = Simulate(params, 30.0, 1800);
+    RecordProperty("report", report.ToString());
+
+    // Each level moves the equilibrium by 5 C, so some overshoot is inherent
+    EXPECT_LT(report.overshootC, 2.0) << report.ToString();
+    EXPECT_GE(report.minLevel, kStaticLevel) << report.ToString();
+    EXPECT_LE(report.maxLevel, kStaticLevel + 1) << report.ToString();
+    EXPECT_GT(report.meanLevel, kStaticLevel) << report.ToString();
+    // Dithering between the two levels around the target, but slowly
+    EXPECT_LE(report.levelChanges, 40) << report.ToString();
+}
+
+TEST(SustainedPerfControllerTest, UsesHeadroom) {
+    // Every level is cool enough: the top one is held without changes.
+    Params params = SustainedPerfController::DefaultParams();
+    params.targetMilliC = 60000;
+    SimulationReport report = Simulate(params, 30.0, 900);
+    RecordProperty("report", report.ToString());
+
+    EXPECT_EQ(kLevelCount - 1, report.minLevel) << report.ToString();
+    EXPECT_EQ(0, report.levelChanges) << report.ToString();
+}
+
+TEST(SustainedPerfControllerTest, BacksOffUnderLoad) {
+    // Two extra watts half way: the level has to come down to hold 45 C.
+    Params params = SustainedPerfController::DefaultParams();
+    SimulationReport report = Simulate(params, 40.0, 2400, 2.0);
+    RecordProperty("report", report.ToString());
+
+    EXPECT_LT(report.overshootC, 3.0) << report.ToString();
+    EXPECT_LE(report.minLevel, 0) << report.ToString();
+    EXPECT_LE(report.levelChanges, 60) << report.ToString();
+}
+
+// The controller thread against a fake thermal zone and cpufreq tree
+class SustainedPerfControllerSysfsTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        if (!android::base::SetProperty("vendor.powerhal.sustained.adaptive", "true") ||
+            !android::base::SetProperty("vendor.powerhal.sustained.zone", "xo-therm-adc") ||
+            !android::base::SetProperty("vendor.powerhal.sustained.target_mc", "45000")) {
+            GTEST_SKIP() << "cannot set the controller properties";
+        }
+        mSysfs.WriteFile("class/thermal/thermal_zone0/type", "cpu0-gold-usr");
+        mSysfs.WriteFile("class/thermal/thermal_zone0/temp", "50000");
+        mSysfs.WriteFile("class/thermal/thermal_zone1/type", "xo-therm-adc");
+        SetTemp(45000);
+
+        mSysfs.AddNode("devices/system/cpu/cpu4/cpufreq/scaling_max_freq",
+                       {"1286400", "1363200", "1459200", "1996800", "2803200", "2956800"});
+        for (int i = 0; i < kLevelCount; i++) {
+            mLevels.push_back("SUSTAINED_PERFORMANCE_LEVEL_" + std::to_string(i));
+            mSysfs.AddAction(mLevels.back(), "devices/system/cpu/cpu4/cpufreq/scaling_max_freq",
+                             i);
+        }
+        mController = std::make_unique<SustainedPerfController>(
+                mSysfs.Start(), mLevels, kStaticLevel, mSysfs.Path(""));
+        ASSERT_TRUE(mController->Init());
+    }
+
+    void TearDown() override {
+        mController.reset();
+        android::base::SetProperty("vendor.powerhal.sustained.adaptive", "");
+    }
+
+    void SetTemp(int milliC) {
+        mSysfs.WriteFile("class/thermal/thermal_zone1/temp", std::to_string(milliC));
+    }
+
+    bool WaitForMaxFreq(const std::string &freq) {
+        return mSysfs.WaitFor("devices/system/cpu/cpu4/cpufreq/scaling_max_freq", freq,
+                              std::chrono::seconds(5));
+    }
+
+    FakeSysfs mSysfs;
+    std::vector<std::string> mLevels;
+    std::unique_ptr<SustainedPerfController> mController;
+};
+
+TEST_F(SustainedPerfControllerSysfsTest, FollowsZone) {
+    mController->Start();
+    EXPECT_TRUE(WaitForMaxFreq("1459200"));
+
+    // Far too hot: straight to the lowest caps
+    SetTemp(60000);
+    EXPECT_TRUE(WaitForMaxFreq("1286400"));
+
+    // Far too cool: up to the highest ones
+    SetTemp(30000);
+    EXPECT_TRUE(WaitForMaxFreq("2803200"));
+
+    mController->Stop();
+    EXPECT_TRUE(WaitForMaxFreq("2956800"));
+}
+
+TEST_F(SustainedPerfControllerSysfsTest, StaticLevelWhenZoneUnreadable) {
+    mController->Start();
+    SetTemp(30000);
+    EXPECT_TRUE(WaitForMaxFreq("2803200"));
+
+    // An empty read falls back to the static caps
+    mSysfs.WriteFile("class/thermal/thermal_zone1/temp", "");
+    EXPECT_TRUE(WaitForMaxFreq("1459200"));
+}
+
+}  // namespace
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2026 The LineageOS Project
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Compile powerhint.json into the table loaded by PowerHintTable.
+
+The layout is described in PowerHintTable.h; keep both in sync. The same
+checks libperfmgr runs on the JSON are done here so that a table which
+compiles is one the JSON path would also have accepted.
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = 0x42544850  # "PHTB"
+VERSION = 1
+
+NODE_FILE = 0
+NODE_PROPERTY = 1
+
+HEADER_FMT = '<16I'
+NODE_FMT = '<8I'
+ACTION_FMT = '<4I'
+PRIORITY_FMT = '<IiIII'
+
+
+def fnv1a(data):
+    h = 0x811c9dc5
+    for b in data:
+        h ^= b
+        h = (h * 0x01000193) & 0xffffffff
+    return h
+
+
+class Strings:
+    def __init__(self):
+        self.blob = bytearray()
+        self.offsets = {}
+
+    def add(self, s):
+        if s not in self.offsets:
+            self.offsets[s] = len(self.blob)
+            self.blob += s.encode('utf-8') + b'\0'
+        return self.offsets[s]
+
+
+def fail(msg):
+    sys.exit('powerhint_compiler: ' + msg)
+
+
+def compile_config(json_doc):
+    root = json.loads(json_doc)
+    strings = Strings()
+    nodes = []
+    values = []
+    node_index = {}
+    paths = set()
+
+    for i, n in enumerate(root.get('Nodes', [])):
+        name = n.get('Name', '')
+        path = n.get('Path', '')
+        if not name or name in node_index:
+            fail('Node[%d] has an empty or duplicate Name' % i)
+        if not path or path in paths:
+            fail('Node[%d] has an empty or duplicate Path' % i)
+        vals = n.get('Values', [])
+        if not vals or len(set(vals)) != len(vals):
+            fail('Node[%d] has empty or duplicate Values' % i)
+        default_index = n.get('DefaultIndex', len(vals) - 1)
+        if not 0 <= default_index < len(vals):
+            fail('Node[%d] DefaultIndex out of range' % i)
+        node_type = n.get('Type', 'File')
+        if node_type not in ('File', 'Property'):
+            fail('Node[%d] has unknown Type %s' % (i, node_type))
+
+        node_index[name] = (len(nodes), vals)
+        paths.add(path)
+        nodes.append(struct.pack(NODE_FMT,
+                                 strings.add(name),
+                                 strings.add(path),
+                                 NODE_PROPERTY if node_type == 'Property' else NODE_FILE,
+                                 default_index,
+                                 int(bool(n.get('ResetOnInit', False))),
+                                 int(bool(n.get('HoldFd', False))),
+                                 len(values),
+                                 len(vals)))
+        values += [struct.pack('<I', strings.add(v)) for v in vals]
+
+    # Group actions by hint, keeping the order hints first appear in.
+    by_hint = {}
+    for i, a in enumerate(root.get('Actions', [])):
+        hint = a.get('PowerHint', '')
+        node = a.get('Node', '')
+        if not hint:
+            fail('Action[%d] has no PowerHint' % i)
+        if node not in node_index:
+            fail('Action[%d] refers to unknown Node %s' % (i, node))
+        index, vals = node_index[node]
+        if a.get('Value') not in vals:
+            fail('Action[%d] Value %s is not a value of %s' % (i, a.get('Value'), node))
+        duration = a.get('Duration', 0)
+        if duration < 0:
+            fail('Action[%d] has a negative Duration' % i)
+        by_hint.setdefault(hint, []).append(struct.pack(
+            ACTION_FMT, strings.add(hint), index, vals.index(a['Value']), duration))
+    actions = [a for group in by_hint.values() for a in group]
+
+    priorities = []
+    components = []
+    for i, p in enumerate(root.get('Priorities', [])):
+        name = p.get('PowerHint', '')
+        if not name:
+            fail('Priority[%d] has no PowerHint' % i)
+        comps = p.get('Components', [])
+        priorities.append(struct.pack(PRIORITY_FMT,
+                                      strings.add(name),
+                                      p.get('Priority', 0),
+                                      int(bool(p.get('Exclusive', False))),
+                                      len(components),
+                                      len(comps)))
+        components += [struct.pack('<I', strings.add(c)) for c in comps]
+
+    sections = [bytes(strings.blob), b''.join(nodes), b''.join(values),
+                b''.join(actions), b''.join(priorities), b''.join(components)]
+    counts = [len(strings.blob), len(nodes), len(values),
+              len(actions), len(priorities), len(components)]
+
+    offset = struct.calcsize(HEADER_FMT)
+    layout = []
+    body = bytearray()
+    for data, count in zip(sections, counts):
+        # Keep every record table 4-byte aligned for in-place access.
+        pad = -(offset + len(body)) % 4
+        body += b'\0' * pad
+        layout += [offset + len(body), count]
+        body += data
+
+    header = struct.pack(HEADER_FMT, MAGIC, VERSION, len(json_doc), fnv1a(json_doc), *layout)
+    return header + bytes(body)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.exit('usage: powerhint_compiler <powerhint.json> <powerhint.bin>')
+    with open(argv[1], 'rb') as f:
+        json_doc = f.read()
+    table = compile_config(json_doc)
+    with open(argv[2], 'wb') as f:
+        f.write(table)
+
+
+if __name__ == '__main__':
+    main(sys.argv)
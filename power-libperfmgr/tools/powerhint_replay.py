@@ -0,0 +1,595 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2026 The LineageOS Project
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Replay a hint trace recorded by the power HAL against powerhint.json.
+
+Record a trace on the device with
+
+    adb shell setprop vendor.powerhal.trace.record true
+    adb shell stop vendor.power-hal-1-3; adb shell start vendor.power-hal-1-3
+    ... use the device ...
+    adb pull /data/vendor/powerhal/hints.trace
+
+and replay it on the host, once per config to compare them:
+
+    powerhint_replay hints.trace --config a.json --config b.json --csv out.csv
+
+The replay runs in simulated time. It follows the HAL's dispatch in
+Power.cpp, the HintArbiter priorities, the InteractionHandler boost and
+idle timing and libperfmgr's lowest-index-wins node semantics. Node
+values are written to a fake sysfs tree, and the display idle_state node
+there is driven from the trace. The recorded idle events only say when
+the display went idle; it counts as busy again from the next INTERACTION
+or LAUNCH.
+
+Not modeled: adaptive boost lengths (the static ones are used), the
+thermal loop of sustained performance (it stays at the static level) and
+hint sessions, whose work reports are not recorded.
+
+powerhint_replay_test checks the constants, default priorities and hint
+names here against the HAL sources; update both sides together.
+
+The energy estimate is the cost of the frequency floors the policy
+holds, from a per-node power model. It is meant for comparing
+policies on the same trace, not as an absolute figure.
+"""
+
+import argparse
+import csv
+import heapq
+import json
+import os
+import shutil
+import struct
+import sys
+import tempfile
+
+TRACE_MAGIC = 0x52544850  # "PHTR"
+TRACE_VERSION = 1
+DISPLAY_IDLE = 0x80000000
+PERF_LOCK = 0x80001000
+ENTRY_FMT = '<IIq'
+
+NS_PER_MS = 1000000
+
+# IPower 1.3 PowerHint values
+VSYNC = 1
+INTERACTION = 2
+SUSTAINED_PERFORMANCE = 6
+VR_MODE = 7
+LAUNCH = 8
+AUDIO_STREAMING = 9
+AUDIO_LOW_LATENCY = 10
+CAMERA_LAUNCH = 11
+CAMERA_STREAMING = 12
+CAMERA_SHOT = 13
+EXPENSIVE_RENDERING = 14
+
+HINT_NAMES = {
+    1: 'VSYNC', 2: 'INTERACTION', 3: 'VIDEO_ENCODE', 4: 'VIDEO_DECODE',
+    5: 'LOW_POWER', 6: 'SUSTAINED_PERFORMANCE', 7: 'VR_MODE', 8: 'LAUNCH',
+    9: 'AUDIO_STREAMING', 10: 'AUDIO_LOW_LATENCY', 11: 'CAMERA_LAUNCH',
+    12: 'CAMERA_STREAMING', 13: 'CAMERA_SHOT', 14: 'EXPENSIVE_RENDERING',
+}
+
+# Keep in sync with libqti-perfd-client/include/PerfLockHints.h.
+PERF_LOCK_LEVEL_COUNT = 3
+PERF_LOCK_RESOURCES = ['CPU_BIG_MIN', 'CPU_LITTLE_MIN', 'SCHED_BOOST', 'CPUBW_MIN', 'GPU_MIN']
+
+# Keep in sync with Power.h and InteractionHandler.cpp.
+CAMERA_LAUNCH_BOOST_MS = 2500
+LAUNCH_BOOST_MS_DEFAULT = 5000
+SUSTAINED_STATIC_LEVEL = 1
+INTERACTION_WAIT_MS = 100
+INTERACTION_MIN_MS = 1400
+INTERACTION_MAX_MS = 5650
+INTERACTION_INPUT_MARGIN_MS = 650
+
+# Keep in sync with HintArbiter::DefaultPriorities(), used when the config
+# has no Priorities table.
+DEFAULT_PRIORITIES = [
+    {'PowerHint': 'VR_SUSTAINED_PERFORMANCE', 'Priority': 3, 'Exclusive': True,
+     'Components': ['VR_MODE', 'SUSTAINED_PERFORMANCE']},
+    {'PowerHint': 'SUSTAINED_PERFORMANCE', 'Priority': 2, 'Exclusive': True},
+    {'PowerHint': 'VR_MODE', 'Priority': 2, 'Exclusive': True},
+    {'PowerHint': 'EXPENSIVE_RENDERING', 'Priority': 1},
+    {'PowerHint': 'AUDIO_STREAMING', 'Priority': 1},
+    {'PowerHint': 'LAUNCH', 'Priority': 1},
+    {'PowerHint': 'INTERACTION', 'Priority': 1},
+]
+
+# Default power model: mW = coefficient * (value * scale) ** exponent, with
+# values above max clamped to it. Rough figures for SDM845 at full load.
+DEFAULT_POWER_MODEL = {
+    'CPUBigClusterMinFreq': {'scale': 1e-6, 'max': 2803200, 'coefficient': 90.0, 'exponent': 3},
+    'CPULittleClusterMinFreq': {'scale': 1e-6, 'max': 1766400, 'coefficient': 70.0, 'exponent': 3},
+    'GPUMinFreq': {'scale': 1e-9, 'max': 710000000, 'coefficient': 5500.0, 'exponent': 3},
+    'CPUBWMinFreq': {'scale': 1e-3, 'max': 14236, 'coefficient': 12.0, 'exponent': 1},
+    'GPUBusMinFreq': {'scale': 1e-3, 'max': 6881, 'coefficient': 12.0, 'exponent': 1},
+    'LLCCBWMinFreq': {'scale': 1e-3, 'max': 6881, 'coefficient': 8.0, 'exponent': 1},
+    'L3BigClusterMinFreq': {'scale': 1e-9, 'max': 1478400000, 'coefficient': 60.0, 'exponent': 2},
+    'L3LittleClusterMinFreq': {'scale': 1e-9, 'max': 1478400000, 'coefficient': 30.0, 'exponent': 2},
+}
+
+
+def fail(msg):
+    sys.exit('powerhint_replay: ' + msg)
+
+
+def read_trace(path):
+    """Return the sessions of a trace, each a list of (ns, hint, data)."""
+    with open(path, 'rb') as f:
+        blob = f.read()
+    size = struct.calcsize(ENTRY_FMT)
+    if len(blob) % size:
+        print('powerhint_replay: ignoring %d trailing bytes' % (len(blob) % size),
+              file=sys.stderr)
+    sessions = []
+    for off in range(0, len(blob) - len(blob) % size, size):
+        first, second, ts = struct.unpack_from(ENTRY_FMT, blob, off)
+        if first == TRACE_MAGIC:
+            if second != TRACE_VERSION:
+                fail('unsupported trace version %d' % second)
+            sessions.append([])
+        elif not sessions:
+            fail('trace does not start with a session')
+        else:
+            data = second - (1 << 32) if second & 0x80000000 else second
+            sessions[-1].append((ts, first, data))
+    return sessions
+
+
+class Node:
+    def __init__(self, name, path, values, default_index, is_property):
+        self.name = name
+        self.path = path
+        self.values = values
+        self.default_index = default_index
+        self.is_property = is_property
+        # hint -> (value index, expire ns or None)
+        self.requests = {}
+        self.value = None
+
+    def current(self, now):
+        active = [i for i, end in self.requests.values() if end is None or end > now]
+        return self.values[min(active)] if active else self.values[self.default_index]
+
+
+class HintManager:
+    """libperfmgr: every node takes the lowest value index requested."""
+
+    def __init__(self, config, sim):
+        self.sim = sim
+        self.nodes = {}
+        for n in config.get('Nodes', []):
+            vals = n['Values']
+            self.nodes[n['Name']] = Node(n['Name'], n['Path'], vals,
+                                         n.get('DefaultIndex', len(vals) - 1),
+                                         n.get('Type', 'File') == 'Property')
+        self.actions = {}
+        for a in config.get('Actions', []):
+            node = self.nodes[a['Node']]
+            self.actions.setdefault(a['PowerHint'], []).append(
+                (node, node.values.index(a['Value']), a.get('Duration', 0)))
+        for node in self.nodes.values():
+            self.sim.write_node(node)
+
+    def do_hint(self, hint, timeout_ms=0):
+        if hint not in self.actions:
+            return False
+        now = self.sim.now
+        for node, index, duration in self.actions[hint]:
+            ms = timeout_ms or duration
+            end = now + ms * NS_PER_MS if ms > 0 else None
+            node.requests[hint] = (index, end)
+            if end is not None:
+                self.sim.schedule(end, 'expire', node)
+            self.sim.write_node(node)
+        return True
+
+    def end_hint(self, hint):
+        if hint not in self.actions:
+            return False
+        for node, _, _ in self.actions[hint]:
+            node.requests.pop(hint, None)
+            self.sim.write_node(node)
+        return True
+
+    def max_duration(self, hint):
+        return max((d for _, _, d in self.actions.get(hint, [])), default=0)
+
+
+def resolve(priorities, requested):
+    """Port of HintArbiter::Resolve, returns (applied, floor)."""
+    by_name = {p['PowerHint']: p for p in priorities}
+    applied = set()
+    consumed = set()
+    composites = [p for p in priorities if p.get('Components')]
+    composites.sort(key=lambda p: -p.get('Priority', 0))
+    for p in composites:
+        comps = p['Components']
+        if all(c in requested and c not in consumed for c in comps):
+            applied.add(p['PowerHint'])
+            consumed.update(comps)
+
+    candidates = [h for h in requested if h not in consumed]
+    floor = None
+    for hint in list(applied) + candidates:
+        p = by_name.get(hint)
+        if p and p.get('Exclusive', False):
+            prio = p.get('Priority', 0)
+            floor = prio if floor is None else max(floor, prio)
+    for hint in candidates:
+        p = by_name.get(hint)
+        if not p or floor is None or p.get('Priority', 0) >= floor:
+            applied.add(hint)
+    return applied, floor
+
+
+class HintArbiter:
+    def __init__(self, priorities, hint_manager, listener):
+        self.priorities = priorities
+        self.by_name = {p['PowerHint']: p for p in priorities}
+        self.hm = hint_manager
+        self.listener = listener
+        self.requested = set()
+        self.timeouts = {}
+        self.applied = set()
+        self.floor = None
+
+    def apply(self):
+        applied, self.floor = resolve(self.priorities, self.requested)
+        for hint in sorted(applied - self.applied):
+            self.hm.do_hint(hint, self.timeouts.get(hint, 0))
+            self.listener(hint, True)
+        for hint in sorted(self.applied - applied):
+            self.hm.end_hint(hint)
+            self.listener(hint, False)
+        self.applied = applied
+
+    def request(self, hint, timeout_ms=0):
+        if hint in self.requested:
+            return
+        self.requested.add(hint)
+        if timeout_ms > 0:
+            self.timeouts[hint] = timeout_ms
+        self.apply()
+
+    def cancel(self, hint):
+        if hint not in self.requested:
+            return
+        self.requested.discard(hint)
+        self.timeouts.pop(hint, None)
+        self.apply()
+
+    def is_suppressed(self, hint):
+        p = self.by_name.get(hint)
+        return p is not None and self.floor is not None and p.get('Priority', 0) < self.floor
+
+
+class InteractionHandler:
+    """The boost timing of InteractionHandler with adaptive sizing off."""
+
+    def __init__(self, sim, hint_manager):
+        self.sim = sim
+        self.hm = hint_manager
+        self.active = False
+        self.start = 0
+        self.duration_ms = 0
+        self.idle_check = 0
+        self.deadline = 0
+
+    def acquire(self, duration):
+        final = min(max(duration + INTERACTION_INPUT_MARGIN_MS, INTERACTION_MIN_MS),
+                    INTERACTION_MAX_MS)
+        now = self.sim.now
+        if self.active and now + final * NS_PER_MS <= self.start + self.duration_ms * NS_PER_MS:
+            return
+        self.start = now
+        self.duration_ms = final
+        self.idle_check = now + INTERACTION_WAIT_MS * NS_PER_MS
+        self.deadline = self.idle_check + final * NS_PER_MS
+        if not self.active:
+            self.hm.do_hint('INTERACTION')
+            self.active = True
+        self.sim.arm_timer(self.idle_check)
+
+    def release(self):
+        self.active = False
+        self.hm.end_hint('INTERACTION')
+
+    def on_timer(self):
+        if not self.active:
+            return
+        now = self.sim.now
+        if now >= self.deadline:
+            self.release()
+        elif now < self.idle_check:
+            self.sim.arm_timer(self.idle_check)
+        elif self.sim.display_idle():
+            self.release()
+        else:
+            self.sim.arm_timer(self.deadline)
+
+    def on_idle(self):
+        if self.active and self.sim.now >= self.idle_check:
+            self.release()
+
+
+class Simulation:
+    def __init__(self, config, sysfs_root, power_model):
+        self.config = config
+        self.root = sysfs_root
+        self.power_model = power_model
+        self.events = []
+        self.seq = 0
+        self.now = 0
+        self.timer_gen = 0
+        # node name -> list of (ns, value)
+        self.timeline = {}
+        self.idle_path = os.path.join(sysfs_root, 'sys/class/drm/card0/device/idle_state')
+        os.makedirs(os.path.dirname(self.idle_path), exist_ok=True)
+        self.set_display('idle')
+        self.reset()
+
+    def reset(self):
+        self.events = []
+        self.timer_gen += 1
+        self.hm = HintManager(self.config, self)
+        priorities = self.config.get('Priorities') or DEFAULT_PRIORITIES
+        self.arbiter = HintArbiter(priorities, self.hm, self.on_arbiter)
+        self.interaction = InteractionHandler(self, self.hm)
+        self.perf_lock_levels = [0] * len(PERF_LOCK_RESOURCES)
+        launch_max = self.hm.max_duration('LAUNCH')
+        self.launch_ms = launch_max if launch_max > 0 else LAUNCH_BOOST_MS_DEFAULT
+
+    def schedule(self, when, kind, payload=None):
+        self.seq += 1
+        heapq.heappush(self.events, (when, self.seq, kind, payload))
+
+    def arm_timer(self, when):
+        # Like the timerfd, arming again replaces the previous deadline.
+        self.timer_gen += 1
+        self.schedule(when, 'timer', self.timer_gen)
+
+    def node_file(self, node):
+        if node.is_property:
+            return os.path.join(self.root, 'properties', node.path)
+        return os.path.join(self.root, node.path.lstrip('/'))
+
+    def write_node(self, node):
+        value = node.current(self.now)
+        if value == node.value:
+            return
+        node.value = value
+        path = self.node_file(node)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, 'w') as f:
+            f.write(value)
+        changes = self.timeline.setdefault(node.name, [])
+        while changes and changes[-1][0] == self.now:
+            changes.pop()
+        if not changes or changes[-1][1] != value:
+            changes.append((self.now, value))
+
+    def set_display(self, state):
+        with open(self.idle_path, 'w') as f:
+            f.write(state)
+
+    def display_idle(self):
+        with open(self.idle_path) as f:
+            return f.read().startswith('idle')
+
+    def on_arbiter(self, hint, applied):
+        # SustainedPerfController with the thermal loop off
+        if hint == 'SUSTAINED_PERFORMANCE':
+            level = 'SUSTAINED_PERFORMANCE_LEVEL_%d' % SUSTAINED_STATIC_LEVEL
+            if applied:
+                self.hm.do_hint(level)
+            else:
+                self.hm.end_hint(level)
+
+    def camera_launch_boost(self):
+        return min(self.launch_ms, CAMERA_LAUNCH_BOOST_MS)
+
+    def on_perf_lock(self, resource, level):
+        level = max(0, min(level, PERF_LOCK_LEVEL_COUNT))
+        old = self.perf_lock_levels[resource]
+        if level == old:
+            return
+        name = PERF_LOCK_RESOURCES[resource]
+        if level:
+            self.hm.do_hint('PERF_LOCK_%s_%d' % (name, level))
+        if old:
+            self.hm.end_hint('PERF_LOCK_%s_%d' % (name, old))
+        self.perf_lock_levels[resource] = level
+
+    def on_hint(self, hint, data):
+        """Power::handleHint_1_3 and the handlers it falls through to."""
+        arbiter = self.arbiter
+        name = HINT_NAMES.get(hint)
+        if 0 <= hint - PERF_LOCK < len(PERF_LOCK_RESOURCES):
+            self.on_perf_lock(hint - PERF_LOCK, data)
+        elif hint == INTERACTION:
+            self.set_display('busy')
+            if not arbiter.is_suppressed('INTERACTION'):
+                self.interaction.acquire(data)
+        elif hint in (SUSTAINED_PERFORMANCE, VR_MODE, AUDIO_STREAMING, AUDIO_LOW_LATENCY):
+            if data:
+                arbiter.request(name)
+            else:
+                arbiter.cancel(name)
+        elif hint == LAUNCH:
+            if data:
+                self.set_display('busy')
+                arbiter.request('LAUNCH', self.launch_ms)
+            else:
+                arbiter.cancel('LAUNCH')
+        elif hint == CAMERA_LAUNCH:
+            if data > 0:
+                self.hm.do_hint('CAMERA_LAUNCH', data)
+                self.hm.do_hint('LAUNCH', self.camera_launch_boost())
+            elif data == 0:
+                self.hm.end_hint('CAMERA_LAUNCH')
+        elif hint == CAMERA_STREAMING:
+            if data > 0:
+                arbiter.request(name)
+            elif data == 0:
+                arbiter.cancel(name)
+        elif hint == CAMERA_SHOT:
+            if data > 0:
+                self.hm.do_hint('CAMERA_SHOT', data)
+            elif data == 0:
+                self.hm.end_hint('CAMERA_SHOT')
+        elif hint == EXPENSIVE_RENDERING:
+            if data > 0:
+                arbiter.request(name)
+            else:
+                arbiter.cancel(name)
+
+    def run_until(self, end):
+        while self.events and self.events[0][0] <= end:
+            when, _, kind, payload = heapq.heappop(self.events)
+            self.now = when
+            if kind == 'hint':
+                self.on_hint(*payload)
+            elif kind == 'idle':
+                self.set_display('idle')
+                self.interaction.on_idle()
+            elif kind == 'timer':
+                if payload == self.timer_gen:
+                    self.interaction.on_timer()
+            elif kind == 'expire':
+                self.write_node(payload)
+        self.now = max(self.now, end)
+
+    def run(self, sessions, tail_ms):
+        offset = 0
+        for i, session in enumerate(sessions):
+            if not session:
+                continue
+            base = session[0][0]
+            if i:
+                # The HAL restarted; so does the policy.
+                self.reset()
+            for ts, hint, data in session:
+                when = offset + ts - base
+                if hint == DISPLAY_IDLE:
+                    self.schedule(when, 'idle')
+                else:
+                    self.schedule(when, 'hint', (hint, data))
+            end = offset + session[-1][0] - base + tail_ms * NS_PER_MS
+            self.run_until(end)
+            offset = end
+        for node in self.hm.nodes.values():
+            self.write_node(node)
+        return offset
+
+    def summarize(self, end):
+        """Per node: ms away from default, time weighted mean and energy."""
+        summary = {}
+        for node in self.hm.nodes.values():
+            changes = self.timeline.get(node.name, [])
+            default = node.values[node.default_index]
+            model = self.power_model.get(node.name)
+            boosted_ns = 0
+            weighted = 0.0
+            numeric = True
+            energy_mj = 0.0
+            for (t, value), (t_next, _) in zip(changes, changes[1:] + [(end, None)]):
+                span = max(0, t_next - t)
+                if value != default:
+                    boosted_ns += span
+                try:
+                    v = float(value)
+                except ValueError:
+                    numeric = False
+                    continue
+                weighted += v * span
+                if model:
+                    v = min(v, model.get('max', v))
+                    mw = model['coefficient'] * (v * model.get('scale', 1.0)) ** model.get(
+                        'exponent', 1)
+                    energy_mj += mw * span / 1e9
+            summary[node.name] = {
+                'boosted_ms': boosted_ns / NS_PER_MS,
+                'mean': weighted / end if numeric and end else None,
+                'energy_mj': energy_mj if model else None,
+            }
+        return summary
+
+
+def write_csv(path, results):
+    with open(path, 'w', newline='') as f:
+        out = csv.writer(f)
+        out.writerow(['config', 'time_ms', 'node', 'value'])
+        for config, sim, _, _ in results:
+            for name, changes in sorted(sim.timeline.items()):
+                for t, value in changes:
+                    out.writerow([config, '%.3f' % (t / NS_PER_MS), name, value])
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(prog='powerhint_replay', description=__doc__.split('\n')[0])
+    parser.add_argument('trace', help='trace pulled from /data/vendor/powerhal/hints.trace')
+    parser.add_argument('--config', action='append', required=True,
+                        help='powerhint.json to replay against; repeat to compare')
+    parser.add_argument('--csv', help='write every node value change to this file')
+    parser.add_argument('--power-model', help='JSON object of per-node models, '
+                        'replacing the built-in one')
+    parser.add_argument('--sysfs-root', help='build the fake sysfs trees here and keep '
+                        'them, one directory per config')
+    parser.add_argument('--tail-ms', type=int, default=LAUNCH_BOOST_MS_DEFAULT,
+                        help='keep simulating this long after the last hint of a session')
+    args = parser.parse_args(argv[1:])
+
+    sessions = read_trace(args.trace)
+    if not any(sessions):
+        fail('no hints in %s' % args.trace)
+    power_model = DEFAULT_POWER_MODEL
+    if args.power_model:
+        with open(args.power_model) as f:
+            power_model = json.load(f)
+
+    root = args.sysfs_root or tempfile.mkdtemp(prefix='powerhint_replay.')
+    results = []
+    try:
+        for i, path in enumerate(args.config):
+            with open(path) as f:
+                config = json.load(f)
+            sim = Simulation(config, os.path.join(root, str(i)), power_model)
+            end = sim.run(sessions, args.tail_ms)
+            results.append((path, sim, end, sim.summarize(end)))
+    finally:
+        if not args.sysfs_root:
+            shutil.rmtree(root)
+
+    for path, sim, end, summary in results:
+        total = sum(s['energy_mj'] or 0 for s in summary.values())
+        print('%s: %.1f s replayed, %.1f mJ estimated' % (path, end / 1e9, total))
+        for name, s in sorted(summary.items()):
+            if not s['boosted_ms']:
+                continue
+            line = '  %-26s %10.1f ms boosted' % (name, s['boosted_ms'])
+            if s['mean'] is not None:
+                line += ', mean %.0f' % s['mean']
+            if s['energy_mj'] is not None:
+                line += ', %.1f mJ' % s['energy_mj']
+            print(line)
+    if len(results) > 1:
+        base = sum(s['energy_mj'] or 0 for s in results[0][3].values())
+        for path, _, _, summary in results[1:]:
+            total = sum(s['energy_mj'] or 0 for s in summary.values())
+            print('%s vs %s: %+.1f mJ (%+.1f%%)' % (path, results[0][0], total - base,
+                                                    100.0 * (total - base) / base if base
+                                                    else 0.0))
+
+    if args.csv:
+        write_csv(args.csv, results)
+
+
+if __name__ == '__main__':
+    main(sys.argv)
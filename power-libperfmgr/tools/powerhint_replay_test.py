@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2026 The LineageOS Project
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Check that powerhint_replay still models the C++ it was ported from.
+
+The constants, default priorities and hint names of the model are compared
+with the HAL sources, so a change on one side fails here until the other
+side follows. The sources are read from the tree when run from it, and
+from the test's data files when run from the test suite.
+"""
+
+import inspect
+import os
+import re
+import sys
+import unittest
+
+import powerhint_replay as model
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SEARCH_DIRS = [
+    os.path.dirname(os.path.abspath(sys.argv[0])),
+    os.path.join(HERE, '..'),
+    os.path.join(HERE, '..', '..', 'libqti-perfd-client'),
+]
+
+
+def read_source(path):
+    for d in SEARCH_DIRS:
+        full = os.path.join(d, path)
+        if os.path.exists(full):
+            with open(full) as f:
+                return f.read()
+    raise FileNotFoundError(path)
+
+
+def constant(source, name):
+    m = re.search(r'\b%s\s*=\s*(0x[0-9a-fA-F]+|\d+)' % name, source)
+    if not m:
+        raise AssertionError('%s not found' % name)
+    return int(m.group(1), 0)
+
+
+def initializer(source, member):
+    m = re.search(r'\b%s\((\d+)\)' % member, source)
+    if not m:
+        raise AssertionError('%s not found' % member)
+    return int(m.group(1))
+
+
+class ModelSyncTest(unittest.TestCase):
+    def test_default_priorities(self):
+        source = read_source('HintArbiter.cpp')
+        body = re.search(r'HintArbiter::DefaultPriorities\(\) \{(.*?)\n\}', source, re.S)
+        self.assertIsNotNone(body)
+        expected = []
+        for name, prio, exclusive, comps in re.findall(
+                r'\{"(\w+)", (-?\d+), (true|false), \{([^}]*)\}\}', body.group(1)):
+            expected.append((name, int(prio), exclusive == 'true',
+                             re.findall(r'"(\w+)"', comps)))
+        self.assertTrue(expected)
+        actual = [(p['PowerHint'], p.get('Priority', 0), p.get('Exclusive', False),
+                   p.get('Components', [])) for p in model.DEFAULT_PRIORITIES]
+        self.assertEqual(expected, actual)
+
+    def test_power_constants(self):
+        source = read_source('Power.h')
+        self.assertEqual(constant(source, 'kCameraLaunchBoostMs'),
+                         model.CAMERA_LAUNCH_BOOST_MS)
+        self.assertEqual(constant(source, 'kLaunchBoostMsDefault'),
+                         model.LAUNCH_BOOST_MS_DEFAULT)
+        self.assertEqual(constant(source, 'kSustainedStaticLevel'),
+                         model.SUSTAINED_STATIC_LEVEL)
+
+    def test_interaction_timing(self):
+        source = read_source('InteractionHandler.cpp')
+        self.assertEqual(initializer(source, 'mWaitMs'), model.INTERACTION_WAIT_MS)
+        self.assertEqual(initializer(source, 'mMinDurationMs'), model.INTERACTION_MIN_MS)
+        self.assertEqual(initializer(source, 'mMaxDurationMs'), model.INTERACTION_MAX_MS)
+        margin = re.search(r'inputDuration = duration \+ (\d+);', source)
+        self.assertIsNotNone(margin)
+        self.assertEqual(int(margin.group(1)), model.INTERACTION_INPUT_MARGIN_MS)
+
+    def test_trace_format(self):
+        source = read_source('HintTrace.h')
+        self.assertEqual(constant(source, 'kMagic'), model.TRACE_MAGIC)
+        self.assertEqual(constant(source, 'kVersion'), model.TRACE_VERSION)
+        self.assertEqual(constant(source, 'kDisplayIdle'), model.DISPLAY_IDLE)
+        self.assertEqual(constant(source, 'kPerfLock'), model.PERF_LOCK)
+
+    def test_perf_lock_hints(self):
+        source = read_source('include/PerfLockHints.h')
+        self.assertEqual(constant(source, 'kPerfLockLevelCount'), model.PERF_LOCK_LEVEL_COUNT)
+        names = re.search(r'kPerfLockResourceNames\[[^]]*\] = \{(.*?)\};', source, re.S)
+        self.assertIsNotNone(names)
+        self.assertEqual(re.findall(r'"(\w+)"', names.group(1)), model.PERF_LOCK_RESOURCES)
+
+    def test_handled_hints(self):
+        source = read_source('Power.cpp')
+        dispatch = inspect.getsource(model.Simulation.on_hint)
+        handled = set(re.findall(r'(?:case |hint == )PowerHint_1_\d::(\w+)', source))
+        self.assertTrue(handled)
+        for name in handled:
+            self.assertEqual(model.HINT_NAMES.get(getattr(model, name, None)), name)
+            self.assertRegex(dispatch, r'\b%s\b' % name)
+
+    def test_hint_names(self):
+        source = read_source('Power.cpp')
+        with open(model.__file__) as f:
+            model_source = f.read()
+        names = re.findall(
+                r'(?:Request|Cancel|IsSuppressed|DoHint|EndHint)\((?:\*mHintManager,\s*)?"(\w+)"',
+                source)
+        self.assertTrue(names)
+        for name in set(names):
+            self.assertTrue(name in model.HINT_NAMES.values() or
+                            "'%s'" % name in model_source, name)
+
+
+if __name__ == '__main__':
+    unittest.main()
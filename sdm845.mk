@@ -277,7 +277,8 @@ PRODUCT_PACKAGES += \
 # Power
 PRODUCT_PACKAGES += \
     android.hardware.power@1.3.vendor \
-    android.hardware.power@1.3-service.nubia_sdm845-libperfmgr
+    android.hardware.power@1.3-service.nubia_sdm845-libperfmgr \
+    powerhint.bin
 
 PRODUCT_COPY_FILES += \
     $(LOCAL_PATH)/power/configs/powerhint.json:$(TARGET_COPY_OUT_VENDOR)/etc/powerhint.json